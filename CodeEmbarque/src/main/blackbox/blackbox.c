@@ -47,6 +47,7 @@
 #include "sensors/barometer.h"
 #include "sensors/gyro.h"
 #include "sensors/battery.h"
+#include "sensors/esc_sensor.h"
 
 #include "io/beeper.h"
 
@@ -224,7 +225,11 @@ static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     {"motor",      7, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_8)},
 
     /* Tricopter tail servo */
-    {"servo",      5, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(TRICOPTER)}
+    {"servo",      5, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(TRICOPTER)},
+    {"escRPM",     0, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ESC_SENSOR)},
+    {"escRPM",     1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ESC_SENSOR)},
+    {"escRPM",     2, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ESC_SENSOR)},
+    {"escRPM",     3, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ESC_SENSOR)}
 };
 
 #ifdef GPS
@@ -298,6 +303,9 @@ typedef struct blackboxMainState_s {
     int32_t sonarRaw;
 #endif
     uint16_t rssi;
+#ifdef USE_ESC_SENSOR
+    uint16_t escRPM[MAX_SUPPORTED_MOTORS];  // eRPM / 100
+#endif
 } blackboxMainState_t;
 
 typedef struct blackboxGpsState_s {
@@ -431,6 +439,13 @@ static bool testBlackboxConditionUncached(FlightLogFieldCondition condition)
         case FLIGHT_LOG_FIELD_CONDITION_RSSI:
             return rxConfig()->rssi_channel > 0 || feature(FEATURE_RSSI_ADC);
 
+        case FLIGHT_LOG_FIELD_CONDITION_ESC_SENSOR:
+#ifdef USE_ESC_SENSOR
+            return isEscSensorActive();
+#else
+            return false;
+#endif
+
         case FLIGHT_LOG_FIELD_CONDITION_NOT_LOGGING_EVERY_FRAME:
             return blackboxConfig()->rate_num < blackboxConfig()->rate_denom;
 
@@ -577,6 +592,14 @@ static void writeIntraframe(void)
         }
     }
 
+#ifdef USE_ESC_SENSOR
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ESC_SENSOR)) {
+        for (x = 0; x < MAX_SUPPORTED_MOTORS; x++) {
+            blackboxWriteUnsignedVB(blackboxCurrent->escRPM[x]);
+        }
+    }
+#endif
+
     //Rotate our history buffers:
 
     //The current state becomes the new "before" state
@@ -699,6 +722,14 @@ static void writeInterframe(void)
         }
     }
 
+#ifdef USE_ESC_SENSOR
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ESC_SENSOR)) {
+        for (x = 0; x < MAX_SUPPORTED_MOTORS; x++) {
+            blackboxWriteSignedVB((int32_t) blackboxCurrent->escRPM[x] - blackboxLast->escRPM[x]);
+        }
+    }
+#endif
+
     //Rotate our history buffers
     blackboxHistory[2] = blackboxHistory[1];
     blackboxHistory[1] = blackboxHistory[0];
@@ -984,6 +1015,14 @@ static void loadMainState(void)
     for (uint8_t i = 0; i < MAX_SUPPORTED_SERVOS; i++){
         blackboxCurrent->servo[i] = servoCmd[i];
     }
+
+#ifdef USE_ESC_SENSOR
+    if (isEscSensorActive()) {
+        for (i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+            blackboxCurrent->escRPM[i] = getEscSensorData(i)->rpm;
+        }
+    }
+#endif
 }
 
 /**
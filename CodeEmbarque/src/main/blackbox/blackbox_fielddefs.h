@@ -37,6 +37,7 @@ typedef enum FlightLogFieldCondition {
     FLIGHT_LOG_FIELD_CONDITION_AMPERAGE_ADC,
     FLIGHT_LOG_FIELD_CONDITION_SONAR,
     FLIGHT_LOG_FIELD_CONDITION_RSSI,
+    FLIGHT_LOG_FIELD_CONDITION_ESC_SENSOR,
 
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0,
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_1,
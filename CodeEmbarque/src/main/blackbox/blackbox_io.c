@@ -898,10 +898,10 @@ blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
     switch (blackboxConfig()->device) {
         case BLACKBOX_DEVICE_SERIAL:
             /*
-             * One byte of the tx buffer isn't available for user data (due to its circular list implementation),
-             * hence the -1. Note that the USB VCP implementation doesn't use a buffer and has txBufferSize set to zero.
+             * The whole tx ring is available for user data. Note that the USB VCP implementation doesn't use a
+             * buffer and has its txBuffer size set to zero.
              */
-            if (blackboxPort->txBufferSize && bytes > (int32_t) blackboxPort->txBufferSize - 1) {
+            if (blackboxPort->txBuffer.size && bytes > (int32_t) blackboxPort->txBuffer.size) {
                 return BLACKBOX_RESERVE_PERMANENT_FAILURE;
             }
 
@@ -20,6 +20,12 @@
 // only set_BASEPRI is implemented in device library. It does always create memory barrier
 // missing versions are implemented here
 
+#ifdef UNIT_TEST
+// no BASEPRI on the host, the blocks run unprotected
+static inline void __set_BASEPRI_nb(uint32_t basePri) { (void)basePri; }
+static inline void __set_BASEPRI_MAX_nb(uint32_t basePri) { (void)basePri; }
+static inline void __set_BASEPRI_MAX(uint32_t basePri) { (void)basePri; }
+#else
 // set BASEPRI and BASEPRI_MAX register, but do not create memory barrier
 __attribute__( ( always_inline ) ) static inline void __set_BASEPRI_nb(uint32_t basePri)
 {
@@ -35,6 +41,7 @@ __attribute__( ( always_inline ) ) static inline void __set_BASEPRI_MAX(uint32_t
 {
     __ASM volatile ("\tMSR basepri_max, %0\n" : : "r" (basePri) : "memory" );
 }
+#endif
 
 // cleanup BASEPRI restore function, with global memory barrier
 static inline void __basepriRestoreMem(uint8_t *val)
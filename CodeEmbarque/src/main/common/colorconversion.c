@@ -20,6 +20,19 @@
 #include "color.h"
 #include "colorconversion.h"
 
+/*
+ * hue * 256 / 60 for the position inside a 60 degree sector, replaces the division per colour channel.
+ */
+static const uint16_t hueRampLut[61] = {
+      0,   4,   9,  13,  17,  21,  26,  30,  34,  38,
+     43,  47,  51,  55,  60,  64,  68,  73,  77,  81,
+     85,  90,  94,  98, 102, 107, 111, 115, 119, 124,
+    128, 132, 137, 141, 145, 149, 154, 158, 162, 166,
+    171, 175, 179, 183, 188, 192, 196, 201, 205, 209,
+    213, 218, 222, 226, 230, 235, 239, 243, 247, 252,
+    256,
+};
+
 /*
  * Source below found here: http://www.kasperkamperman.com/blog/arduino/arduino-programming-hsb-to-rgb/
  */
@@ -45,7 +58,7 @@ rgbColor24bpp_t hsvToRgb24(const hsvColor_t* c)
         hue = hue % 60;
         if(sector % 2)             // invert direction for odd sectors
             hue = 60 - hue;
-        int itp = (((val - base) * hue) / 60) + base;
+        int itp = (((val - base) * hueRampLut[hue]) >> 8) + base;
 
         switch (sector) {
             case 0:
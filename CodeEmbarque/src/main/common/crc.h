@@ -0,0 +1,84 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Table driven CRCs and checksums of the framed protocols.
+ *
+ * The Update functions add one byte and suit receive ISRs, the others add a
+ * buffer.  All of them take the running value so frames can be processed in
+ * pieces, start from the initial value of the protocol (0 for all of those
+ * in use).
+ */
+
+extern const uint8_t crc8Table[256];
+extern const uint8_t crc8DvbS2Table[256];
+extern const uint8_t crc8MaximTable[256];
+extern const uint16_t crc16CcittTable[256];
+
+// CRC-8, poly 0x07 (KISS ESC telemetry)
+static inline uint8_t crc8Update(uint8_t crc, uint8_t data)
+{
+    return crc8Table[crc ^ data];
+}
+
+// CRC-8/DVB-S2, poly 0xD5 (CRSF)
+static inline uint8_t crc8DvbS2Update(uint8_t crc, uint8_t data)
+{
+    return crc8DvbS2Table[crc ^ data];
+}
+
+// CRC-8/MAXIM, Dallas one wire (XBUS RJ01)
+static inline uint8_t crc8MaximUpdate(uint8_t crc, uint8_t data)
+{
+    return crc8MaximTable[crc ^ data];
+}
+
+// CRC-16/CCITT, poly 0x1021 without reflection (SUMD, XBUS)
+static inline uint16_t crc16CcittUpdate(uint16_t crc, uint8_t data)
+{
+    return crc16CcittTable[(crc >> 8) ^ data] ^ (crc << 8);
+}
+
+// XOR of the bytes (MSP, LTM)
+static inline uint8_t checksumXorUpdate(uint8_t checksum, uint8_t data)
+{
+    return checksum ^ data;
+}
+
+// 8 bit Fletcher (UBX)
+typedef struct fletcher8_s {
+    uint8_t a;
+    uint8_t b;
+} fletcher8_t;
+
+static inline void fletcher8Update(fletcher8_t *checksum, uint8_t data)
+{
+    checksum->a += data;
+    checksum->b += checksum->a;
+}
+
+uint8_t crc8(uint8_t crc, const void *data, uint32_t length);
+uint8_t crc8DvbS2(uint8_t crc, const void *data, uint32_t length);
+uint8_t crc8Maxim(uint8_t crc, const void *data, uint32_t length);
+uint16_t crc16Ccitt(uint16_t crc, const void *data, uint32_t length);
+uint8_t checksumXor(uint8_t checksum, const void *data, uint32_t length);
+void fletcher8(fletcher8_t *checksum, const void *data, uint32_t length);
@@ -78,6 +78,23 @@ void BiQuadNewLpf(float filterCutFreq, biquad_t *newState, uint32_t refreshRate)
     newState->y1 = newState->y2 = 0;
 }
 
+/*
+ * Moves the center of a notch without trigonometry, the caller keeps track of cos/sin of the center.
+ * The sample history is kept so the notch can be retuned while running.
+ * One division and five multiplications, about 25 cycles on the F3 FPU.
+ */
+void BiQuadUpdateNotch(float cosOmega, float sinOmega, float invTwoQ, biquad_t *state)
+{
+    float alpha = sinOmega * invTwoQ;
+    float a0r = 1 / (1 + alpha);
+
+    state->b0 = a0r;
+    state->b1 = -2 * cosOmega * a0r;
+    state->b2 = a0r;
+    state->a1 = state->b1;
+    state->a2 = (1 - alpha) * a0r;
+}
+
 /* Computes a biquad_t filter on a sample */
 float applyBiQuadFilter(float sample, biquad_t *state)
 {
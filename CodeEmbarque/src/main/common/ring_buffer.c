@@ -0,0 +1,125 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/ring_buffer.h"
+
+void ringBufferInit(ringBuffer_t *rb, volatile uint8_t *buffer, uint32_t size)
+{
+    rb->buffer = buffer;
+    rb->size = size;
+    rb->mask = size - 1;
+    ringBufferReset(rb);
+}
+
+void ringBufferReset(ringBuffer_t *rb)
+{
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+uint32_t ringBufferWrite(ringBuffer_t *rb, const void *data, uint32_t count)
+{
+    uint32_t head = rb->head;
+    uint32_t bytesFree = ringBufferFree(rb);
+    if (count > bytesFree) {
+        count = bytesFree;
+    }
+
+    uint32_t index = head & rb->mask;
+    uint32_t firstSegment = rb->size - index;
+    if (firstSegment > count) {
+        firstSegment = count;
+    }
+
+    memcpy((uint8_t *)&rb->buffer[index], data, firstSegment);
+    memcpy((uint8_t *)&rb->buffer[0], (const uint8_t *)data + firstSegment, count - firstSegment);
+
+    ringBufferBarrier();
+    rb->head = head + count;
+    return count;
+}
+
+uint32_t ringBufferRead(ringBuffer_t *rb, void *data, uint32_t count)
+{
+    uint32_t tail = rb->tail;
+    uint32_t available = ringBufferCount(rb);
+    if (count > available) {
+        count = available;
+    }
+    ringBufferBarrier();
+
+    uint32_t index = tail & rb->mask;
+    uint32_t firstSegment = rb->size - index;
+    if (firstSegment > count) {
+        firstSegment = count;
+    }
+
+    memcpy(data, (const uint8_t *)&rb->buffer[index], firstSegment);
+    memcpy((uint8_t *)data + firstSegment, (const uint8_t *)&rb->buffer[0], count - firstSegment);
+
+    ringBufferBarrier();
+    rb->tail = tail + count;
+    return count;
+}
+
+uint32_t ringBufferReadSpan(const ringBuffer_t *rb, const volatile uint8_t **data)
+{
+    uint32_t tail = rb->tail;
+    uint32_t available = ringBufferCount(rb);
+    uint32_t index = tail & rb->mask;
+    uint32_t contiguous = rb->size - index;
+
+    ringBufferBarrier();
+    *data = &rb->buffer[index];
+    return (available < contiguous) ? available : contiguous;
+}
+
+void ringBufferConsume(ringBuffer_t *rb, uint32_t count)
+{
+    ringBufferBarrier();
+    rb->tail += count;
+}
+
+uint32_t ringBufferWriteSpan(const ringBuffer_t *rb, volatile uint8_t **data)
+{
+    uint32_t index = rb->head & rb->mask;
+    uint32_t bytesFree = ringBufferFree(rb);
+    uint32_t contiguous = rb->size - index;
+
+    *data = &rb->buffer[index];
+    return (bytesFree < contiguous) ? bytesFree : contiguous;
+}
+
+void ringBufferCommit(ringBuffer_t *rb, uint32_t count)
+{
+    ringBufferBarrier();
+    rb->head += count;
+}
+
+void ringBufferSetHeadFromDma(ringBuffer_t *rb, uint32_t dmaRemaining)
+{
+    uint32_t index = (rb->size - dmaRemaining) & rb->mask;
+    uint32_t head = rb->head;
+
+    rb->head = head + ((index - head) & rb->mask);
+    ringBufferBarrier();
+}
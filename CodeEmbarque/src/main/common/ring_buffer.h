@@ -0,0 +1,104 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Single producer, single consumer byte ring.
+ *
+ * head is only written by the producer and tail only by the consumer, both run
+ * freely and are masked on access, so the whole buffer is usable and
+ * head - tail is the number of bytes stored.  The producer and the consumer may
+ * be in different interrupt levels without locking, the barrier orders the
+ * buffer accesses against the index update (DMB also covers DMA).
+ *
+ * The size must be a power of two.
+ */
+typedef struct ringBuffer_s {
+    volatile uint8_t *buffer;
+    uint32_t size;
+    uint32_t mask;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+} ringBuffer_t;
+
+#ifdef __arm__
+#define ringBufferBarrier() __asm__ volatile ("dmb" ::: "memory")
+#else
+// host builds, the producer and the consumer are threads
+#define ringBufferBarrier() __sync_synchronize()
+#endif
+
+void ringBufferInit(ringBuffer_t *rb, volatile uint8_t *buffer, uint32_t size);
+void ringBufferReset(ringBuffer_t *rb);
+
+static inline uint32_t ringBufferCount(const ringBuffer_t *rb)
+{
+    return rb->head - rb->tail;
+}
+
+static inline uint32_t ringBufferFree(const ringBuffer_t *rb)
+{
+    return rb->size - (rb->head - rb->tail);
+}
+
+static inline bool ringBufferIsEmpty(const ringBuffer_t *rb)
+{
+    return rb->head == rb->tail;
+}
+
+// producer, caller checks ringBufferFree()
+static inline void ringBufferPush(ringBuffer_t *rb, uint8_t value)
+{
+    uint32_t head = rb->head;
+    rb->buffer[head & rb->mask] = value;
+    ringBufferBarrier();
+    rb->head = head + 1;
+}
+
+// consumer, caller checks ringBufferCount()
+static inline uint8_t ringBufferPop(ringBuffer_t *rb)
+{
+    uint32_t tail = rb->tail;
+    uint8_t value = rb->buffer[tail & rb->mask];
+    ringBufferBarrier();
+    rb->tail = tail + 1;
+    return value;
+}
+
+// copy as much as fits/is available, in at most two memcpy()
+uint32_t ringBufferWrite(ringBuffer_t *rb, const void *data, uint32_t count);
+uint32_t ringBufferRead(ringBuffer_t *rb, void *data, uint32_t count);
+
+// contiguous readable region at tail, released with ringBufferConsume()
+uint32_t ringBufferReadSpan(const ringBuffer_t *rb, const volatile uint8_t **data);
+void ringBufferConsume(ringBuffer_t *rb, uint32_t count);
+// contiguous writable region at head, published with ringBufferCommit()
+uint32_t ringBufferWriteSpan(const ringBuffer_t *rb, volatile uint8_t **data);
+void ringBufferCommit(ringBuffer_t *rb, uint32_t count);
+
+/*
+ * DMA producer: a circular DMA writing the whole buffer is the producer, the
+ * consumer brings head up to date from the remaining transfer count (CNDTR)
+ * before reading.  A DMA consumer reads a span, transfers it, then consumes
+ * it on completion, so the bytes in flight are never reported free.
+ */
+void ringBufferSetHeadFromDma(ringBuffer_t *rb, uint32_t dmaRemaining);
@@ -22,6 +22,7 @@ typedef struct gyro_s {
     sensorReadFuncPtr read;                                 // read 3 axis data function
     sensorReadFuncPtr temperature;                          // read temperature if available
     sensorIsDataReadyFuncPtr isDataReady;                   // check if sensor has new readings
+    sensorReadBatchFuncPtr readBatch;                       // read all queued 3 axis samples, if the sensor buffers them
     float scale;                                            // scalefactor
 } gyro_t;
 
@@ -24,6 +24,7 @@
 #include "build_config.h"
 #include "debug.h"
 
+#include "common/axis.h"
 #include "common/maths.h"
 
 #include "nvic.h"
@@ -52,6 +53,11 @@ static void mpu6050FindRevision(void);
 
 static volatile bool mpuDataReady;
 
+// Last accel and temperature sample captured by mpuAccGyroTempRead(), consumed by the cached readers.
+static int16_t mpuAccSample[XYZ_AXIS_COUNT];
+static int16_t mpuTempSample;
+static bool mpuAccSampleIsNew;
+
 #ifdef USE_SPI
 static bool detectSPISensorsAndUpdateDetectionResult(void);
 #endif
@@ -319,3 +325,123 @@ bool mpuIsDataReady(void)
 
     return false;
 }
+
+/*
+ * ACCEL_XOUT_H .. GYRO_ZOUT_L are contiguous on the MPU6050 so accel, temperature and gyro can be fetched
+ * in one 14 byte transaction.  The gyro sample is returned, accel and temperature are cached for
+ * mpuAccReadCached() and mpuTemperatureReadCached().
+ */
+bool mpuAccGyroTempRead(int16_t *gyroADC)
+{
+    uint8_t data[14];
+
+    bool ack = mpuConfiguration.read(MPU_RA_ACCEL_XOUT_H, 14, data);
+    if (!ack) {
+        return false;
+    }
+
+    mpuAccSample[0] = (int16_t)((data[0] << 8) | data[1]);
+    mpuAccSample[1] = (int16_t)((data[2] << 8) | data[3]);
+    mpuAccSample[2] = (int16_t)((data[4] << 8) | data[5]);
+    mpuAccSampleIsNew = true;
+
+    // Temperature in deci-degrees C, datasheet: T = raw / 340 + 36.53
+    mpuTempSample = 365 + ((int16_t)((data[6] << 8) | data[7])) / 34;
+
+    gyroADC[0] = (int16_t)((data[8] << 8) | data[9]);
+    gyroADC[1] = (int16_t)((data[10] << 8) | data[11]);
+    gyroADC[2] = (int16_t)((data[12] << 8) | data[13]);
+
+    return true;
+}
+
+static bool mpuAccTempRead(int16_t *accData)
+{
+    uint8_t data[8];
+
+    bool ack = mpuConfiguration.read(MPU_RA_ACCEL_XOUT_H, 8, data);
+    if (!ack) {
+        return false;
+    }
+
+    accData[0] = (int16_t)((data[0] << 8) | data[1]);
+    accData[1] = (int16_t)((data[2] << 8) | data[3]);
+    accData[2] = (int16_t)((data[4] << 8) | data[5]);
+
+    mpuTempSample = 365 + ((int16_t)((data[6] << 8) | data[7])) / 34;
+
+    return true;
+}
+
+// Returns false when no new sample was captured since the last call, so the caller keeps its previous reading.
+bool mpuAccReadCached(int16_t *accData)
+{
+    // When the gyro is drained from the FIFO accel and temperature can no longer piggyback on the gyro read.
+    if (gyroMPU6xxxUseFifo()) {
+        return mpuAccTempRead(accData);
+    }
+
+    if (!mpuAccSampleIsNew) {
+        return false;
+    }
+    mpuAccSampleIsNew = false;
+
+    accData[0] = mpuAccSample[0];
+    accData[1] = mpuAccSample[1];
+    accData[2] = mpuAccSample[2];
+
+    return true;
+}
+
+bool mpuTemperatureReadCached(int16_t *tempData)
+{
+    *tempData = mpuTempSample;
+    return true;
+}
+
+static void mpuGyroFifoReset(void)
+{
+    mpuConfiguration.write(MPU_RA_USER_CTRL, MPU_RF_USER_FIFO_RESET);
+    mpuConfiguration.write(MPU_RA_USER_CTRL, MPU_RF_USER_FIFO_EN);
+}
+
+void mpuGyroFifoInit(void)
+{
+    mpuConfiguration.write(MPU_RA_FIFO_EN, MPU_RF_FIFO_GYRO_EN);
+    mpuGyroFifoReset();
+}
+
+/*
+ * Drains up to maxSamples gyro samples from the FIFO, oldest first, in a single transaction.
+ * A frame the sensor is still writing is left for the next call.  On overflow the FIFO
+ * has lost frame alignment, so it is reset and -1 is returned.
+ */
+int8_t mpuGyroReadFifo(int16_t *gyroADC, uint8_t maxSamples)
+{
+    uint8_t data[MPU_FIFO_MAX_BATCH * MPU_FIFO_GYRO_FRAME_SIZE];
+
+    if (!mpuConfiguration.read(MPU_RA_FIFO_COUNTH, 2, data)) {
+        return 0;
+    }
+
+    uint16_t fifoCount = (data[0] << 8) | data[1];
+    if (fifoCount >= MPU_FIFO_SIZE) {
+        mpuGyroFifoReset();
+        return -1;
+    }
+
+    uint8_t sampleCount = MIN(fifoCount / MPU_FIFO_GYRO_FRAME_SIZE, MIN(maxSamples, MPU_FIFO_MAX_BATCH));
+    if (sampleCount == 0) {
+        return 0;
+    }
+
+    if (!mpuConfiguration.read(MPU_RA_FIFO_R_W, sampleCount * MPU_FIFO_GYRO_FRAME_SIZE, data)) {
+        return 0;
+    }
+
+    for (int i = 0; i < sampleCount * XYZ_AXIS_COUNT; i++) {
+        gyroADC[i] = (int16_t)((data[i * 2] << 8) | data[i * 2 + 1]);
+    }
+
+    return sampleCount;
+}
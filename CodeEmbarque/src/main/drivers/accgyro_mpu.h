@@ -120,6 +120,14 @@
 
 // RF = Register Flag
 #define MPU_RF_DATA_RDY_EN (1 << 0)
+#define MPU_RF_FIFO_GYRO_EN (1 << 6 | 1 << 5 | 1 << 4)     // FIFO_EN: XG, YG and ZG
+#define MPU_RF_USER_FIFO_EN (1 << 6)                        // USER_CTRL: FIFO_EN
+#define MPU_RF_USER_FIFO_RESET (1 << 2)                     // USER_CTRL: FIFO_RESET
+
+#define MPU_FIFO_SIZE           1024
+#define MPU_FIFO_GYRO_FRAME_SIZE 6
+// i2cRead() takes an 8 bit length
+#define MPU_FIFO_MAX_BATCH      (255 / MPU_FIFO_GYRO_FRAME_SIZE)
 
 typedef bool (*mpuReadRegisterFunc)(uint8_t reg, uint8_t length, uint8_t* data);
 typedef bool (*mpuWriteRegisterFunc)(uint8_t reg, uint8_t data);
@@ -188,5 +196,10 @@ void configureMPUDataReadyInterruptHandling(void);
 void mpuIntExtiInit(void);
 bool mpuAccRead(int16_t *accData);
 bool mpuGyroRead(int16_t *gyroADC);
+bool mpuAccGyroTempRead(int16_t *gyroADC);
+bool mpuAccReadCached(int16_t *accData);
+bool mpuTemperatureReadCached(int16_t *tempData);
+void mpuGyroFifoInit(void);
+int8_t mpuGyroReadFifo(int16_t *gyroADC, uint8_t maxSamples);
 mpuDetectionResult_t *detectMpu(const extiConfig_t *configToUse);
 bool mpuIsDataReady(void);
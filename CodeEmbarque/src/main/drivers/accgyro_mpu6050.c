@@ -61,7 +61,7 @@ bool mpu6050AccDetect(acc_t *acc)
     }
 
     acc->init = mpu6050AccInit;
-    acc->read = mpuAccRead;
+    acc->read = mpuAccReadCached;           // filled by the combined read done in the gyro path
     acc->revisionCode = (mpuDetectionResult.resolution == MPU_HALF_RESOLUTION ? 'o' : 'n'); // es/non-es variance between MPU6050 sensors, half of the naze boards are mpu6000ES.
 
     return true;
@@ -73,8 +73,12 @@ bool mpu6050GyroDetect(gyro_t *gyro)
         return false;
     }
     gyro->init = mpu6050GyroInit;
-    gyro->read = mpuGyroRead;
+    gyro->read = mpuAccGyroTempRead;        // single burst read of accel, temperature and gyro
+    gyro->temperature = mpuTemperatureReadCached;
     gyro->isDataReady = mpuIsDataReady;
+    if (gyroMPU6xxxUseFifo()) {
+        gyro->readBatch = mpuGyroReadFifo;
+    }
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -102,6 +106,10 @@ static void mpu6050GyroInit(uint8_t lpf)
 
     mpuIntExtiInit();
 
+    if (gyroMPU6xxxUseFifo()) {
+        lpf = INV_FILTER_256HZ_NOLPF2;  // 8kHz gyro output rate, anti-aliasing is done on the batched samples
+    }
+
     ack = mpuConfiguration.write(MPU_RA_PWR_MGMT_1, 0x80);      //PWR_MGMT_1    -- DEVICE_RESET 1
     delay(100);
     ack = mpuConfiguration.write(MPU_RA_PWR_MGMT_1, 0x03); //PWR_MGMT_1    -- SLEEP 0; CYCLE 0; TEMP_DIS 0; CLKSEL 3 (PLL with Z Gyro reference)
@@ -120,5 +128,9 @@ static void mpu6050GyroInit(uint8_t lpf)
 #ifdef USE_MPU_DATA_READY_SIGNAL
     ack = mpuConfiguration.write(MPU_RA_INT_ENABLE, MPU_RF_DATA_RDY_EN);
 #endif
+
+    if (gyroMPU6xxxUseFifo()) {
+        mpuGyroFifoInit();
+    }
     UNUSED(ack);
 }
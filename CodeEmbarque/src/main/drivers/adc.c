@@ -31,7 +31,44 @@
 
 #ifdef USE_ADC
 adc_config_t adcConfig[ADC_CHANNEL_COUNT];
-volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+volatile uint16_t adcValues[ADC_CHANNEL_COUNT];     // average of the last block, indexed by dmaIndex
+
+static volatile uint32_t adcSampleTime;
+static adcBlockCallbackPtr adcBlockCallback;
+
+/*
+ * Averages a block of complete conversion sequences, called from the DMA interrupt for each half of
+ * the circular buffer so the consumers always read a settled, oversampled value.
+ */
+void adcBlockCompleted(const volatile uint16_t *block, uint8_t channelCount, uint8_t sequenceCount)
+{
+    for (int channel = 0; channel < channelCount; channel++) {
+        uint32_t sum = 0;
+        for (int sequence = 0; sequence < sequenceCount; sequence++) {
+            sum += block[sequence * channelCount + channel];
+        }
+        adcValues[channel] = (sum + sequenceCount / 2) / sequenceCount;
+    }
+
+    uint32_t now = micros();
+    uint32_t blockInterval = adcSampleTime ? now - adcSampleTime : 0;
+    adcSampleTime = now;
+
+    if (adcBlockCallback) {
+        adcBlockCallback(blockInterval);
+    }
+}
+
+// time of the last block average, in us
+uint32_t adcGetSampleTime(void)
+{
+    return adcSampleTime;
+}
+
+void adcSetBlockCallback(adcBlockCallbackPtr callback)
+{
+    adcBlockCallback = callback;
+}
 
 
 uint16_t adcGetChannel(uint8_t channel)
@@ -59,4 +96,14 @@ uint16_t adcGetChannel(uint8_t channel)
     UNUSED(channel);
     return 0;
 }
+
+uint32_t adcGetSampleTime(void)
+{
+    return 0;
+}
+
+void adcSetBlockCallback(adcBlockCallbackPtr callback)
+{
+    UNUSED(callback);
+}
 #endif
@@ -41,5 +41,10 @@ typedef struct drv_adc_config_s {
     bool enableExternal1;
 } drv_adc_config_t;
 
+// called from the ADC DMA interrupt each time a new block of averaged samples is available
+typedef void (*adcBlockCallbackPtr)(uint32_t blockIntervalUs);
+
 void adcInit(drv_adc_config_t *init);
 uint16_t adcGetChannel(uint8_t channel);
+uint32_t adcGetSampleTime(void);
+void adcSetBlockCallback(adcBlockCallbackPtr callback);
@@ -19,3 +19,5 @@
 
 extern adc_config_t adcConfig[ADC_CHANNEL_COUNT];
 extern volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+
+void adcBlockCompleted(const volatile uint16_t *block, uint8_t channelCount, uint8_t sequenceCount);
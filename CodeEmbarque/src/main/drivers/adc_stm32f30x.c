@@ -20,9 +20,12 @@
 #include <string.h>
 
 #include <platform.h>
+#include "build_config.h"
 #include "system.h"
 
 #include "gpio.h"
+#include "nvic.h"
+#include "dma.h"
 
 #include "sensor.h"
 #include "accgyro.h"
@@ -38,6 +41,28 @@
 #define ADC_DMA_CHANNEL             DMA1_Channel1
 #endif
 
+#define ADC_OVERSAMPLE_COUNT        16      // conversion sequences averaged per half of the DMA buffer
+
+// circular buffer of complete sequences, the half that was just filled is averaged in the DMA interrupt
+static volatile uint16_t adcSampleBuffer[2 * ADC_OVERSAMPLE_COUNT * ADC_CHANNEL_COUNT];
+static uint8_t adcChannelCount;
+
+#ifdef ADC_DMA_HANDLER_IDENTIFIER
+static void adcDmaHandler(DMA_Channel_TypeDef *channel)
+{
+    UNUSED(channel);
+
+    if (DMA_GetFlagStatus(ADC_DMA_HT_FLAG)) {
+        DMA_ClearFlag(ADC_DMA_HT_FLAG);
+        adcBlockCompleted(&adcSampleBuffer[0], adcChannelCount, ADC_OVERSAMPLE_COUNT);
+    }
+    if (DMA_GetFlagStatus(ADC_DMA_TC_FLAG)) {
+        DMA_ClearFlag(ADC_DMA_TC_FLAG);
+        adcBlockCompleted(&adcSampleBuffer[ADC_OVERSAMPLE_COUNT * adcChannelCount], adcChannelCount, ADC_OVERSAMPLE_COUNT);
+    }
+}
+#endif
+
 void adcInit(drv_adc_config_t *init)
 {
     ADC_InitTypeDef ADC_InitStructure;
@@ -45,7 +70,8 @@ void adcInit(drv_adc_config_t *init)
     GPIO_InitTypeDef GPIO_InitStructure;
 
     uint8_t i;
-    uint8_t adcChannelCount = 0;
+
+    adcChannelCount = 0;
 
     memset(&adcConfig, 0, sizeof(adcConfig));
 
@@ -112,11 +138,17 @@ void adcInit(drv_adc_config_t *init)
 
     DMA_StructInit(&DMA_InitStructure);
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&ADC_INSTANCE->DR;
+#ifdef ADC_DMA_HANDLER_IDENTIFIER
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcSampleBuffer;
+    DMA_InitStructure.DMA_BufferSize = 2 * ADC_OVERSAMPLE_COUNT * adcChannelCount;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+#else
     DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcValues;
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
     DMA_InitStructure.DMA_BufferSize = adcChannelCount;
-    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
     DMA_InitStructure.DMA_MemoryInc = adcChannelCount > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+#endif
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -125,6 +157,19 @@ void adcInit(drv_adc_config_t *init)
 
     DMA_Init(ADC_DMA_CHANNEL, &DMA_InitStructure);
 
+#ifdef ADC_DMA_HANDLER_IDENTIFIER
+    dmaSetHandler(ADC_DMA_HANDLER_IDENTIFIER, adcDmaHandler);
+    DMA_ITConfig(ADC_DMA_CHANNEL, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    NVIC_InitStructure.NVIC_IRQChannel = ADC_DMA_IRQ;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_ADC_DMA);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_ADC_DMA);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+#endif
+
     DMA_Cmd(ADC_DMA_CHANNEL, ENABLE);
 
 
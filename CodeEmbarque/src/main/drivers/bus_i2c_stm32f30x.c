@@ -271,6 +271,74 @@ bool i2cWrite(uint8_t addr_, uint8_t reg, uint8_t data)
     return true;
 }
 
+bool i2cWriteBuffer(uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *data)
+{
+    addr_ <<= 1;
+
+    /* Test on BUSY Flag */
+    i2cTimeout = I2C_DEFAULT_TIMEOUT;
+    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_BUSY) != RESET) {
+        if ((i2cTimeout--) == 0) {
+            return i2cTimeoutUserCallback(I2Cx);
+        }
+    }
+
+    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
+    I2C_TransferHandling(I2Cx, addr_, 1, I2C_Reload_Mode, I2C_Generate_Start_Write);
+
+    /* Wait until TXIS flag is set */
+    i2cTimeout = I2C_DEFAULT_TIMEOUT;
+    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
+        if ((i2cTimeout--) == 0) {
+            return i2cTimeoutUserCallback(I2Cx);
+        }
+    }
+
+    /* Send Register address */
+    I2C_SendData(I2Cx, (uint8_t) reg);
+
+    /* Wait until TCR flag is set */
+    i2cTimeout = I2C_DEFAULT_TIMEOUT;
+    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TCR) == RESET)
+    {
+        if ((i2cTimeout--) == 0) {
+            return i2cTimeoutUserCallback(I2Cx);
+        }
+    }
+
+    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
+    I2C_TransferHandling(I2Cx, addr_, len, I2C_AutoEnd_Mode, I2C_No_StartStop);
+
+    /* Wait until all data are sent */
+    while (len) {
+        /* Wait until TXIS flag is set */
+        i2cTimeout = I2C_DEFAULT_TIMEOUT;
+        while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
+            if ((i2cTimeout--) == 0) {
+                return i2cTimeoutUserCallback(I2Cx);
+            }
+        }
+
+        /* Write data to TXDR */
+        I2C_SendData(I2Cx, *data);
+        data++;
+        len--;
+    }
+
+    /* Wait until STOPF flag is set */
+    i2cTimeout = I2C_DEFAULT_TIMEOUT;
+    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_STOPF) == RESET) {
+        if ((i2cTimeout--) == 0) {
+            return i2cTimeoutUserCallback(I2Cx);
+        }
+    }
+
+    /* Clear STOPF flag */
+    I2C_ClearFlag(I2Cx, I2C_ICR_STOPCF);
+
+    return true;
+}
+
 bool i2cRead(uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf)
 {
     addr_ <<= 1;
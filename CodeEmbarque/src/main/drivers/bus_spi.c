@@ -17,15 +17,34 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 #include <platform.h>
 
 #include "build_config.h"
 
 #include "gpio.h"
+#include "nvic.h"
+#include "dma.h"
 
 #include "bus_spi.h"
 
+typedef struct spiDmaState_s {
+    SPI_TypeDef *instance;
+    DMA_Channel_TypeDef *txChannel;
+    uint32_t txCompleteFlag;
+    GPIO_TypeDef *csGpio;
+    uint16_t csPin;
+    spiDmaCallbackFuncPtr callback;
+    volatile bool busy;
+} spiDmaState_t;
+
+#ifdef SPI2_TX_DMA_CHANNEL
+static spiDmaState_t spi2DmaState;
+static void spi2DmaTxHandler(DMA_Channel_TypeDef *channel);
+static void spiDmaTxInit(spiDmaState_t *state, SPI_TypeDef *instance, DMA_Channel_TypeDef *txChannel, uint32_t txCompleteFlag, uint8_t irq, dmaHandlerIdentifier_e handlerIdentifier, dmaCallbackHandlerFuncPtr handler);
+#endif
+
 #ifdef USE_SPI_DEVICE_1
 
 #ifndef SPI1_GPIO
@@ -249,6 +268,10 @@ void initSpi2(void)
     // Drive NSS high to disable connected SPI device.
     GPIO_SetBits(SPI2_GPIO, SPI2_NSS_PIN);
 #endif
+
+#ifdef SPI2_TX_DMA_CHANNEL
+    spiDmaTxInit(&spi2DmaState, SPI2, SPI2_TX_DMA_CHANNEL, SPI2_TX_DMA_TC_FLAG, SPI2_TX_DMA_IRQ, SPI2_TX_DMA_HANDLER_IDENTIFER, spi2DmaTxHandler);
+#endif
 }
 #endif
 
@@ -504,3 +527,137 @@ void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
 
     SPI_Cmd(instance, ENABLE);
 }
+
+static spiDmaState_t *spiDmaStateForInstance(SPI_TypeDef *instance)
+{
+#ifdef SPI2_TX_DMA_CHANNEL
+    if (instance == SPI2) {
+        return &spi2DmaState;
+    }
+#else
+    UNUSED(instance);
+#endif
+    return NULL;
+}
+
+#ifdef SPI2_TX_DMA_CHANNEL
+static void spiDmaTxComplete(spiDmaState_t *state, DMA_Channel_TypeDef *channel)
+{
+    if (!DMA_GetFlagStatus(state->txCompleteFlag)) {
+        return;
+    }
+
+    DMA_ClearFlag(state->txCompleteFlag);
+    DMA_Cmd(channel, DISABLE);
+    SPI_I2S_DMACmd(state->instance, SPI_I2S_DMAReq_Tx, DISABLE);
+
+    // Transfer complete fires once the last byte is queued in the TX FIFO, let it leave the wire before releasing CS.
+    while (spiIsBusBusy(state->instance));
+
+    // Nothing read the bytes clocked in during the transmit, drop them and clear the resulting overrun.
+    while (SPI_GetReceptionFIFOStatus(state->instance) != SPI_ReceptionFIFOStatus_Empty) {
+        SPI_ReceiveData8(state->instance);
+    }
+    (void)state->instance->SR;
+
+    if (state->csGpio) {
+        GPIO_SetBits(state->csGpio, state->csPin);
+    }
+
+    state->busy = false;
+
+    if (state->callback) {
+        state->callback(state->instance);
+    }
+}
+
+static void spi2DmaTxHandler(DMA_Channel_TypeDef *channel)
+{
+    spiDmaTxComplete(&spi2DmaState, channel);
+}
+
+static void spiDmaTxInit(spiDmaState_t *state, SPI_TypeDef *instance, DMA_Channel_TypeDef *txChannel, uint32_t txCompleteFlag, uint8_t irq, dmaHandlerIdentifier_e handlerIdentifier, dmaCallbackHandlerFuncPtr handler)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    state->instance = instance;
+    state->txChannel = txChannel;
+    state->txCompleteFlag = txCompleteFlag;
+    state->busy = false;
+
+    dmaSetHandler(handlerIdentifier, handler);
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    DMA_DeInit(txChannel);
+
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&instance->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = 0;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+
+    DMA_Init(txChannel, &DMA_InitStructure);
+
+    DMA_ITConfig(txChannel, DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = irq;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SPI_DMA);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SPI_DMA);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+#endif
+
+/**
+ * Return true if an asynchronous transmit started by spiDmaTransmit() has not completed yet.
+ */
+bool spiDmaIsBusy(SPI_TypeDef *instance)
+{
+    spiDmaState_t *state = spiDmaStateForInstance(instance);
+
+    return state && state->busy;
+}
+
+/**
+ * Start transmitting `length` bytes from `data` using DMA and return immediately, received bytes are discarded.
+ *
+ * If csGpio is not NULL the chip select pin is driven low now and released once the last byte has been clocked
+ * out, after which the optional callback is called from interrupt context. `data` must stay valid until then.
+ *
+ * Returns false if the instance has no DMA channel or a transfer is already in progress, nothing is sent.
+ */
+bool spiDmaTransmit(SPI_TypeDef *instance, const uint8_t *data, uint16_t length, GPIO_TypeDef *csGpio, uint16_t csPin, spiDmaCallbackFuncPtr callback)
+{
+    spiDmaState_t *state = spiDmaStateForInstance(instance);
+
+    if (!state || state->busy || length == 0) {
+        return false;
+    }
+
+    state->busy = true;
+    state->csGpio = csGpio;
+    state->csPin = csPin;
+    state->callback = callback;
+
+    if (csGpio) {
+        GPIO_ResetBits(csGpio, csPin);
+    }
+
+    DMA_Cmd(state->txChannel, DISABLE);
+    state->txChannel->CMAR = (uint32_t)data;
+    DMA_SetCurrDataCounter(state->txChannel, length);
+    DMA_Cmd(state->txChannel, ENABLE);
+
+    SPI_I2S_DMACmd(instance, SPI_I2S_DMAReq_Tx, ENABLE);
+
+    return true;
+}
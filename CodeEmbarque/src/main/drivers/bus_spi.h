@@ -28,3 +28,8 @@ uint8_t spiTransferByte(SPI_TypeDef *instance, uint8_t in);
 bool spiIsBusBusy(SPI_TypeDef *instance);
 
 void spiTransfer(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len);
+
+typedef void (*spiDmaCallbackFuncPtr)(SPI_TypeDef *instance);
+
+bool spiDmaTransmit(SPI_TypeDef *instance, const uint8_t *data, uint16_t length, GPIO_TypeDef *csGpio, uint16_t csPin, spiDmaCallbackFuncPtr callback);
+bool spiDmaIsBusy(SPI_TypeDef *instance);
@@ -18,9 +18,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <platform.h>
 
+#include "common/maths.h"
+
 #include "bus_i2c.h"
 #include "system.h"
 
@@ -170,14 +173,95 @@ static const uint8_t multiWiiFont[][5] = { // Refer to "Times New Roman" Font Da
 
 #define OLED_address   0x3C     // OLED at address 0x3C in 7bit
 
+#define OLED_CONTROL_COMMAND_STREAM 0x00
+#define OLED_CONTROL_DATA_STREAM    0x40
+
+#define OLED_PAGE_COUNT (SCREEN_HEIGHT / 8)
+
+/*
+ * Everything is drawn into this copy of the display RAM, one byte is a column of 8 pixels in a page.
+ * Each page keeps the range of columns [dirtyStart, dirtyEnd) that differs from what the display shows,
+ * i2c_OLED_flush() sends those ranges as bulk transfers.
+ */
+static uint8_t frameBuffer[OLED_PAGE_COUNT][SCREEN_WIDTH];
+static uint8_t dirtyStart[OLED_PAGE_COUNT];
+static uint8_t dirtyEnd[OLED_PAGE_COUNT];
+
+static uint8_t cursorPage;
+static uint8_t cursorColumn;
+
 static bool i2c_OLED_send_cmd(uint8_t command)
 {
     return i2cWrite(OLED_address, 0x80, command);
 }
 
-static bool i2c_OLED_send_byte(uint8_t val)
+static void i2c_OLED_mark_dirty(uint8_t page, uint8_t column)
+{
+    if (dirtyStart[page] >= dirtyEnd[page]) {
+        dirtyStart[page] = column;
+        dirtyEnd[page] = column + 1;
+    } else if (column < dirtyStart[page]) {
+        dirtyStart[page] = column;
+    } else if (column >= dirtyEnd[page]) {
+        dirtyEnd[page] = column + 1;
+    }
+}
+
+static void i2c_OLED_mark_all_dirty(void)
+{
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT; page++) {
+        dirtyStart[page] = 0;
+        dirtyEnd[page] = SCREEN_WIDTH;
+    }
+}
+
+static void i2c_OLED_send_byte(uint8_t val)
+{
+    if (frameBuffer[cursorPage][cursorColumn] != val) {
+        frameBuffer[cursorPage][cursorColumn] = val;
+        i2c_OLED_mark_dirty(cursorPage, cursorColumn);
+    }
+
+    // Same wrapping as the display's horizontal addressing mode
+    if (++cursorColumn >= SCREEN_WIDTH) {
+        cursorColumn = 0;
+        cursorPage = (cursorPage + 1) % OLED_PAGE_COUNT;
+    }
+}
+
+/**
+ * Send up to maxBytes of changed frame buffer content to the display, a page segment per transfer.
+ *
+ * Returns true once the display matches the frame buffer, false if there is more to send on a later call.
+ */
+bool i2c_OLED_flush(uint16_t maxBytes)
 {
-    return i2cWrite(OLED_address, 0x40, val);
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT; page++) {
+        if (dirtyStart[page] >= dirtyEnd[page]) {
+            continue;
+        }
+        if (maxBytes == 0) {
+            return false;
+        }
+
+        uint8_t start = dirtyStart[page];
+        uint8_t length = MIN(dirtyEnd[page] - start, maxBytes);
+
+        uint8_t addressing[] = {
+            0x21, start, start + length - 1,    // Set Column Address range
+            0x22, page, page                    // Set Page Address range
+        };
+
+        if (!i2cWriteBuffer(OLED_address, OLED_CONTROL_COMMAND_STREAM, sizeof(addressing), addressing) ||
+            !i2cWriteBuffer(OLED_address, OLED_CONTROL_DATA_STREAM, length, &frameBuffer[page][start])) {
+            return false;
+        }
+
+        dirtyStart[page] += length;
+        maxBytes -= length;
+    }
+
+    return true;
 }
 
 void i2c_OLED_clear_display(void)
@@ -190,9 +274,13 @@ void i2c_OLED_clear_display(void)
     i2c_OLED_send_cmd(0x40);              // Display start line register to 0
     i2c_OLED_send_cmd(0);                 // Set low col address to 0
     i2c_OLED_send_cmd(0x10);              // Set high col address to 0
-    for(uint16_t i = 0; i < 1024; i++) {  // fill the display's RAM with graphic... 128*64 pixel picture
-        i2c_OLED_send_byte(0x00);  // clear
-    }
+
+    // The display RAM content is unknown, clear the frame buffer and resend all of it on the next flushes
+    memset(frameBuffer, 0, sizeof(frameBuffer));
+    i2c_OLED_mark_all_dirty();
+    cursorPage = 0;
+    cursorColumn = 0;
+
     i2c_OLED_send_cmd(0x81);              // Setup CONTRAST CONTROL, following byte is the contrast Value... always a 2 byte instruction
     i2c_OLED_send_cmd(200);               // Here you can set the brightness 1 = dull, 255 is very bright
     i2c_OLED_send_cmd(0xaf);              // display on
@@ -200,27 +288,24 @@ void i2c_OLED_clear_display(void)
 
 void i2c_OLED_clear_display_quick(void)
 {
-    i2c_OLED_send_cmd(0xb0);              // set page address to 0
-    i2c_OLED_send_cmd(0x40);              // Display start line register to 0
-    i2c_OLED_send_cmd(0);                 // Set low col address to 0
-    i2c_OLED_send_cmd(0x10);              // Set high col address to 0
-    for(uint16_t i = 0; i < 1024; i++) {      // fill the display's RAM with graphic... 128*64 pixel picture
+    // Only what was drawn needs clearing on the display
+    cursorPage = 0;
+    cursorColumn = 0;
+    for(uint16_t i = 0; i < sizeof(frameBuffer); i++) {
         i2c_OLED_send_byte(0x00);  // clear
     }
 }
 
 void i2c_OLED_set_xy(uint8_t col, uint8_t row)
 {
-    i2c_OLED_send_cmd(0xb0 + row);                      //set page address
-    i2c_OLED_send_cmd(0x00 + ((CHARACTER_WIDTH_TOTAL * col) & 0x0f));         //set low col address
-    i2c_OLED_send_cmd(0x10 + (((CHARACTER_WIDTH_TOTAL * col) >> 4) & 0x0f));  //set high col address
+    cursorPage = row % OLED_PAGE_COUNT;
+    cursorColumn = (CHARACTER_WIDTH_TOTAL * col) % SCREEN_WIDTH;
 }
 
 void i2c_OLED_set_line(uint8_t row)
 {
-    i2c_OLED_send_cmd(0xb0 + row); //set page address
-    i2c_OLED_send_cmd(0);          //set low col address
-    i2c_OLED_send_cmd(0x10);       //set high col address
+    cursorPage = row % OLED_PAGE_COUNT;
+    cursorColumn = 0;
 }
 
 void i2c_OLED_send_char(unsigned char ascii)
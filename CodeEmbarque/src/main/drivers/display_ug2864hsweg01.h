@@ -42,4 +42,5 @@ void i2c_OLED_send_char(unsigned char ascii);
 void i2c_OLED_send_string(const char *string);
 void i2c_OLED_clear_display(void);
 void i2c_OLED_clear_display_quick(void);
+bool i2c_OLED_flush(uint16_t maxBytes);
 
@@ -45,6 +45,11 @@ void DMA1_Channel3_IRQHandler(void)
     dmaHandlers.dma1Channel3IRQHandler(DMA1_Channel3);
 }
 
+void DMA1_Channel5_IRQHandler(void)
+{
+    dmaHandlers.dma1Channel5IRQHandler(DMA1_Channel5);
+}
+
 void DMA1_Channel6_IRQHandler(void)
 {
     dmaHandlers.dma1Channel6IRQHandler(DMA1_Channel6);
@@ -55,13 +60,20 @@ void DMA1_Channel7_IRQHandler(void)
     dmaHandlers.dma1Channel7IRQHandler(DMA1_Channel7);
 }
 
+void DMA2_Channel1_IRQHandler(void)
+{
+    dmaHandlers.dma2Channel1IRQHandler(DMA2_Channel1);
+}
+
 void dmaInit(void)
 {
     memset(&dmaHandlers, 0, sizeof(dmaHandlers));
     dmaHandlers.dma1Channel2IRQHandler = dmaNoOpHandler;
     dmaHandlers.dma1Channel3IRQHandler = dmaNoOpHandler;
+    dmaHandlers.dma1Channel5IRQHandler = dmaNoOpHandler;
     dmaHandlers.dma1Channel6IRQHandler = dmaNoOpHandler;
     dmaHandlers.dma1Channel7IRQHandler = dmaNoOpHandler;
+    dmaHandlers.dma2Channel1IRQHandler = dmaNoOpHandler;
 }
 
 void dmaSetHandler(dmaHandlerIdentifier_e identifier, dmaCallbackHandlerFuncPtr callback)
@@ -73,11 +85,17 @@ void dmaSetHandler(dmaHandlerIdentifier_e identifier, dmaCallbackHandlerFuncPtr
         case DMA1_CH3_HANDLER:
             dmaHandlers.dma1Channel3IRQHandler = callback;
             break;
+        case DMA1_CH5_HANDLER:
+            dmaHandlers.dma1Channel5IRQHandler = callback;
+            break;
         case DMA1_CH6_HANDLER:
             dmaHandlers.dma1Channel6IRQHandler = callback;
             break;
         case DMA1_CH7_HANDLER:
             dmaHandlers.dma1Channel7IRQHandler = callback;
             break;
+        case DMA2_CH1_HANDLER:
+            dmaHandlers.dma2Channel1IRQHandler = callback;
+            break;
     }
 }
@@ -0,0 +1,39 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dshot.h"
+
+uint16_t dshotEncodeFrame(uint16_t value, bool requestTelemetry)
+{
+    uint16_t packet = ((value & 0x07FF) << 1) | (requestTelemetry ? 1 : 0);
+
+    // xor of the three nibbles of the 12 bit packet
+    uint16_t checksum = (packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0F;
+
+    return (packet << 4) | checksum;
+}
+
+void dshotFrameToPulses(uint16_t frame, uint16_t *buffer, uint8_t stride, uint16_t bit0Pulse, uint16_t bit1Pulse)
+{
+    for (int bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+        buffer[bit * stride] = (frame & 0x8000) ? bit1Pulse : bit0Pulse;
+        frame <<= 1;
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define DSHOT_FRAME_BITS        16
+
+#define DSHOT_DISARM_VALUE      0
+#define DSHOT_MIN_THROTTLE      48      // 1-47 are ESC commands
+#define DSHOT_MAX_THROTTLE      2047
+
+/*
+ * A DShot frame is the 11 bit value, the telemetry request bit and a 4 bit checksum, sent MSB first.
+ *
+ * Reference frames:
+ *   value    0, telemetry 0 -> 0x0000
+ *   value   48, telemetry 0 -> 0x0606
+ *   value 1046, telemetry 0 -> 0x82C6
+ *   value 1046, telemetry 1 -> 0x82D7
+ *   value 2047, telemetry 0 -> 0xFFEE
+ */
+uint16_t dshotEncodeFrame(uint16_t value, bool requestTelemetry);
+
+// Write one pulse width per frame bit, MSB first, every `stride` entries of `buffer`
+void dshotFrameToPulses(uint16_t frame, uint16_t *buffer, uint8_t stride, uint16_t bit0Pulse, uint16_t bit1Pulse);
@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <platform.h>
 
@@ -27,6 +28,8 @@
 #include "drivers/bus_spi.h"
 #include "drivers/system.h"
 
+#include "common/maths.h"
+
 #define M25P16_INSTRUCTION_RDID             0x9F
 #define M25P16_INSTRUCTION_READ_BYTES       0x03
 #define M25P16_INSTRUCTION_READ_STATUS_REG  0x05
@@ -66,6 +69,15 @@ static flashGeometry_t geometry = {.pageSize = M25P16_PAGESIZE};
  */
 static bool couldBeBusy = false;
 
+#define M25P16_PAGE_PROGRAM_HEADER_SIZE 4
+
+/*
+ * Page program instruction, address and data are staged here and sent with a single DMA transmit, so the caller's
+ * buffers are free again as soon as m25p16_pageProgramContinue() returns.
+ */
+static uint8_t pageProgramBuffer[M25P16_PAGE_PROGRAM_HEADER_SIZE + M25P16_PAGESIZE];
+static uint16_t pageProgramLength;
+
 /**
  * Send the given command byte to the device.
  */
@@ -106,6 +118,11 @@ static uint8_t m25p16_readStatus()
 
 bool m25p16_isReady()
 {
+    // A page program still being clocked out holds the chip select
+    if (spiDmaIsBusy(M25P16_SPI_INSTANCE)) {
+        return false;
+    }
+
     // If couldBeBusy is false, don't bother to poll the flash chip for its status
     couldBeBusy = couldBeBusy && ((m25p16_readStatus() & M25P16_STATUS_FLAG_WRITE_IN_PROGRESS) != 0);
 
@@ -230,25 +247,39 @@ void m25p16_eraseCompletely()
 
 void m25p16_pageProgramBegin(uint32_t address)
 {
-    uint8_t command[] = { M25P16_INSTRUCTION_PAGE_PROGRAM, (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF};
-
     m25p16_waitForReady(DEFAULT_TIMEOUT_MILLIS);
 
     m25p16_writeEnable();
 
-    ENABLE_M25P16;
-
-    spiTransfer(M25P16_SPI_INSTANCE, NULL, command, sizeof(command));
+    pageProgramBuffer[0] = M25P16_INSTRUCTION_PAGE_PROGRAM;
+    pageProgramBuffer[1] = (address >> 16) & 0xFF;
+    pageProgramBuffer[2] = (address >> 8) & 0xFF;
+    pageProgramBuffer[3] = address & 0xFF;
+    pageProgramLength = M25P16_PAGE_PROGRAM_HEADER_SIZE;
 }
 
 void m25p16_pageProgramContinue(const uint8_t *data, int length)
 {
-    spiTransfer(M25P16_SPI_INSTANCE, NULL, data, length);
+    length = MIN(length, (int)sizeof(pageProgramBuffer) - pageProgramLength);
+
+    memcpy(pageProgramBuffer + pageProgramLength, data, length);
+    pageProgramLength += length;
 }
 
+/**
+ * Start sending the staged page program. The transfer runs in the background and the chip select is released once
+ * it completes, m25p16_isReady() returns false until then.
+ */
 void m25p16_pageProgramFinish()
 {
-    DISABLE_M25P16;
+    if (!spiDmaTransmit(M25P16_SPI_INSTANCE, pageProgramBuffer, pageProgramLength, M25P16_CS_GPIO, M25P16_CS_PIN, NULL)) {
+        // No DMA for this bus, fall back to a blocking transfer
+        ENABLE_M25P16;
+
+        spiTransfer(M25P16_SPI_INSTANCE, NULL, pageProgramBuffer, pageProgramLength);
+
+        DISABLE_M25P16;
+    }
 }
 
 /**
@@ -265,6 +296,9 @@ void m25p16_pageProgramFinish()
  *
  * If you want to write multiple buffers (whose sum of sizes is still not more than the page size) then you can
  * break this operation up into one beginProgram call, one or more continueProgram calls, and one finishProgram call.
+ *
+ * The data is copied, so the buffer can be reused as soon as this returns even though the transfer may still be
+ * in progress.
  */
 void m25p16_pageProgram(uint32_t address, const uint8_t *data, int length)
 {
@@ -34,28 +34,49 @@
 extern gyro_t gyro;
 
 uint32_t targetLooptime;
+uint32_t gyroSamplePeriod;          // time between two gyro samples seen by the filters, in us
 static uint8_t mpuDividerDrops;
+static bool mpuFifoEnabled;
 
 bool gyroSyncCheckUpdate(void)
 {
     return gyro.isDataReady && gyro.isDataReady();
 }
 
-void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator)
+void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator, uint8_t gyroFifo)
 {
+    mpuFifoEnabled = gyroFifo;
+    if (mpuFifoEnabled) {
+        // The sensor samples at 8kHz into its FIFO, the loop drains gyroSyncDenominator samples per cycle
+        lpf = 0;
+    }
+
     if (gyroSync) {
-        int gyroSamplePeriod;
+        // the sensor output rate, 8kHz without its DLPF and 1kHz with it
+        uint32_t sensorSamplePeriod;
         if (lpf == 0) {
-            gyroSamplePeriod = 125;
+            sensorSamplePeriod = 125;
         } else {
-            gyroSamplePeriod = 1000;
+            sensorSamplePeriod = 1000;
         }
         mpuDividerDrops = gyroSyncDenominator - 1;
-        targetLooptime = gyroSyncDenominator * gyroSamplePeriod;
+        targetLooptime = gyroSyncDenominator * sensorSamplePeriod;
     } else {
         mpuDividerDrops = 0;
         targetLooptime = looptime;
     }
+
+    if (mpuFifoEnabled) {
+        mpuDividerDrops = 0;
+        gyroSamplePeriod = 125;
+    } else {
+        gyroSamplePeriod = targetLooptime;
+    }
+}
+
+bool gyroMPU6xxxUseFifo(void)
+{
+    return mpuFifoEnabled;
 }
 
 uint8_t gyroMPU6xxxCalculateDivider(void)
@@ -18,7 +18,9 @@
 #define INTERRUPT_WAIT_TIME 10
 
 extern uint32_t targetLooptime;
+extern uint32_t gyroSamplePeriod;
 
 bool gyroSyncCheckUpdate(void);
 uint8_t gyroMPU6xxxCalculateDivider(void);
-void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator);
+bool gyroMPU6xxxUseFifo(void);
+void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator, uint8_t gyroFifo);
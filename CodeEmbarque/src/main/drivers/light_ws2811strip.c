@@ -33,17 +33,32 @@
 
 #include "common/color.h"
 #include "common/colorconversion.h"
+#include "common/atomic.h"
+#include "drivers/nvic.h"
 #include "drivers/dma.h"
 #include "drivers/light_ws2811strip.h"
 
-uint8_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
+#define WS2811_NO_BUFFER    0xFF
+
+uint8_t ledStripDMABuffer[WS2811_DMA_BUFFER_COUNT][WS2811_DMA_BUFFER_SIZE];
 volatile uint8_t ws2811LedDataTransferInProgress = 0;
 
+static volatile uint8_t queuedBuffer = WS2811_NO_BUFFER;   // encoded buffer waiting for the current transfer to end
+static uint8_t sentBuffer = 0;                              // buffer being sent or sent last, the other one is encoded
+
 static hsvColor_t ledColorBuffer[WS2811_LED_STRIP_LENGTH];
+static rgbColor24bpp_t ledRgbBuffer[WS2811_LED_STRIP_LENGTH];
+
+// one bit per LED, WS2811_LED_STRIP_LENGTH is at most 32
+static uint32_t ledHsvChanged;                              // HSV set since the last RGB conversion
+static uint32_t ledEncodePending[WS2811_DMA_BUFFER_COUNT];  // RGB changed since this buffer was encoded
 
 void setLedHsv(int index, const hsvColor_t *color)
 {
-    ledColorBuffer[index] = *color;
+    if (ledColorBuffer[index].h != color->h || ledColorBuffer[index].s != color->s || ledColorBuffer[index].v != color->v) {
+        ledColorBuffer[index] = *color;
+        ledHsvChanged |= (1u << index);
+    }
 }
 
 void getLedHsv(int index, hsvColor_t *color)
@@ -53,12 +68,15 @@ void getLedHsv(int index, hsvColor_t *color)
 
 void setLedValue(int index, const uint8_t value)
 {
-    ledColorBuffer[index].v = value;
+    if (ledColorBuffer[index].v != value) {
+        ledColorBuffer[index].v = value;
+        ledHsvChanged |= (1u << index);
+    }
 }
 
 void scaleLedValue(int index, const uint8_t scalePercent)
 {
-    ledColorBuffer[index].v = (ledColorBuffer[index].v * scalePercent / 100);
+    setLedValue(index, ledColorBuffer[index].v * scalePercent / 100);
 }
 
 void setStripColor(const hsvColor_t *color)
@@ -78,23 +96,37 @@ void setStripColors(const hsvColor_t *colors)
 void ws2811DMAHandler(DMA_Channel_TypeDef *channel)
 {
     if (DMA_GetFlagStatus(WS2811_DMA_TC_FLAG)) {
-        ws2811LedDataTransferInProgress = 0;
         DMA_Cmd(channel, DISABLE);
         DMA_ClearFlag(WS2811_DMA_TC_FLAG);
+
+        // chain the next frame straight away, the trailing zeroes of the last one are the reset gap
+        if (queuedBuffer != WS2811_NO_BUFFER) {
+            sentBuffer = queuedBuffer;
+            queuedBuffer = WS2811_NO_BUFFER;
+            ws2811LedStripDMAEnable(ledStripDMABuffer[sentBuffer]);
+        } else {
+            ws2811LedDataTransferInProgress = 0;
+        }
     }
 }
 
 void ws2811LedStripInit(void)
 {
-    memset(&ledStripDMABuffer, 0, WS2811_DMA_BUFFER_SIZE);
+    memset(&ledStripDMABuffer, 0, sizeof(ledStripDMABuffer));
+    memset(&ledColorBuffer, 0, sizeof(ledColorBuffer));
+    memset(&ledRgbBuffer, 0, sizeof(ledRgbBuffer));
+    ledEncodePending[0] = ledEncodePending[1] = 0xFFFFFFFF >> (32 - WS2811_LED_STRIP_LENGTH);
+    ledHsvChanged = 0;
+    queuedBuffer = WS2811_NO_BUFFER;
     dmaSetHandler(WS2811_DMA_HANDLER_IDENTIFER, ws2811DMAHandler);
     ws2811LedStripHardwareInit();
     ws2811UpdateStrip();
 }
 
+// a new frame can be encoded as long as none is already waiting to be sent
 bool isWS2811LedStripReady(void)
 {
-    return !ws2811LedDataTransferInProgress;
+    return queuedBuffer == WS2811_NO_BUFFER;
 }
 
 STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(uint8_t **buffer, rgbColor24bpp_t color)
@@ -108,25 +140,57 @@ STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(uint8_t **buffer, rgbColor24bpp_t
 }
 
 /*
- * This method is non-blocking unless an existing LED update is in progress.
- * it does not wait until all the LEDs have been updated, that happens in the background.
+ * This method never blocks. Only LEDs whose colour changed are converted and re-encoded, into the
+ * buffer that is not being sent. If a transfer is running the frame is queued and the DMA handler
+ * starts it, if a frame is already queued the changes are kept for the next call.
  */
 void ws2811UpdateStrip(void)
 {
-    // wait until previous transfer completes
-    while(ws2811LedDataTransferInProgress);
+    if (queuedBuffer != WS2811_NO_BUFFER) {
+        return;
+    }
 
-    uint8_t *dst = ledStripDMABuffer;               // reset buffer memory index
+    // convert the LEDs that were set, only an actual RGB change needs encoding
+    for (int ledIndex = 0; ledHsvChanged; ledIndex++) {
+        uint32_t ledBit = 1u << ledIndex;
+        if (!(ledHsvChanged & ledBit)) {
+            continue;
+        }
+        ledHsvChanged &= ~ledBit;
 
-    // fill transmit buffer with correct compare values to achieve
-    // correct pulse widths according to color values
-    for (int ledIndex = 0; ledIndex < WS2811_LED_STRIP_LENGTH; ledIndex++) {
         rgbColor24bpp_t rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
+        if (memcmp(&rgb24, &ledRgbBuffer[ledIndex], sizeof(rgb24)) != 0) {
+            ledRgbBuffer[ledIndex] = rgb24;
+            ledEncodePending[0] |= ledBit;
+            ledEncodePending[1] |= ledBit;
+        }
+    }
 
-        fastUpdateLEDDMABuffer(&dst, rgb24);
+    uint8_t encodeBuffer = sentBuffer ^ 1;
+    if (!ledEncodePending[encodeBuffer]) {
+        return;     // what is on the strip is still current
     }
 
-    ws2811LedDataTransferInProgress = 1;
-    ws2811LedStripDMAEnable();
-}
+    // fill transmit buffer with correct compare values to achieve
+    // correct pulse widths according to color values
+    for (int ledIndex = 0; ledEncodePending[encodeBuffer]; ledIndex++) {
+        uint32_t ledBit = 1u << ledIndex;
+        if (!(ledEncodePending[encodeBuffer] & ledBit)) {
+            continue;
+        }
+        ledEncodePending[encodeBuffer] &= ~ledBit;
+
+        uint8_t *dst = &ledStripDMABuffer[encodeBuffer][ledIndex * WS2811_BITS_PER_LED];
+        fastUpdateLEDDMABuffer(&dst, ledRgbBuffer[ledIndex]);
+    }
 
+    ATOMIC_BLOCK(NVIC_PRIO_WS2811_DMA) {
+        if (ws2811LedDataTransferInProgress) {
+            queuedBuffer = encodeBuffer;
+        } else {
+            sentBuffer = encodeBuffer;
+            ws2811LedDataTransferInProgress = 1;
+            ws2811LedStripDMAEnable(ledStripDMABuffer[sentBuffer]);
+        }
+    }
+}
@@ -24,6 +24,7 @@
 #define WS2811_DATA_BUFFER_SIZE (WS2811_BITS_PER_LED * WS2811_LED_STRIP_LENGTH)
 
 #define WS2811_DMA_BUFFER_SIZE (WS2811_DATA_BUFFER_SIZE + WS2811_DELAY_BUFFER_LENGTH)   // number of bytes needed is #LEDs * 24 bytes + 42 trailing bytes)
+#define WS2811_DMA_BUFFER_COUNT 2   // one is sent while the other one is encoded
 
 #define BIT_COMPARE_1 17 // timer compare value for logical 1
 #define BIT_COMPARE_0 9  // timer compare value for logical 0
@@ -31,7 +32,7 @@
 void ws2811LedStripInit(void);
 
 void ws2811LedStripHardwareInit(void);
-void ws2811LedStripDMAEnable(void);
+void ws2811LedStripDMAEnable(uint8_t *buffer);
 
 void ws2811UpdateStrip(void);
 
@@ -46,5 +47,5 @@ void setStripColors(const hsvColor_t *colors);
 
 bool isWS2811LedStripReady(void);
 
-extern uint8_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
+extern uint8_t ledStripDMABuffer[WS2811_DMA_BUFFER_COUNT][WS2811_DMA_BUFFER_SIZE];
 extern volatile uint8_t ws2811LedDataTransferInProgress;
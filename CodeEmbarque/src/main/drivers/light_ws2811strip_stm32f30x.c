@@ -97,7 +97,7 @@ void ws2811LedStripHardwareInit(void)
 
     DMA_StructInit(&DMA_InitStructure);
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&WS2811_TIMER->CCR1;
-    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ledStripDMABuffer;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ledStripDMABuffer[0];
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
     DMA_InitStructure.DMA_BufferSize = WS2811_DMA_BUFFER_SIZE;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
@@ -127,8 +127,9 @@ void ws2811LedStripHardwareInit(void)
     ws2811UpdateStrip();
 }
 
-void ws2811LedStripDMAEnable(void)
+void ws2811LedStripDMAEnable(uint8_t *buffer)
 {
+    WS2811_DMA_CHANNEL->CMAR = (uint32_t)buffer;
     DMA_SetCurrDataCounter(WS2811_DMA_CHANNEL, WS2811_DMA_BUFFER_SIZE);  // load number of bytes to be transferred
     TIM_SetCounter(WS2811_TIMER, 0);
     TIM_Cmd(WS2811_TIMER, ENABLE);
@@ -24,6 +24,8 @@
 #define NVIC_PRIO_SERIALUART5_TXDMA       NVIC_BUILD_PRIORITY(1, 0)
 #define NVIC_PRIO_SERIALUART5_RXDMA       NVIC_BUILD_PRIORITY(1, 1)
 #define NVIC_PRIO_SERIALUART5             NVIC_BUILD_PRIORITY(1, 2)
+#define NVIC_PRIO_SPI_DMA                  NVIC_BUILD_PRIORITY(3, 0)
+#define NVIC_PRIO_ADC_DMA                  NVIC_BUILD_PRIORITY(3, 1)
 #define NVIC_PRIO_I2C_ER                   NVIC_BUILD_PRIORITY(0, 0)
 #define NVIC_PRIO_I2C_EV                   NVIC_BUILD_PRIORITY(0, 0)
 #define NVIC_PRIO_USB                      NVIC_BUILD_PRIORITY(2, 0)
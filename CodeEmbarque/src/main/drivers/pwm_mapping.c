@@ -37,7 +37,11 @@
 void pwmBrushedMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse);
 void pwmBrushlessMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse);
 void pwmOneshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex);
+#ifdef USE_DSHOT
+bool pwmDshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, motorProtocol_e protocol, uint16_t idlePulse);
+#endif
 void pwmServoConfig(const timerHardware_t *timerHardware, uint8_t servoIndex, uint16_t servoPwmRate, uint16_t servoCenterPulse);
+void pwmSyncOutputTimers(void);
 
 /*
     Configuration maps
@@ -107,14 +111,15 @@ static const uint16_t multiPWM[] = {
     PWM6  | (MAP_TO_PWM_INPUT << 8),
     PWM7  | (MAP_TO_PWM_INPUT << 8),
     PWM8  | (MAP_TO_PWM_INPUT << 8),
-    PWM9  | (MAP_TO_MOTOR_OUTPUT  << 8), //MOTORS
-    PWM10 | (MAP_TO_MOTOR_OUTPUT  << 8),
-    PWM11 | (MAP_TO_MOTOR_OUTPUT  << 8),
+    // the motors own TIM4 so that DShot does not take a servo timer, and go out in one DMA burst
+    PWM11 | (MAP_TO_MOTOR_OUTPUT  << 8), //MOTORS, SPRACINGF3 PWM3..6 (TIM4)
     PWM12 | (MAP_TO_MOTOR_OUTPUT  << 8),
-    PWM13 | (MAP_TO_SERVO_OUTPUT  << 8), //SERVOS
-    PWM14 | (MAP_TO_SERVO_OUTPUT  << 8),
-    PWM15 | (MAP_TO_SERVO_OUTPUT  << 8),
+    PWM13 | (MAP_TO_MOTOR_OUTPUT  << 8),
+    PWM14 | (MAP_TO_MOTOR_OUTPUT  << 8),
+    PWM15 | (MAP_TO_SERVO_OUTPUT  << 8), //SERVOS, tilt servos on SPRACINGF3 PWM7/8 (TIM15)
     PWM16 | (MAP_TO_SERVO_OUTPUT  << 8),
+    PWM9  | (MAP_TO_SERVO_OUTPUT  << 8), // SPRACINGF3 PWM1/2 (TIM16, TIM17)
+    PWM10 | (MAP_TO_SERVO_OUTPUT  << 8),
     0xFFFF
 };
 
@@ -168,6 +173,35 @@ pwmIOConfiguration_t *pwmGetOutputConfiguration(void){
     return &pwmIOConfiguration;
 }
 
+#ifdef USE_DSHOT
+// DShot runs the whole timer at the DShot bit rate, other outputs cannot share it
+static bool isServoOnMotorTimer(const uint16_t *setup)
+{
+    for (int i = 0; i < USABLE_TIMER_CHANNEL_COUNT && setup[i] != 0xFFFF; i++) {
+        if (((setup[i] & 0xFF00) >> 8) != MAP_TO_SERVO_OUTPUT)
+            continue;
+
+        TIM_TypeDef *servoTim = timerHardware[setup[i] & 0x00FF].tim;
+        for (int j = 0; j < USABLE_TIMER_CHANNEL_COUNT && setup[j] != 0xFFFF; j++) {
+            if (((setup[j] & 0xFF00) >> 8) == MAP_TO_MOTOR_OUTPUT && timerHardware[setup[j] & 0x00FF].tim == servoTim)
+                return true;
+        }
+    }
+    return false;
+}
+
+static bool isTimerUsedByDshot(TIM_TypeDef *tim)
+{
+    for (int i = 0; i < pwmIOConfiguration.ioCount; i++) {
+        const pwmPortConfiguration_t *port = &pwmIOConfiguration.ioConfigurations[i];
+        if ((port->flags & PWM_PF_OUTPUT_PROTOCOL_DSHOT) && port->timerHardware->tim == tim) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 {
     int i = 0;
@@ -180,6 +214,17 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 
     setup = hardwareMaps[i];
 
+#ifdef USE_DSHOT
+    motorProtocol_e motorProtocol = init->motorProtocol;
+#ifdef USE_SERVOS
+    // servos in use on a motor timer keep the motors on PWM rather than lose the servos, MSP_STATUS_EX reports it
+    if (motorProtocol != MOTOR_PROTOCOL_PWM && init->useServos && isServoOnMotorTimer(setup)) {
+        motorProtocol = MOTOR_PROTOCOL_PWM;
+        pwmIOConfiguration.dshotServoConflict = true;
+    }
+#endif
+#endif
+
     for (i = 0; i < USABLE_TIMER_CHANNEL_COUNT && setup[i] != 0xFFFF; i++) {
         uint8_t timerIndex = setup[i] & 0x00FF;
         uint8_t type = (setup[i] & 0xFF00) >> 8;
@@ -274,6 +319,12 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
         if (type == MAP_TO_PPM_INPUT && !init->usePPM)
             continue;
 
+#ifdef USE_DSHOT
+        // only servo outputs the mixer does not use are left on a DShot timer
+        if (type == MAP_TO_SERVO_OUTPUT && isTimerUsedByDshot(timerHardwarePtr->tim))
+            continue;
+#endif
+
         if (type == MAP_TO_PPM_INPUT) {
             ppmInConfig(timerHardwarePtr);
             pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_PPM;
@@ -284,6 +335,15 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
             pwmIOConfiguration.pwmInputCount++;
             channelIndex++;
         } else if (type == MAP_TO_MOTOR_OUTPUT) {
+#ifdef USE_DSHOT
+            if (motorProtocol != MOTOR_PROTOCOL_PWM) {
+
+                if (!pwmDshotMotorConfig(timerHardwarePtr, pwmIOConfiguration.motorCount, motorProtocol, init->idlePulse))
+                    continue;
+                pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_MOTOR | PWM_PF_OUTPUT_PROTOCOL_DSHOT;
+
+            } else
+#endif
             if (init->useOneshot) {
 
                 pwmOneshotMotorConfig(timerHardwarePtr, pwmIOConfiguration.motorCount);
@@ -320,5 +380,7 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
         pwmIOConfiguration.ioCount++;
     }
 
+    pwmSyncOutputTimers();
+
     return &pwmIOConfiguration;
 }
@@ -32,6 +32,12 @@
 #define ONESHOT125_TIMER_MHZ 8
 #define PWM_BRUSHED_TIMER_MHZ 8
 
+typedef enum {
+    MOTOR_PROTOCOL_PWM = 0,     // standard PWM, or OneShot125 when the feature is enabled
+    MOTOR_PROTOCOL_DSHOT150,
+    MOTOR_PROTOCOL_DSHOT300,
+    MOTOR_PROTOCOL_DSHOT600,
+} motorProtocol_e;
 
 typedef struct sonarGPIOConfig_s {
     GPIO_TypeDef *gpio;
@@ -59,6 +65,7 @@ typedef struct drv_pwm_config_s {
 #endif
     bool useVbat;
     bool useOneshot;
+    motorProtocol_e motorProtocol;
     bool useSoftSerial;
     bool useLEDStrip;
 #ifdef SONAR
@@ -86,7 +93,8 @@ typedef enum {
     PWM_PF_OUTPUT_PROTOCOL_PWM = (1 << 3),
     PWM_PF_OUTPUT_PROTOCOL_ONESHOT = (1 << 4),
     PWM_PF_PPM = (1 << 5),
-    PWM_PF_PWM = (1 << 6)
+    PWM_PF_PWM = (1 << 6),
+    PWM_PF_OUTPUT_PROTOCOL_DSHOT = (1 << 7)
 } pwmPortFlags_e;
 
 
@@ -102,6 +110,7 @@ typedef struct pwmIOConfiguration_s {
     uint8_t ioCount;
     uint8_t pwmInputCount;
     uint8_t ppmInputCount;
+    bool dshotServoConflict;    // DShot was requested but a servo in use shares a motor timer, the motors run PWM
     pwmPortConfiguration_t ioConfigurations[USABLE_TIMER_CHANNEL_COUNT];
 } pwmIOConfiguration_t;
 
@@ -19,9 +19,12 @@
 #include <stdint.h>
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <platform.h>
 
+#include "build_config.h"
+
 #include "gpio.h"
 #include "timer.h"
 
@@ -31,15 +34,41 @@
 
 #include "common/maths.h"
 
+#ifdef USE_DSHOT
+#include "dshot.h"
+#endif
+
 #define MAX_PWM_OUTPUT_PORTS 8
 
 typedef void (*pwmWriteFuncPtr)(uint8_t index, uint16_t value);  // function pointer used to write motors
 
+#ifdef USE_DSHOT
+#define MAX_DSHOT_TIMERS            MAX_PWM_MOTORS
+#define DSHOT_DMA_BUFFER_SIZE       (DSHOT_FRAME_BITS + 2)  // trailing zero pulses hold the line low after the frame
+#define DSHOT_BIT_PERIOD            20
+#define DSHOT_BIT_0_PULSE           7
+#define DSHOT_BIT_1_PULSE           14
+
+// One DMA channel per timer writes the CCRs of all its DShot channels in a burst on each update event
+typedef struct {
+    TIM_TypeDef *tim;
+    DMA_Channel_TypeDef *dmaChannel;
+    uint8_t firstChannel;               // index of the lowest CCR in the burst, 0 = CCR1
+    uint8_t channelCount;               // burst length
+    uint16_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE * 4];
+} dshotTimer_t;
+#endif
+
 typedef struct {
     volatile timCCR_t *ccr;
     TIM_TypeDef *tim;
     uint16_t period;
     pwmWriteFuncPtr pwmWritePtr;
+#ifdef USE_DSHOT
+    dshotTimer_t *dshotTimer;
+    uint8_t dshotChannel;
+    bool dshotTelemetryRequest;         // set the telemetry bit in the next frame
+#endif
 } pwmOutputPort_t;
 
 static pwmOutputPort_t pwmOutputPorts[MAX_PWM_OUTPUT_PORTS];
@@ -50,6 +79,14 @@ static pwmOutputPort_t *servos[MAX_PWM_SERVOS];
 static uint8_t allocatedOutputPortCount = 0;
 
 static bool pwmMotorsEnabled = true;
+static bool pwmOutputUpdateStarted = false;
+
+#ifdef USE_DSHOT
+static dshotTimer_t dshotTimers[MAX_DSHOT_TIMERS];
+static uint8_t dshotTimerCount = 0;
+static uint16_t dshotIdlePulse;
+#endif
+
 static void pwmOCConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t value)
 {
     TIM_OCInitTypeDef  TIM_OCInitStructure;
@@ -135,6 +172,28 @@ static void pwmWriteStandard(uint8_t index, uint16_t value)
     *motors[index]->ccr = value;
 }
 
+#ifdef USE_DSHOT
+static void pwmWriteDshot(uint8_t index, uint16_t value)
+{
+    pwmOutputPort_t *motor = motors[index];
+    dshotTimer_t *dshotTimer = motor->dshotTimer;
+    uint16_t dshotValue = DSHOT_DISARM_VALUE;
+
+    if (value > dshotIdlePulse) {
+        dshotValue = constrain(scaleRange(value, PULSE_1MS, 2 * PULSE_1MS, DSHOT_MIN_THROTTLE, DSHOT_MAX_THROTTLE), DSHOT_MIN_THROTTLE, DSHOT_MAX_THROTTLE);
+    }
+
+    dshotFrameToPulses(
+        dshotEncodeFrame(dshotValue, motor->dshotTelemetryRequest),
+        &dshotTimer->dmaBuffer[motor->dshotChannel - dshotTimer->firstChannel],
+        dshotTimer->channelCount,
+        DSHOT_BIT_0_PULSE,
+        DSHOT_BIT_1_PULSE
+    );
+    motor->dshotTelemetryRequest = false;
+}
+#endif
+
 void pwmWriteMotor(uint8_t index, uint16_t value)
 {
     if (motors[index] && index < MAX_MOTORS && pwmMotorsEnabled)
@@ -146,6 +205,11 @@ void pwmShutdownPulsesForAllMotors(uint8_t motorCount)
     uint8_t index;
 
     for(index = 0; index < motorCount; index++){
+#ifdef USE_DSHOT
+        if (motors[index]->dshotTimer) {
+            DMA_Cmd(motors[index]->dshotTimer->dmaChannel, DISABLE);
+        }
+#endif
         // Set the compare register to 0, which stops the output pulsing if the timer overflows
         *motors[index]->ccr = 0;
     }
@@ -181,6 +245,160 @@ void pwmCompleteOneshotMotorUpdate(uint8_t motorCount)
     }
 }
 
+#ifdef USE_DSHOT
+bool isMotorProtocolDshot(void)
+{
+    return dshotTimerCount > 0;
+}
+
+void pwmRequestDshotTelemetry(uint8_t index)
+{
+    if (index < MAX_MOTORS && motors[index] && motors[index]->dshotTimer) {
+        motors[index]->dshotTelemetryRequest = true;
+    }
+}
+
+void pwmCompleteDshotMotorUpdate(uint8_t motorCount)
+{
+    UNUSED(motorCount);
+
+    uint8_t reloadedTimers = 0;
+
+    // reload every DMA channel first then release the timers back to back, so all frames start together
+    for (int i = 0; i < dshotTimerCount; i++) {
+        dshotTimer_t *dshotTimer = &dshotTimers[i];
+
+        if ((dshotTimer->dmaChannel->CCR & DMA_CCR_EN) && DMA_GetCurrDataCounter(dshotTimer->dmaChannel)) {
+            continue; // previous frame still being sent, restarting would corrupt it
+        }
+
+        TIM_DMACmd(dshotTimer->tim, TIM_DMA_Update, DISABLE);
+        DMA_Cmd(dshotTimer->dmaChannel, DISABLE);
+        DMA_SetCurrDataCounter(dshotTimer->dmaChannel, DSHOT_DMA_BUFFER_SIZE * dshotTimer->channelCount);
+        DMA_Cmd(dshotTimer->dmaChannel, ENABLE);
+        reloadedTimers |= (1 << i);
+    }
+
+    for (int i = 0; i < dshotTimerCount; i++) {
+        if (reloadedTimers & (1 << i)) {
+            TIM_SetCounter(dshotTimers[i].tim, 0);
+            TIM_DMACmd(dshotTimers[i].tim, TIM_DMA_Update, ENABLE);
+        }
+    }
+}
+
+// DMA channel serving the update event of each timer, see the STM32F303 DMA request mapping
+static DMA_Channel_TypeDef *dshotDmaChannelForTimer(TIM_TypeDef *tim)
+{
+    if (tim == TIM1 || tim == TIM15) {
+        return DMA1_Channel5;
+    }
+    if (tim == TIM2) {
+        return DMA1_Channel2;
+    }
+    if (tim == TIM3 || tim == TIM16) {
+        return DMA1_Channel3;
+    }
+    if (tim == TIM4) {
+        return DMA1_Channel7;
+    }
+    if (tim == TIM17) {
+        return DMA1_Channel1;
+    }
+    return NULL;
+}
+
+static void dshotTimerConfigDMA(dshotTimer_t *dshotTimer)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(dshotTimer->dmaChannel);
+
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&dshotTimer->tim->DMAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)dshotTimer->dmaBuffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = DSHOT_DMA_BUFFER_SIZE * dshotTimer->channelCount;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(dshotTimer->dmaChannel, &DMA_InitStructure);
+
+    TIM_DMAConfig(dshotTimer->tim, TIM_DMABase_CCR1 + dshotTimer->firstChannel, (dshotTimer->channelCount - 1) << 8);
+}
+
+static dshotTimer_t *dshotTimerAddChannel(TIM_TypeDef *tim, uint8_t channel)
+{
+    dshotTimer_t *dshotTimer = NULL;
+
+    for (int i = 0; i < dshotTimerCount; i++) {
+        if (dshotTimers[i].tim == tim) {
+            dshotTimer = &dshotTimers[i];
+        }
+    }
+
+    if (!dshotTimer) {
+        DMA_Channel_TypeDef *dmaChannel = dshotDmaChannelForTimer(tim);
+        if (!dmaChannel || dshotTimerCount >= MAX_DSHOT_TIMERS) {
+            return NULL;
+        }
+        dshotTimer = &dshotTimers[dshotTimerCount++];
+        memset(dshotTimer, 0, sizeof(dshotTimer_t));
+        dshotTimer->tim = tim;
+        dshotTimer->dmaChannel = dmaChannel;
+        dshotTimer->firstChannel = channel;
+        dshotTimer->channelCount = 1;
+    } else {
+        // widen the burst to cover the new channel, frames are rebuilt on the next motor write
+        uint8_t lastChannel = MAX(dshotTimer->firstChannel + dshotTimer->channelCount - 1, channel);
+        dshotTimer->firstChannel = MIN(dshotTimer->firstChannel, channel);
+        dshotTimer->channelCount = lastChannel - dshotTimer->firstChannel + 1;
+        memset(dshotTimer->dmaBuffer, 0, sizeof(dshotTimer->dmaBuffer));
+    }
+
+    dshotTimerConfigDMA(dshotTimer);
+
+    return dshotTimer;
+}
+
+bool pwmDshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, motorProtocol_e protocol, uint16_t idlePulse)
+{
+    // TIM_Channel_x values are 0, 4, 8, 12
+    dshotTimer_t *dshotTimer = dshotTimerAddChannel(timerHardware->tim, timerHardware->channel / 4);
+    if (!dshotTimer) {
+        return false;
+    }
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    uint8_t mhz;
+    switch (protocol) {
+        case MOTOR_PROTOCOL_DSHOT150:
+            mhz = 3;
+            break;
+        case MOTOR_PROTOCOL_DSHOT300:
+            mhz = 6;
+            break;
+        default:
+        case MOTOR_PROTOCOL_DSHOT600:
+            mhz = 12;
+            break;
+    }
+
+    motors[motorIndex] = pwmOutConfig(timerHardware, mhz, DSHOT_BIT_PERIOD, 0);
+    motors[motorIndex]->pwmWritePtr = pwmWriteDshot;
+    motors[motorIndex]->dshotTimer = dshotTimer;
+    motors[motorIndex]->dshotChannel = timerHardware->channel / 4;
+    dshotIdlePulse = idlePulse;
+
+    return true;
+}
+#endif
+
 bool isMotorBrushed(uint16_t motorPwmRate)
 {
     return (motorPwmRate > 500);
@@ -213,6 +431,57 @@ void pwmServoConfig(const timerHardware_t *timerHardware, uint8_t servoIndex, ui
 
 void pwmWriteServo(uint8_t index, uint16_t value)
 {
+    // high rate digital servos leave little room after the pulse, never let it cover the whole period
     if (servos[index] && index < MAX_SERVOS)
-        *servos[index]->ccr = value;
+        *servos[index]->ccr = MIN(value, servos[index]->period - 1);
+}
+
+static bool isOutputPortPreloaded(const pwmOutputPort_t *port)
+{
+#ifdef USE_DSHOT
+    // DShot CCRs are written by DMA on each update event, these timers must keep running
+    if (port->dshotTimer) {
+        return false;
+    }
+#endif
+    return port->tim != NULL;
+}
+
+/*
+ * Every CCR is preloaded, the new values are copied on the next update event of their timer.
+ * Update events are held off on all output timers while the motor and servo values are written,
+ * so a timer never outputs a mix of this loop's and the previous loop's values.
+ */
+void pwmStartOutputUpdate(void)
+{
+    for (int i = 0; i < allocatedOutputPortCount; i++) {
+        if (isOutputPortPreloaded(&pwmOutputPorts[i])) {
+            TIM_UpdateDisableConfig(pwmOutputPorts[i].tim, ENABLE);
+        }
+    }
+    pwmOutputUpdateStarted = true;
+}
+
+void pwmCompleteOutputUpdate(void)
+{
+    if (!pwmOutputUpdateStarted) {
+        return;
+    }
+
+    for (int i = 0; i < allocatedOutputPortCount; i++) {
+        if (isOutputPortPreloaded(&pwmOutputPorts[i])) {
+            TIM_UpdateDisableConfig(pwmOutputPorts[i].tim, DISABLE);
+        }
+    }
+    pwmOutputUpdateStarted = false;
+}
+
+// Restart all output timers back to back, outputs running at the same rate then stay in phase
+void pwmSyncOutputTimers(void)
+{
+    for (int i = 0; i < allocatedOutputPortCount; i++) {
+        if (isOutputPortPreloaded(&pwmOutputPorts[i])) {
+            TIM_GenerateEvent(pwmOutputPorts[i].tim, TIM_EventSource_Update);
+        }
+    }
 }
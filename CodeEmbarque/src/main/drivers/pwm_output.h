@@ -21,8 +21,17 @@ void pwmWriteMotor(uint8_t index, uint16_t value);
 void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
 void pwmCompleteOneshotMotorUpdate(uint8_t motorCount);
 
+#ifdef USE_DSHOT
+bool isMotorProtocolDshot(void);
+void pwmRequestDshotTelemetry(uint8_t index);
+void pwmCompleteDshotMotorUpdate(uint8_t motorCount);
+#endif
+
 void pwmWriteServo(uint8_t index, uint16_t value);
 
+void pwmStartOutputUpdate(void);
+void pwmCompleteOutputUpdate(void);
+
 bool isMotorBrushed(uint16_t motorPwmRate);
 
 void pwmDisableMotors(void);
@@ -24,4 +24,5 @@ struct acc_s;
 typedef void (*sensorAccInitFuncPtr)(struct acc_s *acc);                    // sensor init prototype
 typedef void (*sensorGyroInitFuncPtr)(uint8_t lpf);         // gyro sensor init prototype
 typedef bool (*sensorIsDataReadyFuncPtr)(void);             // sensor data ready prototype
+typedef int8_t (*sensorReadBatchFuncPtr)(int16_t *data, uint8_t maxSamples); // batched read prototype, returns sample count or -1 on overrun
 
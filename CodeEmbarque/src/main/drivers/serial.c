@@ -35,6 +35,15 @@ uint32_t serialGetBaudRate(serialPort_t *instance)
     return instance->baudRate;
 }
 
+/*
+ * Ports with idle-line DMA reception hand over each burst in one call, other
+ * ports deliver bytes one at a time through the same callback.
+ */
+void serialSetReceiveBurstCallback(serialPort_t *instance, serialReceiveBurstCallbackPtr burstCallback)
+{
+    instance->burstCallback = burstCallback;
+}
+
 void serialWrite(serialPort_t *instance, uint8_t ch)
 {
     instance->vTable->serialWrite(instance, ch);
@@ -56,12 +65,12 @@ void serialWriteBuf(serialPort_t *instance, uint8_t *data, int count)
     }
 }
 
-uint8_t serialRxBytesWaiting(serialPort_t *instance)
+uint32_t serialRxBytesWaiting(serialPort_t *instance)
 {
     return instance->vTable->serialTotalRxWaiting(instance);
 }
 
-uint8_t serialTxBytesFree(serialPort_t *instance)
+uint32_t serialTxBytesFree(serialPort_t *instance)
 {
     return instance->vTable->serialTotalTxFree(instance);
 }
@@ -102,3 +111,39 @@ void serialEndWrite(serialPort_t *instance)
     if (instance->vTable->endWrite)
         instance->vTable->endWrite(instance);
 }
+
+uint32_t serialPeekRx(serialPort_t *instance, const volatile uint8_t **data)
+{
+    if (instance->vTable->peekRx)
+        return instance->vTable->peekRx(instance, data);
+
+    return ringBufferReadSpan(&instance->rxBuffer, data);
+}
+
+void serialConsumeRx(serialPort_t *instance, uint32_t count)
+{
+    if (instance->vTable->consumeRx) {
+        instance->vTable->consumeRx(instance, count);
+        return;
+    }
+
+    ringBufferConsume(&instance->rxBuffer, count);
+}
+
+uint32_t serialReserveTx(serialPort_t *instance, volatile uint8_t **data)
+{
+    if (instance->vTable->reserveTx)
+        return instance->vTable->reserveTx(instance, data);
+
+    return ringBufferWriteSpan(&instance->txBuffer, data);
+}
+
+void serialCommitTx(serialPort_t *instance, uint32_t count)
+{
+    if (instance->vTable->commitTx) {
+        instance->vTable->commitTx(instance, count);
+        return;
+    }
+
+    ringBufferCommit(&instance->txBuffer, count);
+}
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/ring_buffer.h"
+
 typedef enum portMode_t {
     MODE_RX = 1 << 0,
     MODE_TX = 1 << 1,
@@ -35,6 +37,8 @@ typedef enum portOptions_t {
 } portOptions_t;
 
 typedef void (*serialReceiveCallbackPtr)(uint16_t data);   // used by serial drivers to return frames to app
+// used by serial drivers to return a whole burst of bytes, firstByteTime is the micros() at the start bit of data[0]
+typedef void (*serialReceiveBurstCallbackPtr)(const volatile uint8_t *data, uint16_t count, uint32_t firstByteTime);
 
 typedef struct serialPort_s {
 
@@ -46,24 +50,20 @@ typedef struct serialPort_s {
 
     uint32_t baudRate;
 
-    uint32_t rxBufferSize;
-    uint32_t txBufferSize;
-    volatile uint8_t *rxBuffer;
-    volatile uint8_t *txBuffer;
-    uint32_t rxBufferHead;
-    uint32_t rxBufferTail;
-    uint32_t txBufferHead;
-    uint32_t txBufferTail;
+    ringBuffer_t rxBuffer;
+    ringBuffer_t txBuffer;
 
     // FIXME rename member to rxCallback
     serialReceiveCallbackPtr callback;
+    // takes precedence over callback when set
+    serialReceiveBurstCallbackPtr burstCallback;
 } serialPort_t;
 
 struct serialPortVTable {
     void (*serialWrite)(serialPort_t *instance, uint8_t ch);
 
-    uint8_t (*serialTotalRxWaiting)(serialPort_t *instance);
-    uint8_t (*serialTotalTxFree)(serialPort_t *instance);
+    uint32_t (*serialTotalRxWaiting)(serialPort_t *instance);
+    uint32_t (*serialTotalTxFree)(serialPort_t *instance);
 
     uint8_t (*serialRead)(serialPort_t *instance);
 
@@ -78,11 +78,17 @@ struct serialPortVTable {
     // Optional functions used to buffer large writes.
     void (*beginWrite)(serialPort_t *instance);
     void (*endWrite)(serialPort_t *instance);
+
+    // Optional zero-copy access, the rxBuffer/txBuffer rings are used directly when not provided.
+    uint32_t (*peekRx)(serialPort_t *instance, const volatile uint8_t **data);
+    void (*consumeRx)(serialPort_t *instance, uint32_t count);
+    uint32_t (*reserveTx)(serialPort_t *instance, volatile uint8_t **data);
+    void (*commitTx)(serialPort_t *instance, uint32_t count);
 };
 
 void serialWrite(serialPort_t *instance, uint8_t ch);
-uint8_t serialRxBytesWaiting(serialPort_t *instance);
-uint8_t serialTxBytesFree(serialPort_t *instance);
+uint32_t serialRxBytesWaiting(serialPort_t *instance);
+uint32_t serialTxBytesFree(serialPort_t *instance);
 void serialWriteBuf(serialPort_t *instance, uint8_t *data, int count);
 uint8_t serialRead(serialPort_t *instance);
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
@@ -90,8 +96,16 @@ void serialSetMode(serialPort_t *instance, portMode_t mode);
 bool isSerialTransmitBufferEmpty(serialPort_t *instance);
 void serialPrint(serialPort_t *instance, const char *str);
 uint32_t serialGetBaudRate(serialPort_t *instance);
+void serialSetReceiveBurstCallback(serialPort_t *instance, serialReceiveBurstCallbackPtr burstCallback);
 
 // A shim that adapts the bufWriter API to the serialWriteBuf() API.
 void serialWriteBufShim(void *instance, uint8_t *data, int count);
 void serialBeginWrite(serialPort_t *instance);
 void serialEndWrite(serialPort_t *instance);
+
+// Contiguous readable region at the read position, its length is returned, release it with serialConsumeRx().
+uint32_t serialPeekRx(serialPort_t *instance, const volatile uint8_t **data);
+void serialConsumeRx(serialPort_t *instance, uint32_t count);
+// Contiguous writable region at the write position, its length is returned, queue it with serialCommitTx().
+uint32_t serialReserveTx(serialPort_t *instance, volatile uint8_t **data);
+void serialCommitTx(serialPort_t *instance, uint32_t count);
@@ -36,9 +36,30 @@
 #include "serial.h"
 #include "serial_softserial.h"
 
+/*
+ * The ports run from one free running timer whatever their baud rate.
+ *
+ * RX captures both edges of the pin into a per byte edge list and rebuilds the
+ * byte from the edge timestamps once, from a compare event in the middle of the
+ * stop bit.  TX drives the pin from compare events placed on the level changes
+ * of the frame only.  An idle port takes no interrupt, a busy one takes one per
+ * edge instead of one per bit period of the timer.
+ *
+ * The TX channel compare schedules both the TX level changes and the RX end of
+ * byte, the TX pin is a plain GPIO.
+ */
+
 #define RX_TOTAL_BITS 10
 #define TX_TOTAL_BITS 10
 
+// at most one edge per bit after the start edge
+#define RX_MAX_EDGES (RX_TOTAL_BITS - 1)
+
+// 16 bit counter, one frame must fit in half of it down to 1200 baud
+#define SOFTSERIAL_TIMER_MHZ 2
+// margin for an event scheduled from the current counter value
+#define SOFTSERIAL_MIN_EVENT_TICKS 8
+
 #if defined(USE_SOFTSERIAL1) && defined(USE_SOFTSERIAL2)
 #define MAX_SOFTSERIAL_PORTS 2
 #else
@@ -54,16 +75,20 @@ typedef struct softSerial_s {
     const timerHardware_t *txTimerHardware;
     volatile uint8_t txBuffer[SOFTSERIAL_BUFFER_SIZE];
 
-    uint8_t          isSearchingForStartBit;
-    uint8_t          rxBitIndex;
-    uint8_t          rxLastLeadingEdgeAtBitIndex;
-    uint8_t          rxEdge;
+    uint32_t         bitTicks;          // timer ticks per bit, in 1/256 tick
 
-    uint8_t          isTransmittingData;
-    int8_t           bitsLeftToTransmit;
+    bool             rxActive;
+    bool             rxAtSpace;         // line level, follows the edges since the last start bit
+    uint16_t         rxStartAt;
+    uint16_t         rxByteEndAt;
+    uint8_t          rxEdgeCount;
+    uint16_t         rxEdgeOffsets[RX_MAX_EDGES];
 
-    uint16_t         internalTxBuffer;  // includes start and stop bits
-    uint16_t         internalRxBuffer;  // includes start and stop bits
+    volatile bool    isTransmittingData;
+    uint16_t         txFrame;           // includes start and stop bits, sent LSB first
+    uint16_t         txFrameStartAt;
+    uint16_t         txNextAt;
+    uint8_t          txBitIndex;
 
     uint16_t         transmissionErrors;
     uint16_t         receiveErrors;
@@ -113,31 +138,15 @@ void serialInputPortConfig(const timerHardware_t *timerHardwarePtr)
     softSerialGPIOConfig(timerHardwarePtr->gpio, timerHardwarePtr->pin, Mode_AF_PP_PU);
 }
 
-static bool isTimerPeriodTooLarge(uint32_t timerPeriod)
+static void serialTimerTxConfig(const timerHardware_t *timerHardwarePtr, uint8_t reference)
 {
-    return timerPeriod > 0xFFFF;
-}
-
-static void serialTimerTxConfig(const timerHardware_t *timerHardwarePtr, uint8_t reference, uint32_t baud)
-{
-    uint32_t clock = SystemCoreClock;
-    uint32_t timerPeriod;
-    do {
-        timerPeriod = clock / baud;
-        if (isTimerPeriodTooLarge(timerPeriod)) {
-            if (clock > 1) {
-                clock = clock / 2;   // this is wrong - mhz stays the same ... This will double baudrate until ok (but minimum baudrate is < 1200)
-            } else {
-                // TODO unable to continue, unable to determine clock and timerPeriods for the given baud
-            }
-
-        }
-    } while (isTimerPeriodTooLarge(timerPeriod));
-
-    uint8_t mhz = SystemCoreClock / 1000000;
-    timerConfigure(timerHardwarePtr, timerPeriod, mhz);
+    // a period of 0 wraps the 16 bit counter at 0xFFFF
+    timerConfigure(timerHardwarePtr, 0, SOFTSERIAL_TIMER_MHZ);
+    timerChConfigOC(timerHardwarePtr, false, false);
     timerChCCHandlerInit(&softSerialPorts[reference].timerCb, onSerialTimer);
     timerChConfigCallbacks(timerHardwarePtr, &softSerialPorts[reference].timerCb, NULL);
+    // enabled when an event is scheduled
+    timerChITConfig(timerHardwarePtr, DISABLE);
 }
 
 static void serialICConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t polarity)
@@ -154,10 +163,10 @@ static void serialICConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t polarity)
     TIM_ICInit(tim, &TIM_ICInitStructure);
 }
 
-static void serialTimerRxConfig(const timerHardware_t *timerHardwarePtr, uint8_t reference, portOptions_t options)
+static void serialTimerRxConfig(const timerHardware_t *timerHardwarePtr, uint8_t reference)
 {
-    // start bit is usually a FALLING signal
-    serialICConfig(timerHardwarePtr->tim, timerHardwarePtr->channel, (options & SERIAL_INVERTED) ? TIM_ICPolarity_Rising : TIM_ICPolarity_Falling);
+    // the level follows from the edge count since the start bit, so the polarity does not matter
+    serialICConfig(timerHardwarePtr->tim, timerHardwarePtr->channel, TIM_ICPolarity_BothEdge);
     timerChCCHandlerInit(&softSerialPorts[reference].edgeCb, onSerialRxPinChange);
     timerChConfigCallbacks(timerHardwarePtr, &softSerialPorts[reference].edgeCb, NULL);
 }
@@ -169,15 +178,9 @@ static void serialOutputPortConfig(const timerHardware_t *timerHardwarePtr)
 
 static void resetBuffers(softSerial_t *softSerial)
 {
-    softSerial->port.rxBufferSize = SOFTSERIAL_BUFFER_SIZE;
-    softSerial->port.rxBuffer = softSerial->rxBuffer;
-    softSerial->port.rxBufferTail = 0;
-    softSerial->port.rxBufferHead = 0;
-
-    softSerial->port.txBuffer = softSerial->txBuffer;
-    softSerial->port.txBufferSize = SOFTSERIAL_BUFFER_SIZE;
-    softSerial->port.txBufferTail = 0;
-    softSerial->port.txBufferHead = 0;
+    ringBufferInit(&softSerial->port.rxBuffer, softSerial->rxBuffer, SOFTSERIAL_BUFFER_SIZE);
+
+    ringBufferInit(&softSerial->port.txBuffer, softSerial->txBuffer, SOFTSERIAL_BUFFER_SIZE);
 }
 
 serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr callback, uint32_t baud, portOptions_t options)
@@ -206,10 +209,11 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
 
     resetBuffers(softSerial);
 
-    softSerial->isTransmittingData = false;
+    softSerial->bitTicks = (SOFTSERIAL_TIMER_MHZ * 1000000 * 256) / baud;
 
-    softSerial->isSearchingForStartBit = true;
-    softSerial->rxBitIndex = 0;
+    softSerial->isTransmittingData = false;
+    softSerial->rxActive = false;
+    softSerial->rxAtSpace = false;
 
     softSerial->transmissionErrors = 0;
     softSerial->receiveErrors = 0;
@@ -222,188 +226,216 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     setTxSignal(softSerial, ENABLE);
     delay(50);
 
-    serialTimerTxConfig(softSerial->txTimerHardware, portIndex, baud);
-    serialTimerRxConfig(softSerial->rxTimerHardware, portIndex, options);
+    serialTimerTxConfig(softSerial->txTimerHardware, portIndex);
+    serialTimerRxConfig(softSerial->rxTimerHardware, portIndex);
 
     return &softSerial->port;
 }
 
 /*********************************************/
 
-void processTxState(softSerial_t *softSerial)
+static uint16_t bitOffsetTicks(softSerial_t *softSerial, uint8_t bitIndex)
 {
-    uint8_t mask;
-
-    if (!softSerial->isTransmittingData) {
-        char byteToSend;
-        if (isSoftSerialTransmitBufferEmpty((serialPort_t *)softSerial)) {
-            return;
-        }
+    return (bitIndex * softSerial->bitTicks) >> 8;
+}
 
-        // data to send
-        byteToSend = softSerial->port.txBuffer[softSerial->port.txBufferTail++];
-        if (softSerial->port.txBufferTail >= softSerial->port.txBufferSize) {
-            softSerial->port.txBufferTail = 0;
-        }
+// Programs the compare for the earliest pending TX level change or RX end of byte
+static void scheduleNextEvent(softSerial_t *softSerial)
+{
+    const timerHardware_t *timHw = softSerial->txTimerHardware;
+    bool pending = false;
+    uint16_t at = 0;
 
-        // build internal buffer, MSB = Stop Bit (1) + data bits (MSB to LSB) + start bit(0) LSB
-        softSerial->internalTxBuffer = (1 << (TX_TOTAL_BITS - 1)) | (byteToSend << 1);
-        softSerial->bitsLeftToTransmit = TX_TOTAL_BITS;
-        softSerial->isTransmittingData = true;
+    if (softSerial->isTransmittingData) {
+        at = softSerial->txNextAt;
+        pending = true;
+    }
+    if (softSerial->rxActive && (!pending || (int16_t)(softSerial->rxByteEndAt - at) < 0)) {
+        at = softSerial->rxByteEndAt;
+        pending = true;
+    }
 
+    if (!pending) {
+        timerChITConfig(timHw, DISABLE);
         return;
     }
 
-    if (softSerial->bitsLeftToTransmit) {
-        mask = softSerial->internalTxBuffer & 1;
-        softSerial->internalTxBuffer >>= 1;
-
-        setTxSignal(softSerial, mask);
-        softSerial->bitsLeftToTransmit--;
-        return;
+    uint16_t now = timHw->tim->CNT;
+    if ((int16_t)(at - now) < SOFTSERIAL_MIN_EVENT_TICKS) {
+        at = now + SOFTSERIAL_MIN_EVENT_TICKS;
     }
 
-    softSerial->isTransmittingData = false;
+    *timerChCCR(timHw) = at;
+    timerChClearCCFlag(timHw);
+    timerChITConfig(timHw, ENABLE);
 }
 
+// Drives the level of the current bit and finds the next level change, or the end of the frame
+static void applyTxBit(softSerial_t *softSerial)
+{
+    uint8_t level = (softSerial->txFrame >> softSerial->txBitIndex) & 1;
+    setTxSignal(softSerial, level);
 
+    uint8_t nextBitIndex = softSerial->txBitIndex + 1;
+    while (nextBitIndex < TX_TOTAL_BITS && ((softSerial->txFrame >> nextBitIndex) & 1) == level) {
+        nextBitIndex++;
+    }
 
-enum {
-    TRAILING,
-    LEADING
-};
+    softSerial->txBitIndex = nextBitIndex;
+    softSerial->txNextAt = softSerial->txFrameStartAt + bitOffsetTicks(softSerial, nextBitIndex);
+}
 
-void applyChangedBits(softSerial_t *softSerial)
+static void startTxFrame(softSerial_t *softSerial, uint16_t startAt)
 {
-    if (softSerial->rxEdge == TRAILING) {
-        uint8_t bitToSet;
-        for (bitToSet = softSerial->rxLastLeadingEdgeAtBitIndex; bitToSet < softSerial->rxBitIndex; bitToSet++) {
-            softSerial->internalRxBuffer |= 1 << bitToSet;
-        }
+    if (ringBufferIsEmpty(&softSerial->port.txBuffer)) {
+        softSerial->isTransmittingData = false;
+        return;
     }
+
+    // MSB = Stop Bit (1) + data bits (MSB to LSB) + start bit(0) LSB
+    softSerial->txFrame = (1 << (TX_TOTAL_BITS - 1)) | (ringBufferPop(&softSerial->port.txBuffer) << 1);
+    softSerial->txFrameStartAt = startAt;
+    softSerial->txBitIndex = 0;
+    softSerial->isTransmittingData = true;
+
+    applyTxBit(softSerial);
 }
 
-void prepareForNextRxByte(softSerial_t *softSerial)
+void processTxState(softSerial_t *softSerial)
 {
-    // prepare for next byte
-    softSerial->rxBitIndex = 0;
-    softSerial->isSearchingForStartBit = true;
-    if (softSerial->rxEdge == LEADING) {
-        softSerial->rxEdge = TRAILING;
-        serialICConfig(
-            softSerial->rxTimerHardware->tim,
-            softSerial->rxTimerHardware->channel,
-            (softSerial->port.options & SERIAL_INVERTED) ? TIM_ICPolarity_Rising : TIM_ICPolarity_Falling
-        );
+    if (softSerial->txBitIndex >= TX_TOTAL_BITS) {
+        // end of the stop bit, the next start bit follows without gap
+        startTxFrame(softSerial, softSerial->txNextAt);
+    } else {
+        applyTxBit(softSerial);
     }
 }
 
-#define STOP_BIT_MASK (1 << 0)
-#define START_BIT_MASK (1 << (RX_TOTAL_BITS - 1))
+#define START_BIT_MASK (1 << 0)
+#define STOP_BIT_MASK (1 << (RX_TOTAL_BITS - 1))
+
+/*
+ * Rebuilds a frame from the edge offsets after its start edge, LSB first with
+ * the start bit in bit 0 and 1 for mark.  The line is at space from the start
+ * edge and toggles on every edge, each edge is placed on the closest bit
+ * boundary.  Pure function of its inputs.
+ */
+STATIC_UNIT_TESTED uint16_t decodeRxFrame(const uint16_t *edgeOffsets, uint8_t edgeCount, uint32_t bitTicks)
+{
+    uint16_t frame = 0;
+    uint8_t level = 0;
+    uint8_t bitIndex = 0;
+
+    for (int i = 0; i < edgeCount; i++) {
+        uint32_t edgeBitIndex = ((uint32_t)edgeOffsets[i] * 256 + bitTicks / 2) / bitTicks;
+        if (edgeBitIndex > RX_TOTAL_BITS) {
+            edgeBitIndex = RX_TOTAL_BITS;
+        }
+        for (; bitIndex < edgeBitIndex; bitIndex++) {
+            frame |= level << bitIndex;
+        }
+        level ^= 1;
+    }
+    for (; bitIndex < RX_TOTAL_BITS; bitIndex++) {
+        frame |= level << bitIndex;
+    }
+
+    return frame;
+}
 
-void extractAndStoreRxByte(softSerial_t *softSerial)
+void extractAndStoreRxByte(softSerial_t *softSerial, uint16_t now)
 {
-    if ((softSerial->port.mode & MODE_RX) == 0) {
+    if (softSerial->rxEdgeCount > RX_MAX_EDGES) {
+        softSerial->receiveErrors++;
         return;
     }
 
-    uint8_t haveStartBit = (softSerial->internalRxBuffer & START_BIT_MASK) == 0;
-    uint8_t haveStopBit = (softSerial->internalRxBuffer & STOP_BIT_MASK) == 1;
+    uint16_t frame = decodeRxFrame(softSerial->rxEdgeOffsets, softSerial->rxEdgeCount, softSerial->bitTicks);
+
+    bool haveStartBit = (frame & START_BIT_MASK) == 0;
+    bool haveStopBit = (frame & STOP_BIT_MASK) != 0;
 
     if (!haveStartBit || !haveStopBit) {
         softSerial->receiveErrors++;
         return;
     }
 
-    uint8_t rxByte = (softSerial->internalRxBuffer >> 1) & 0xFF;
+    uint8_t rxByte = (frame >> 1) & 0xFF;
 
-    if (softSerial->port.callback) {
+    if (softSerial->port.burstCallback) {
+        uint32_t startAt = micros() - (uint16_t)(now - softSerial->rxStartAt) / SOFTSERIAL_TIMER_MHZ;
+        softSerial->port.burstCallback(&rxByte, 1, startAt);
+    } else if (softSerial->port.callback) {
         softSerial->port.callback(rxByte);
     } else {
-        softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = rxByte;
-        softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
+        if (ringBufferFree(&softSerial->port.rxBuffer)) {
+            ringBufferPush(&softSerial->port.rxBuffer, rxByte);
+        }
     }
 }
 
-void processRxState(softSerial_t *softSerial)
+void processRxState(softSerial_t *softSerial, uint16_t now)
 {
-    if (softSerial->isSearchingForStartBit) {
-        return;
-    }
-
-    softSerial->rxBitIndex++;
+    softSerial->rxActive = false;
 
-    if (softSerial->rxBitIndex == RX_TOTAL_BITS - 1) {
-        applyChangedBits(softSerial);
+    if ((softSerial->port.mode & MODE_RX) == 0) {
         return;
     }
 
-    if (softSerial->rxBitIndex == RX_TOTAL_BITS) {
-
-        if (softSerial->rxEdge == TRAILING) {
-            softSerial->internalRxBuffer |= STOP_BIT_MASK;
-        }
-
-        extractAndStoreRxByte(softSerial);
-        prepareForNextRxByte(softSerial);
-    }
+    extractAndStoreRxByte(softSerial, now);
 }
 
 void onSerialTimer(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
 {
     UNUSED(capture);
     softSerial_t *softSerial = container_of(cbRec, softSerial_t, timerCb);
+    uint16_t now = softSerial->txTimerHardware->tim->CNT;
 
-    processTxState(softSerial);
-    processRxState(softSerial);
+    if (softSerial->isTransmittingData && (int16_t)(softSerial->txNextAt - now) <= 0) {
+        processTxState(softSerial);
+    }
+    if (softSerial->rxActive && (int16_t)(softSerial->rxByteEndAt - now) <= 0) {
+        processRxState(softSerial, now);
+    }
+
+    scheduleNextEvent(softSerial);
 }
 
 void onSerialRxPinChange(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
 {
-    UNUSED(capture);
-
     softSerial_t *softSerial = container_of(cbRec, softSerial_t, edgeCb);
-    bool inverted = softSerial->port.options & SERIAL_INVERTED;
 
     if ((softSerial->port.mode & MODE_RX) == 0) {
         return;
     }
 
-    if (softSerial->isSearchingForStartBit) {
-        // synchronise bit counter
-        // FIXME this reduces functionality somewhat as receiving breaks concurrent transmission on all ports because
-        // the next callback to the onSerialTimer will happen too early causing transmission errors.
-        TIM_SetCounter(softSerial->rxTimerHardware->tim, softSerial->rxTimerHardware->tim->ARR / 2);
-        if (softSerial->isTransmittingData) {
-            softSerial->transmissionErrors++;
+    if (!softSerial->rxActive) {
+        if (softSerial->rxAtSpace) {
+            // back to mark after a frame without stop bit (break or noise), not a start bit
+            softSerial->rxAtSpace = false;
+            return;
         }
-
-        serialICConfig(softSerial->rxTimerHardware->tim, softSerial->rxTimerHardware->channel, inverted ? TIM_ICPolarity_Falling : TIM_ICPolarity_Rising);
-        softSerial->rxEdge = LEADING;
-
-        softSerial->rxBitIndex = 0;
-        softSerial->rxLastLeadingEdgeAtBitIndex = 0;
-        softSerial->internalRxBuffer = 0;
-        softSerial->isSearchingForStartBit = false;
+        // start bit, the byte is decoded in the middle of its stop bit
+        softSerial->rxActive = true;
+        softSerial->rxAtSpace = true;
+        softSerial->rxStartAt = capture;
+        softSerial->rxEdgeCount = 0;
+        softSerial->rxByteEndAt = capture + (((2 * RX_TOTAL_BITS - 1) * softSerial->bitTicks / 2) >> 8);
+        scheduleNextEvent(softSerial);
         return;
     }
 
-    if (softSerial->rxEdge == LEADING) {
-        softSerial->rxLastLeadingEdgeAtBitIndex = softSerial->rxBitIndex;
-    }
-
-    applyChangedBits(softSerial);
+    softSerial->rxAtSpace = !softSerial->rxAtSpace;
 
-    if (softSerial->rxEdge == TRAILING) {
-        softSerial->rxEdge = LEADING;
-        serialICConfig(softSerial->rxTimerHardware->tim, softSerial->rxTimerHardware->channel, inverted ? TIM_ICPolarity_Falling : TIM_ICPolarity_Rising);
-    } else {
-        softSerial->rxEdge = TRAILING;
-        serialICConfig(softSerial->rxTimerHardware->tim, softSerial->rxTimerHardware->channel, inverted ? TIM_ICPolarity_Rising : TIM_ICPolarity_Falling);
+    if (softSerial->rxEdgeCount < RX_MAX_EDGES) {
+        softSerial->rxEdgeOffsets[softSerial->rxEdgeCount] = capture - softSerial->rxStartAt;
+    }
+    if (softSerial->rxEdgeCount <= RX_MAX_EDGES) {
+        softSerial->rxEdgeCount++;
     }
 }
 
-uint8_t softSerialRxBytesWaiting(serialPort_t *instance)
+uint32_t softSerialRxBytesWaiting(serialPort_t *instance)
 {
     if ((instance->mode & MODE_RX) == 0) {
         return 0;
@@ -411,10 +443,10 @@ uint8_t softSerialRxBytesWaiting(serialPort_t *instance)
 
     softSerial_t *s = (softSerial_t *)instance;
 
-    return (s->port.rxBufferHead - s->port.rxBufferTail) & (s->port.rxBufferSize - 1);
+    return ringBufferCount(&s->port.rxBuffer);
 }
 
-uint8_t softSerialTxBytesFree(serialPort_t *instance)
+uint32_t softSerialTxBytesFree(serialPort_t *instance)
 {
     if ((instance->mode & MODE_TX) == 0) {
         return 0;
@@ -422,9 +454,7 @@ uint8_t softSerialTxBytesFree(serialPort_t *instance)
 
     softSerial_t *s = (softSerial_t *)instance;
 
-    uint8_t bytesUsed = (s->port.txBufferHead - s->port.txBufferTail) & (s->port.txBufferSize - 1);
-
-    return (s->port.txBufferSize - 1) - bytesUsed;
+    return ringBufferFree(&s->port.txBuffer);
 }
 
 uint8_t softSerialReadByte(serialPort_t *instance)
@@ -439,8 +469,7 @@ uint8_t softSerialReadByte(serialPort_t *instance)
         return 0;
     }
 
-    ch = instance->rxBuffer[instance->rxBufferTail];
-    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    ch = ringBufferPop(&instance->rxBuffer);
     return ch;
 }
 
@@ -450,8 +479,19 @@ void softSerialWriteByte(serialPort_t *s, uint8_t ch)
         return;
     }
 
-    s->txBuffer[s->txBufferHead] = ch;
-    s->txBufferHead = (s->txBufferHead + 1) % s->txBufferSize;
+    if (ringBufferFree(&s->txBuffer)) {
+        ringBufferPush(&s->txBuffer, ch);
+    }
+
+    softSerial_t *softSerial = (softSerial_t *)s;
+    if (!softSerial->isTransmittingData) {
+        ATOMIC_BLOCK(NVIC_PRIO_TIMER) {
+            if (!softSerial->isTransmittingData) {
+                startTxFrame(softSerial, softSerial->txTimerHardware->tim->CNT + SOFTSERIAL_MIN_EVENT_TICKS);
+                scheduleNextEvent(softSerial);
+            }
+        }
+    }
 }
 
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
@@ -467,7 +507,8 @@ void softSerialSetMode(serialPort_t *instance, portMode_t mode)
 
 bool isSoftSerialTransmitBufferEmpty(serialPort_t *instance)
 {
-    return instance->txBufferHead == instance->txBufferTail;
+    softSerial_t *softSerial = (softSerial_t *)instance;
+    return ringBufferIsEmpty(&instance->txBuffer) && !softSerial->isTransmittingData;
 }
 
 const struct serialPortVTable softSerialVTable[] = {
@@ -23,12 +23,14 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <platform.h>
 
 #include "build_config.h"
 
 #include "common/utils.h"
+#include "system.h"
 #include "gpio.h"
 #include "inverter.h"
 
@@ -98,6 +100,10 @@ static void uartReconfigure(uartPort_t *uartPort)
 
     USART_Init(uartPort->USARTx, &USART_InitStructure);
 
+    // start bit, 8 data bits (parity included) and the stop bits
+    uint32_t charBits = (uartPort->port.options & SERIAL_STOPBITS_2) ? 11 : 10;
+    uartPort->rxCharTime = (charBits * 256 * 1000000) / uartPort->port.baudRate;
+
     usartConfigurePinInversion(uartPort);
 
     if(uartPort->port.options & SERIAL_BIDIR)
@@ -134,12 +140,13 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback,
         return (serialPort_t *)s;
     }
     s->txDMAEmpty = true;
+    s->txBatching = false;
 
     // common serial initialisation code should move to serialPort::init()
-    s->port.rxBufferHead = s->port.rxBufferTail = 0;
-    s->port.txBufferHead = s->port.txBufferTail = 0;
-    // callback works for IRQ-based RX ONLY
+    ringBufferReset(&s->port.rxBuffer);
+    ringBufferReset(&s->port.txBuffer);
     s->port.callback = callback;
+    s->port.burstCallback = NULL;
     s->port.mode = mode;
     s->port.baudRate = baudRate;
     s->port.options = options;
@@ -159,15 +166,18 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback,
             DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
             DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
 
-            DMA_InitStructure.DMA_BufferSize = s->port.rxBufferSize;
+            DMA_InitStructure.DMA_BufferSize = s->port.rxBuffer.size;
             DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
             DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
-            DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)s->port.rxBuffer;
+            DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)s->port.rxBuffer.buffer;
             DMA_DeInit(s->rxDMAChannel);
             DMA_Init(s->rxDMAChannel, &DMA_InitStructure);
+            // half/full transfer and idle line hand the received bytes to the callbacks
+            DMA_ITConfig(s->rxDMAChannel, DMA_IT_HT | DMA_IT_TC, ENABLE);
             DMA_Cmd(s->rxDMAChannel, ENABLE);
             USART_DMACmd(s->USARTx, USART_DMAReq_Rx, ENABLE);
-            s->rxDMAPos = DMA_GetCurrDataCounter(s->rxDMAChannel);
+            USART_ClearITPendingBit(s->USARTx, USART_IT_IDLE);
+            USART_ITConfig(s->USARTx, USART_IT_IDLE, ENABLE);
         } else {
             USART_ClearITPendingBit(s->USARTx, USART_IT_RXNE);
             USART_ITConfig(s->USARTx, USART_IT_RXNE, ENABLE);
@@ -186,7 +196,7 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback,
             DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
             DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
 
-            DMA_InitStructure.DMA_BufferSize = s->port.txBufferSize;
+            DMA_InitStructure.DMA_BufferSize = s->port.txBuffer.size;
             DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
             DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
             DMA_DeInit(s->txDMAChannel);
@@ -219,72 +229,75 @@ void uartSetMode(serialPort_t *instance, portMode_t mode)
     uartReconfigure(uartPort);
 }
 
+// The transfer is consumed from the ring when it completes, see handleUsartTxDma()
 void uartStartTxDMA(uartPort_t *s)
 {
-    s->txDMAChannel->CMAR = (uint32_t)&s->port.txBuffer[s->port.txBufferTail];
-    if (s->port.txBufferHead > s->port.txBufferTail) {
-        s->txDMAChannel->CNDTR = s->port.txBufferHead - s->port.txBufferTail;
-        s->port.txBufferTail = s->port.txBufferHead;
-    } else {
-        s->txDMAChannel->CNDTR = s->port.txBufferSize - s->port.txBufferTail;
-        s->port.txBufferTail = 0;
-    }
+    const volatile uint8_t *data;
+
+    s->txDMACount = ringBufferReadSpan(&s->port.txBuffer, &data);
+    s->txDMAChannel->CMAR = (uint32_t)data;
+    s->txDMAChannel->CNDTR = s->txDMACount;
     s->txDMAEmpty = false;
     DMA_Cmd(s->txDMAChannel, ENABLE);
 }
 
-uint8_t uartTotalRxBytesWaiting(serialPort_t *instance)
+/*
+ * Hands the bytes written by the circular RX DMA since the last call to the
+ * receive callbacks.  Called from the DMA half/full transfer interrupts and the
+ * USART idle line interrupt, which share a priority, so a burst costs one or
+ * two interrupts instead of one interrupt and one micros() call per byte.
+ *
+ * The start of the first byte is derived from the character time: on idle the
+ * line has been quiet for one character after the last stop bit.
+ * Without callbacks the bytes stay in the buffer for uartRead().
+ */
+void uartDeliverRxDMA(uartPort_t *s, bool lineIdle)
 {
-    uartPort_t *s = (uartPort_t*)instance;
-    if (s->rxDMAChannel) {
-        uint32_t rxDMAHead = s->rxDMAChannel->CNDTR;
-        if (rxDMAHead >= s->rxDMAPos) {
-            return rxDMAHead - s->rxDMAPos;
-        } else {
-            return s->port.rxBufferSize + rxDMAHead - s->rxDMAPos;
-        }
+    if (!s->port.burstCallback && !s->port.callback) {
+        return;
     }
 
-    if (s->port.rxBufferHead >= s->port.rxBufferTail) {
-        return s->port.rxBufferHead - s->port.rxBufferTail;
+    ringBuffer_t *rxBuffer = &s->port.rxBuffer;
+    ringBufferSetHeadFromDma(rxBuffer, s->rxDMAChannel->CNDTR);
+
+    uint32_t count = ringBufferCount(rxBuffer);
+    if (count == 0) {
+        return;
+    }
+
+    uint32_t byteTime = micros() - (((count + (lineIdle ? 1 : 0)) * s->rxCharTime) >> 8);
+
+    if (s->port.burstCallback) {
+        const volatile uint8_t *data;
+        uint32_t spanCount;
+        // two spans when the burst wraps around the end of the buffer
+        while ((spanCount = ringBufferReadSpan(rxBuffer, &data)) > 0) {
+            s->port.burstCallback(data, spanCount, byteTime);
+            ringBufferConsume(rxBuffer, spanCount);
+            byteTime += (spanCount * s->rxCharTime) >> 8;
+        }
     } else {
-        return s->port.rxBufferSize + s->port.rxBufferHead - s->port.rxBufferTail;
+        while (!ringBufferIsEmpty(rxBuffer)) {
+            s->port.callback(ringBufferPop(rxBuffer));
+        }
     }
 }
 
-uint8_t uartTotalTxBytesFree(serialPort_t *instance)
+uint32_t uartTotalRxBytesWaiting(serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t*)instance;
 
-    uint32_t bytesUsed;
-
-    if (s->port.txBufferHead >= s->port.txBufferTail) {
-        bytesUsed = s->port.txBufferHead - s->port.txBufferTail;
-    } else {
-        bytesUsed = s->port.txBufferSize + s->port.txBufferHead - s->port.txBufferTail;
+    if (s->rxDMAChannel) {
+        ringBufferSetHeadFromDma(&s->port.rxBuffer, s->rxDMAChannel->CNDTR);
     }
 
-    if (s->txDMAChannel) {
-        /*
-         * When we queue up a DMA request, we advance the Tx buffer tail before the transfer finishes, so we must add
-         * the remaining size of that in-progress transfer here instead:
-         */
-        bytesUsed += s->txDMAChannel->CNDTR;
-
-        /*
-         * If the Tx buffer is being written to very quickly, we might have advanced the head into the buffer
-         * space occupied by the current DMA transfer. In that case the "bytesUsed" total will actually end up larger
-         * than the total Tx buffer size, because we'll end up transmitting the same buffer region twice. (So we'll be
-         * transmitting a garbage mixture of old and new bytes).
-         *
-         * Be kind to callers and pretend like our buffer can only ever be 100% full.
-         */
-        if (bytesUsed >= s->port.txBufferSize - 1) {
-            return 0;
-        }
-    }
+    return ringBufferCount(&s->port.rxBuffer);
+}
 
-    return (s->port.txBufferSize - 1) - bytesUsed;
+// Bytes queued for an in-flight DMA transfer stay in the ring until it completes
+uint32_t uartTotalTxBytesFree(serialPort_t *instance)
+{
+    return ringBufferFree(&instance->txBuffer);
 }
 
 bool isUartTransmitBufferEmpty(serialPort_t *instance)
@@ -293,45 +306,112 @@ bool isUartTransmitBufferEmpty(serialPort_t *instance)
     if (s->txDMAChannel)
         return s->txDMAEmpty;
     else
-        return s->port.txBufferTail == s->port.txBufferHead;
+        return ringBufferIsEmpty(&s->port.txBuffer);
 }
 
 uint8_t uartRead(serialPort_t *instance)
 {
-    uint8_t ch;
-    uartPort_t *s = (uartPort_t *)instance;
+    if (uartTotalRxBytesWaiting(instance) == 0) {
+        return 0;
+    }
 
-    if (s->rxDMAChannel) {
-        ch = s->port.rxBuffer[s->port.rxBufferSize - s->rxDMAPos];
-        if (--s->rxDMAPos == 0)
-            s->rxDMAPos = s->port.rxBufferSize;
+    return ringBufferPop(&instance->rxBuffer);
+}
+
+static void uartStartTx(uartPort_t *s)
+{
+    if (s->txDMAChannel) {
+        if (!(s->txDMAChannel->CCR & 1))
+            uartStartTxDMA(s);
     } else {
-        ch = s->port.rxBuffer[s->port.rxBufferTail];
-        if (s->port.rxBufferTail + 1 >= s->port.rxBufferSize) {
-            s->port.rxBufferTail = 0;
-        } else {
-            s->port.rxBufferTail++;
+        USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+    }
+}
+
+// A byte written to a full buffer is dropped
+void uartWrite(serialPort_t *instance, uint8_t ch)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    if (ringBufferFree(&s->port.txBuffer)) {
+        ringBufferPush(&s->port.txBuffer, ch);
+    }
+
+    // callers of serialWrite() do not wait for room, so a batch must not fill the buffer
+    if (!s->txBatching || ringBufferFree(&s->port.txBuffer) < s->port.txBuffer.size / 2) {
+        uartStartTx(s);
+    }
+}
+
+/*
+ * Copies into the TX ring with at most two memcpy() per chunk of free space and
+ * starts the transmitter once, blocks while the ring is full like serialWriteBuf().
+ */
+void uartWriteBuf(serialPort_t *instance, void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        uint32_t written = ringBufferWrite(&s->port.txBuffer, p, count);
+        if (written == 0) {
+            uartStartTx(s);
+            continue;
         }
+
+        p += written;
+        count -= written;
     }
 
-    return ch;
+    if (!s->txBatching) {
+        uartStartTx(s);
+    }
 }
 
-void uartWrite(serialPort_t *instance, uint8_t ch)
+void uartBeginWrite(serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t *)instance;
-    s->port.txBuffer[s->port.txBufferHead] = ch;
-    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
-        s->port.txBufferHead = 0;
-    } else {
-        s->port.txBufferHead++;
+    s->txBatching = true;
+}
+
+void uartEndWrite(serialPort_t *instance)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->txBatching = false;
+    if (!ringBufferIsEmpty(&s->port.txBuffer)) {
+        uartStartTx(s);
     }
+}
 
-    if (s->txDMAChannel) {
-        if (!(s->txDMAChannel->CCR & 1))
-            uartStartTxDMA(s);
-    } else {
-        USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+uint32_t uartPeekRx(serialPort_t *instance, const volatile uint8_t **data)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    if (s->rxDMAChannel) {
+        ringBufferSetHeadFromDma(&s->port.rxBuffer, s->rxDMAChannel->CNDTR);
+    }
+
+    return ringBufferReadSpan(&s->port.rxBuffer, data);
+}
+
+void uartConsumeRx(serialPort_t *instance, uint32_t count)
+{
+    ringBufferConsume(&instance->rxBuffer, count);
+}
+
+uint32_t uartReserveTx(serialPort_t *instance, volatile uint8_t **data)
+{
+    return ringBufferWriteSpan(&instance->txBuffer, data);
+}
+
+void uartCommitTx(serialPort_t *instance, uint32_t count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    ringBufferCommit(&s->port.txBuffer, count);
+
+    if (!s->txBatching) {
+        uartStartTx(s);
     }
 }
 
@@ -344,8 +424,12 @@ const struct serialPortVTable uartVTable[] = {
         uartSetBaudRate,
         isUartTransmitBufferEmpty,
         uartSetMode,
-        .writeBuf = NULL,
-        .beginWrite = NULL,
-        .endWrite = NULL,
+        .writeBuf = uartWriteBuf,
+        .beginWrite = uartBeginWrite,
+        .endWrite = uartEndWrite,
+        .peekRx = uartPeekRx,
+        .consumeRx = uartConsumeRx,
+        .reserveTx = uartReserveTx,
+        .commitTx = uartCommitTx,
     }
 };
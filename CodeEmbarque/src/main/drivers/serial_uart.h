@@ -21,18 +21,37 @@
 // The two largest things that need to be sent are: 1, MSP responses, 2, UBLOX SVINFO packet.
 
 // Size must be a power of two due to various optimizations which use 'and' instead of 'mod'
-// Various serial routines return the buffer occupied size as uint8_t which would need to be extended in order to
-// increase size further.
+// Targets may define larger buffers, e.g. for blackbox logging or flash download over serial.
+#ifndef UART1_RX_BUFFER_SIZE
 #define UART1_RX_BUFFER_SIZE    256
+#endif
+#ifndef UART1_TX_BUFFER_SIZE
 #define UART1_TX_BUFFER_SIZE    256
+#endif
+#ifndef UART2_RX_BUFFER_SIZE
 #define UART2_RX_BUFFER_SIZE    256
+#endif
+#ifndef UART2_TX_BUFFER_SIZE
 #define UART2_TX_BUFFER_SIZE    256
+#endif
+#ifndef UART3_RX_BUFFER_SIZE
 #define UART3_RX_BUFFER_SIZE    256
+#endif
+#ifndef UART3_TX_BUFFER_SIZE
 #define UART3_TX_BUFFER_SIZE    256
+#endif
+#ifndef UART4_RX_BUFFER_SIZE
 #define UART4_RX_BUFFER_SIZE    256
+#endif
+#ifndef UART4_TX_BUFFER_SIZE
 #define UART4_TX_BUFFER_SIZE    256
+#endif
+#ifndef UART5_RX_BUFFER_SIZE
 #define UART5_RX_BUFFER_SIZE    256
+#endif
+#ifndef UART5_TX_BUFFER_SIZE
 #define UART5_TX_BUFFER_SIZE    256
+#endif
 
 typedef struct {
     serialPort_t port;
@@ -43,8 +62,13 @@ typedef struct {
     uint32_t rxDMAIrq;
     uint32_t txDMAIrq;
 
-    uint32_t rxDMAPos;
+    uint32_t txDMACount;
     bool txDMAEmpty;
+    // between beginWrite and endWrite, transmission is only started when needed to make room
+    bool txBatching;
+
+    // duration of one character on the wire, in 1/256 us
+    uint32_t rxCharTime;
 
     uint32_t txDMAPeripheralBaseAddr;
     uint32_t rxDMAPeripheralBaseAddr;
@@ -58,8 +82,15 @@ void usartInitAllIOSignals(void);
 
 // serialPort API
 void uartWrite(serialPort_t *instance, uint8_t ch);
-uint8_t uartTotalRxBytesWaiting(serialPort_t *instance);
-uint8_t uartTotalTxBytesFree(serialPort_t *instance);
+void uartWriteBuf(serialPort_t *instance, void *data, int count);
+void uartBeginWrite(serialPort_t *instance);
+void uartEndWrite(serialPort_t *instance);
+uint32_t uartPeekRx(serialPort_t *instance, const volatile uint8_t **data);
+void uartConsumeRx(serialPort_t *instance, uint32_t count);
+uint32_t uartReserveTx(serialPort_t *instance, volatile uint8_t **data);
+void uartCommitTx(serialPort_t *instance, uint32_t count);
+uint32_t uartTotalRxBytesWaiting(serialPort_t *instance);
+uint32_t uartTotalTxBytesFree(serialPort_t *instance);
 uint8_t uartRead(serialPort_t *instance);
 void uartSetBaudRate(serialPort_t *s, uint32_t baudRate);
 bool isUartTransmitBufferEmpty(serialPort_t *s);
@@ -29,9 +29,12 @@
 
 #include <platform.h>
 
+#include "build_config.h"
+
 #include "system.h"
 #include "gpio.h"
 #include "nvic.h"
+#include "dma.h"
 
 #include "serial.h"
 #include "serial_uart.h"
@@ -39,11 +42,8 @@
 #include "serial_uart_stm32f30x.h"
 
 
-// Using RX DMA disables the use of receive callbacks
-//#define USE_UART1_RX_DMA
-//#define USE_UART2_RX_DMA
+// RX DMA is enabled per target, USE_UART1_RX_DMA (DMA1 Ch5), USE_UART2_RX_DMA (DMA1 Ch6), USE_UART3_RX_DMA (DMA1 Ch3)
 //#define USE_UART2_TX_DMA
-//#define USE_UART3_RX_DMA
 //#define USE_UART3_TX_DMA
 
 #ifdef USE_UART1
@@ -62,6 +62,33 @@ static uartPort_t uartPort4;
 static uartPort_t uartPort5;
 #endif
 
+#ifdef USE_UART1_RX_DMA
+static void uart1RxDmaIrqHandler(DMA_Channel_TypeDef *channel)
+{
+    UNUSED(channel);
+    DMA_ClearITPendingBit(DMA1_IT_GL5);
+    uartDeliverRxDMA(&uartPort1, false);
+}
+#endif
+
+#ifdef USE_UART2_RX_DMA
+static void uart2RxDmaIrqHandler(DMA_Channel_TypeDef *channel)
+{
+    UNUSED(channel);
+    DMA_ClearITPendingBit(DMA1_IT_GL6);
+    uartDeliverRxDMA(&uartPort2, false);
+}
+#endif
+
+#ifdef USE_UART3_RX_DMA
+static void uart3RxDmaIrqHandler(DMA_Channel_TypeDef *channel)
+{
+    UNUSED(channel);
+    DMA_ClearITPendingBit(DMA1_IT_GL3);
+    uartDeliverRxDMA(&uartPort3, false);
+}
+#endif
+
 #ifdef USE_UART1
 uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t options)
 {
@@ -76,10 +103,8 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     
     s->port.baudRate = baudRate;
     
-    s->port.rxBuffer = rx1Buffer;
-    s->port.txBuffer = tx1Buffer;
-    s->port.rxBufferSize = UART1_RX_BUFFER_SIZE;
-    s->port.txBufferSize = UART1_TX_BUFFER_SIZE;
+    ringBufferInit(&s->port.rxBuffer, rx1Buffer, UART1_RX_BUFFER_SIZE);
+    ringBufferInit(&s->port.txBuffer, tx1Buffer, UART1_TX_BUFFER_SIZE);
     
 #ifdef USE_UART1_RX_DMA
     s->rxDMAChannel = DMA1_Channel5;
@@ -127,14 +152,24 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 
-#ifndef USE_UART1_RX_DMA
-    NVIC_InitStructure.NVIC_IRQChannel = USART1_IRQn;
+#ifdef USE_UART1_RX_DMA
+    // DMA RX half/full transfer Interrupt, same priority as the idle line interrupt
+    dmaSetHandler(DMA1_CH5_HANDLER, uart1RxDmaIrqHandler);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
     NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SERIALUART1_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART1_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 #endif
 
+    // RX byte or idle line Interrupt
+    NVIC_InitStructure.NVIC_IRQChannel = USART1_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SERIALUART1_RXDMA);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART1_RXDMA);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
     return s;
 }
 #endif
@@ -153,10 +188,8 @@ uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t option
     
     s->port.baudRate = baudRate;
     
-    s->port.rxBufferSize = UART2_RX_BUFFER_SIZE;
-    s->port.txBufferSize = UART2_TX_BUFFER_SIZE;
-    s->port.rxBuffer = rx2Buffer;
-    s->port.txBuffer = tx2Buffer;
+    ringBufferInit(&s->port.rxBuffer, rx2Buffer, UART2_RX_BUFFER_SIZE);
+    ringBufferInit(&s->port.txBuffer, tx2Buffer, UART2_TX_BUFFER_SIZE);
 
     s->USARTx = USART2;
     
@@ -210,14 +243,24 @@ uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_Init(&NVIC_InitStructure);
 #endif
 
-#ifndef USE_UART2_RX_DMA
-    NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
+#ifdef USE_UART2_RX_DMA
+    // DMA RX half/full transfer Interrupt, same priority as the idle line interrupt
+    dmaSetHandler(DMA1_CH6_HANDLER, uart2RxDmaIrqHandler);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel6_IRQn;
     NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SERIALUART2_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART2_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 #endif
 
+    // RX byte or idle line Interrupt
+    NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SERIALUART2_RXDMA);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART2_RXDMA);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
     return s;
 }
 #endif
@@ -236,10 +279,8 @@ uartPort_t *serialUART3(uint32_t baudRate, portMode_t mode, portOptions_t option
 
     s->port.baudRate = baudRate;
 
-    s->port.rxBufferSize = UART3_RX_BUFFER_SIZE;
-    s->port.txBufferSize = UART3_TX_BUFFER_SIZE;
-    s->port.rxBuffer = rx3Buffer;
-    s->port.txBuffer = tx3Buffer;
+    ringBufferInit(&s->port.rxBuffer, rx3Buffer, UART3_RX_BUFFER_SIZE);
+    ringBufferInit(&s->port.txBuffer, tx3Buffer, UART3_TX_BUFFER_SIZE);
 
     s->USARTx = USART3;
 
@@ -293,14 +334,24 @@ uartPort_t *serialUART3(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_Init(&NVIC_InitStructure);
 #endif
 
-#ifndef USE_UART3_RX_DMA
-    NVIC_InitStructure.NVIC_IRQChannel = USART3_IRQn;
+#ifdef USE_UART3_RX_DMA
+    // DMA RX half/full transfer Interrupt, same priority as the idle line interrupt
+    dmaSetHandler(DMA1_CH3_HANDLER, uart3RxDmaIrqHandler);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel3_IRQn;
     NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SERIALUART3_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART3_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 #endif
 
+    // RX byte or idle line Interrupt
+    NVIC_InitStructure.NVIC_IRQChannel = USART3_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_SERIALUART3_RXDMA);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART3_RXDMA);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
     return s;
 }
 #endif
@@ -309,7 +360,10 @@ static void handleUsartTxDma(uartPort_t *s)
 {
     DMA_Cmd(s->txDMAChannel, DISABLE);
 
-    if (s->port.txBufferHead != s->port.txBufferTail)
+    ringBufferConsume(&s->port.txBuffer, s->txDMACount);
+    s->txDMACount = 0;
+
+    if (!ringBufferIsEmpty(&s->port.txBuffer))
         uartStartTxDMA(s);
     else
         s->txDMAEmpty = true;
@@ -352,27 +406,32 @@ void usartIrqHandler(uartPort_t *s)
     uint32_t ISR = s->USARTx->ISR;
 
     if (!s->rxDMAChannel && (ISR & USART_FLAG_RXNE)) {
-        if (s->port.callback) {
+        if (s->port.burstCallback) {
+            uint8_t ch = s->USARTx->RDR;
+            s->port.burstCallback(&ch, 1, micros());
+        } else if (s->port.callback) {
             s->port.callback(s->USARTx->RDR);
         } else {
-            s->port.rxBuffer[s->port.rxBufferHead++] = s->USARTx->RDR;
-            if (s->port.rxBufferHead >= s->port.rxBufferSize) {
-                s->port.rxBufferHead = 0;
+            uint8_t ch = s->USARTx->RDR;
+            if (ringBufferFree(&s->port.rxBuffer)) {
+                ringBufferPush(&s->port.rxBuffer, ch);
             }
         }
     }
 
     if (!s->txDMAChannel && (ISR & USART_FLAG_TXE)) {
-        if (s->port.txBufferTail != s->port.txBufferHead) {
-            USART_SendData(s->USARTx, s->port.txBuffer[s->port.txBufferTail++]);
-            if (s->port.txBufferTail >= s->port.txBufferSize) {
-                s->port.txBufferTail = 0;
-            }
+        if (!ringBufferIsEmpty(&s->port.txBuffer)) {
+            USART_SendData(s->USARTx, ringBufferPop(&s->port.txBuffer));
         } else {
             USART_ITConfig(s->USARTx, USART_IT_TXE, DISABLE);
         }
     }
 
+    if (s->rxDMAChannel && (ISR & USART_FLAG_IDLE)) {
+        USART_ClearITPendingBit(s->USARTx, USART_IT_IDLE);
+        uartDeliverRxDMA(s, true);
+    }
+
     if (ISR & USART_FLAG_ORE)
     {
         USART_ClearITPendingBit (s->USARTx, USART_IT_ORE);
@@ -422,10 +481,8 @@ uartPort_t *serialUART4(uint32_t baudRate, portMode_t mode, portOptions_t option
 
     s->port.baudRate = baudRate;
 
-    s->port.rxBufferSize = UART4_RX_BUFFER_SIZE;
-    s->port.txBufferSize = UART4_TX_BUFFER_SIZE;
-    s->port.rxBuffer = rx4Buffer;
-    s->port.txBuffer = tx4Buffer;
+    ringBufferInit(&s->port.rxBuffer, rx4Buffer, UART4_RX_BUFFER_SIZE);
+    ringBufferInit(&s->port.txBuffer, tx4Buffer, UART4_TX_BUFFER_SIZE);
 
     s->USARTx = UART4;
 
@@ -495,10 +552,8 @@ uartPort_t *serialUART5(uint32_t baudRate, portMode_t mode, portOptions_t option
 
     s->port.baudRate = baudRate;
 
-    s->port.rxBufferSize = UART5_RX_BUFFER_SIZE;
-    s->port.txBufferSize = UART5_TX_BUFFER_SIZE;
-    s->port.rxBuffer = rx5Buffer;
-    s->port.txBuffer = tx5Buffer;
+    ringBufferInit(&s->port.rxBuffer, rx5Buffer, UART5_RX_BUFFER_SIZE);
+    ringBufferInit(&s->port.txBuffer, tx5Buffer, UART5_TX_BUFFER_SIZE);
 
     s->USARTx = UART5;
 
@@ -91,6 +91,10 @@ static uint32_t usTicks = 0;
 static volatile uint32_t sysTickUptime = 0;
 // cached value of RCC->CSR
 uint32_t cachedRccCsrValue;
+#ifdef USE_HARDWARE_TIMEBASE
+// set once TIMEBASE_TIMER is free-running at 1MHz, micros() then reads its counter directly
+static bool timebaseRunning = false;
+#endif
 
 static void cycleCounterInit(void)
 {
@@ -105,9 +109,37 @@ void SysTick_Handler(void)
     sysTickUptime++;
 }
 
+#ifdef USE_HARDWARE_TIMEBASE
+// Start a free-running 32bit 1MHz counter, continuing from the current SysTick based time
+void timebaseInit(void)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+
+    RCC_APB1PeriphClockCmd(TIMEBASE_TIMER_APB1_PERIPHERAL, ENABLE);
+
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Period = 0xFFFFFFFF;
+    TIM_TimeBaseStructure.TIM_Prescaler = (SystemCoreClock / 1000000) - 1;
+    TIM_TimeBaseStructure.TIM_ClockDivision = 0;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIMEBASE_TIMER, &TIM_TimeBaseStructure);
+
+    TIM_SetCounter(TIMEBASE_TIMER, micros());
+    TIM_Cmd(TIMEBASE_TIMER, ENABLE);
+    timebaseRunning = true;
+}
+#endif
+
 // Return system uptime in microseconds (rollover in 70minutes)
 uint32_t micros(void)
 {
+#ifdef USE_HARDWARE_TIMEBASE
+    // a single 32bit register read, safe from any context without retrying
+    if (timebaseRunning) {
+        return TIMEBASE_TIMER->CNT;
+    }
+#endif
+
     register uint32_t ms, cycle_cnt;
     do {
         ms = sysTickUptime;
@@ -119,7 +151,7 @@ uint32_t micros(void)
          */
         asm volatile("\tnop\n");
     } while (ms != sysTickUptime);
-    return (ms * 1000) + (usTicks * 1000 - cycle_cnt) / usTicks;
+    return sysTickMicros(ms, cycle_cnt, usTicks);
 }
 
 // Return system uptime in milliseconds (rollover in 49 days)
@@ -24,6 +24,17 @@ void delay(uint32_t ms);
 uint32_t micros(void);
 uint32_t millis(void);
 
+// SysTick based time, ms counted by the SysTick interrupt and sysTickVal the SysTick down-counter reloaded at ticksPerUs * 1000 - 1
+static inline uint32_t sysTickMicros(uint32_t ms, uint32_t sysTickVal, uint32_t ticksPerUs)
+{
+    // wraps at 2^32us, as the hardware timebase that continues from it
+    return (ms * 1000) + (ticksPerUs * 1000 - sysTickVal) / ticksPerUs;
+}
+
+#ifdef USE_HARDWARE_TIMEBASE
+void timebaseInit(void);
+#endif
+
 // failure
 void failureMode(uint8_t mode);
 
@@ -47,6 +47,7 @@
 
 #include "sensors/sensors.h"
 #include "sensors/acceleration.h"
+#include "sensors/battery.h"
 
 #include "flight/mixer.h"
 #include "flight/servos.h"
@@ -67,6 +68,13 @@ int16_t       motorsThrottle[MAX_SUPPORTED_MOTORS];
 int16_t       motorDisarmed[MAX_SUPPORTED_MOTORS];
 bool          motorLimitReached;
 
+#define THRUST_LUT_SIZE              33
+#define VBAT_SAG_COMPENSATION_MAX    1.5f    // never push the commands more than this on a low battery
+#define VBAT_SAG_FULL_CELL_VOLTAGE   42      // 0.1V, nominal charged LiPo cell, the reference of the compensation
+
+// commande moteur (0-1) pour chaque fraction de poussee (0-1), interpolee
+static float thrustLinearizationLut[THRUST_LUT_SIZE];
+
 // FONCTIONS STATIC ----------------------------------------------------
 static uint16_t mixConstrainMotorForFailsafeCondition(uint8_t motorIndex){
     return constrain(motorsThrottle[motorIndex], motorAndServoConfig()->mincommand, motorAndServoConfig()->maxthrottle);
@@ -88,6 +96,89 @@ static uint8_t getPhaseDeVol(){
     }
 }
 
+/*
+ * Thrust is modelled as (1 - k) * c + k * c^2 for a command c in 0-1, the table holds
+ * the inverse so the mixer output becomes a thrust fraction instead of a raw command.
+ */
+static void initThrustLinearization(void){
+    float k = motorAndServoConfig()->thrust_linear / 100.0f;
+
+    for (int i = 0; i < THRUST_LUT_SIZE; i++) {
+        float thrust = (float)i / (THRUST_LUT_SIZE - 1);
+
+        if (k > 0.0f) {
+            thrustLinearizationLut[i] = (sqrtf((1 - k) * (1 - k) + 4 * k * thrust) - (1 - k)) / (2 * k);
+        } else {
+            thrustLinearizationLut[i] = thrust;
+        }
+    }
+}
+
+static float thrustToMotorCommand(float thrust){
+    float position = constrainf(thrust, 0.0f, 1.0f) * (THRUST_LUT_SIZE - 1);
+    int index = MIN((int)position, THRUST_LUT_SIZE - 2);
+    float fraction = position - index;
+
+    return thrustLinearizationLut[index] + (thrustLinearizationLut[index + 1] - thrustLinearizationLut[index]) * fraction;
+}
+
+// gain sur les commandes pour retrouver la poussee d'une batterie pleine, d'apres vbat filtre
+static float getVbatSagCompensation(void){
+    if (!motorAndServoConfig()->vbat_sag_compensation || !feature(FEATURE_VBAT) || !batteryCellCount || !vbat) {
+        return 1.0f;
+    }
+
+    float vbatFull = batteryCellCount * VBAT_SAG_FULL_CELL_VOLTAGE;
+    float sag = constrainf(vbatFull / vbat, 1.0f, VBAT_SAG_COMPENSATION_MAX);
+
+    return 1.0f + (sag - 1.0f) * motorAndServoConfig()->vbat_sag_compensation / 100.0f;
+}
+
+/*
+ * Plus haute sortie du mixeur que l'etage de sortie rend sans saturer : la poussee d'une commande
+ * 1 / compensation.  Le mixeur reserve la marge roll/pitch/yaw sous cette limite, le differentiel
+ * entre moteurs survit donc a l'etage de sortie.  La table interpole par cordes une fonction
+ * concave, elle ne depasse jamais la commande exacte et ne sature pas sous cette limite.
+ */
+static int16_t getMotorOutputMax(float compensation){
+    int16_t throttleMin = motorAndServoConfig()->minthrottle;
+    int16_t throttleMax = motorAndServoConfig()->maxthrottle;
+
+    if (!motorAndServoConfig()->thrust_linear && !motorAndServoConfig()->vbat_sag_compensation) {
+        return throttleMax;
+    }
+
+    float k       = motorAndServoConfig()->thrust_linear / 100.0f;
+    float command = 1.0f / compensation;
+    float thrust  = (1 - k) * command + k * command * command;
+
+    return throttleMin + (int16_t)(thrust * (throttleMax - throttleMin));
+}
+
+// etage de sortie apres le mixage : linearisation de la poussee et compensation de la chute de tension
+static void applyMotorOutputStage(float compensation){
+    if (!motorAndServoConfig()->thrust_linear && !motorAndServoConfig()->vbat_sag_compensation) {
+        return;
+    }
+
+    int16_t throttleMin  = motorAndServoConfig()->minthrottle;
+    float throttleRange  = motorAndServoConfig()->maxthrottle - throttleMin;
+    if (throttleRange <= 0) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        float thrust  = (motorsThrottle[i] - throttleMin) / throttleRange;
+        float command = thrustToMotorCommand(thrust) * compensation;
+
+        // ne devrait pas arriver sous getMotorOutputMax(), le differentiel serait ecrase
+        if (command > 1.0f + 0.5f / throttleRange) {
+            motorLimitReached = true;
+        }
+        motorsThrottle[i] = throttleMin + lrintf(constrainf(command, 0.0f, 1.0f) * throttleRange);
+    }
+}
+
 //FONCTIONS ------------------------------------------------------------
 void initMixer(){
     //motors config
@@ -107,6 +198,8 @@ void initMixer(){
     mixerConfigVTOL.yaw_jump_prevention_limit = 200;
     mixerConfigVTOL.tri_unarmed_servo         = 1;
     mixerConfigVTOL.servo_lowpass_freq        = 400.0f;
+
+    initThrustLinearization();
 }
 
 /* fonction pour initialiser la valeur des moteur en etat "desarme" */
@@ -120,6 +213,12 @@ void mixerResetDisarmedMotors(void){
 void writeMotors(void){
     for (uint8_t i = 0; i < MAX_SUPPORTED_MOTORS; i++)
         pwmWriteMotor(i, motorsThrottle[i]);
+    pwmCompleteOutputUpdate();
+#ifdef USE_DSHOT
+    if (isMotorProtocolDshot())
+        pwmCompleteDshotMotorUpdate(MAX_SUPPORTED_MOTORS);
+    else
+#endif
     if (feature(FEATURE_ONESHOT125))
         pwmCompleteOneshotMotorUpdate(MAX_SUPPORTED_MOTORS);
 }
@@ -146,6 +245,8 @@ void StopPwmAllMotors(){
 void mixTable(void){
     // type de phase de vol
     uint8_t phaseDeVol       = getPhaseDeVol();
+    // gain de l'etage de sortie pour la chute de tension
+    float outputCompensation = getVbatSagCompensation();
 
     /*Disarmed motors*/
     if (!ARMING_FLAG(ARMED)) {
@@ -158,6 +259,9 @@ void mixTable(void){
         // indicateur "failsafe"
         bool isFailsafeActive = failsafeIsActive();
 
+        // sortie max que l'etage de sortie (linearisation, chute de tension) rend sans saturer
+        int16_t outputMax        = getMotorOutputMax(outputCompensation);
+
         if (phaseDeVol == VOL_QUAD){
             if( (mixerConfigVTOL.yaw_jump_prevention_limit < YAW_JUMP_PREVENTION_LIMIT_HIGH)) {
                 // prevent "yaw jump" during yaw correction
@@ -194,7 +298,7 @@ void mixTable(void){
 
             // Find min and max throttle based on condition. Use rcData for 3D to prevent loss of power due to min_check
             int16_t throttleMin   = motorAndServoConfig()->minthrottle;
-            int16_t throttleMax   = motorAndServoConfig()->maxthrottle;
+            int16_t throttleMax   = outputMax;
             int16_t throttleRange = throttleMax - throttleMin;
 
             //test si poussee demandee hors limite
@@ -231,7 +335,7 @@ void mixTable(void){
                     motorsThrottle[i] = rcCommand[THROTTLE] * motorMixerVTOL[i].throttle;
                     motorsThrottle[i] = constrain(motorsThrottle[i], throttleMin, throttleMax);
                     motorsThrottle[i] = motorsThrottle[i] + rollPitchYawMix[i];
-                    motorsThrottle[i] = constrain(motorsThrottle[i], motorAndServoConfig()->minthrottle, motorAndServoConfig()->maxthrottle);
+                    motorsThrottle[i] = constrain(motorsThrottle[i], motorAndServoConfig()->minthrottle, outputMax);
                 }
             }
         }
@@ -246,12 +350,18 @@ void mixTable(void){
                 }
                 else {
                     motorsThrottle[i] = rcCommand[THROTTLE] * motorMixerVTOL[i].throttle;
-                    motorsThrottle[i] = constrain(motorsThrottle[i], motorAndServoConfig()->minthrottle, motorAndServoConfig()->maxthrottle);
+                    motorsThrottle[i] = constrain(motorsThrottle[i], motorAndServoConfig()->minthrottle, outputMax);
                 }
             }
         }
     }
     // motorsThrottle outputs are used as sources for servo mixing, so motorsThrottle must be calculated before servos.
     servoMixer(phaseDeVol);
+
+    // etage de sortie en dernier, les servos voient la sortie du mixeur en poussee
+    // les commandes failsafe sont envoyees telles quelles
+    if (ARMING_FLAG(ARMED) && !failsafeIsActive()) {
+        applyMotorOutputStage(outputCompensation);
+    }
 }
 
@@ -0,0 +1,187 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <platform.h>
+
+#include "build_config.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+
+#include "config/parameter_group.h"
+#include "config/parameter_group_ids.h"
+#include "config/runtime_config.h"
+
+#include "drivers/system.h"
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
+#include "drivers/compass.h"
+
+#include "rx/rx.h"
+
+#include "io/rc_controls.h"
+#include "io/motor_and_servo.h"
+
+#include "sensors/sensors.h"
+#include "sensors/compass.h"
+#include "sensors/acceleration.h"
+
+#include "flight/pid.h"
+#include "flight/imu.h"
+#include "flight/failsafe.h"
+#include "flight/offboard.h"
+
+/*
+ * Offboard setpoints go straight to the rate PID, in place of the rates the
+ * controllers derive from rcCommand[].  They are used while the OFFBOARD mode
+ * is on, the craft is armed and the last setpoint is fresh, the sticks fly the
+ * craft otherwise.  The failsafe takes precedence, its landing throttle and
+ * level attitude are not overridden by a companion computer that may have
+ * lost the craft as well.  MW23 has no rate setpoint and does not support them.
+ *
+ * MAVLink setpoints are read in the PID loop, on a port of their own they are
+ * used on the next loop.  MSP setpoints wait for the 100Hz serial task and are
+ * only good for slow setpoints.
+ */
+
+PG_REGISTER_WITH_RESET_TEMPLATE(offboardConfig_t, offboardConfig, PG_OFFBOARD_CONFIG, 0);
+
+PG_RESET_TEMPLATE(offboardConfig_t, offboardConfig,
+    .timeout_ms = 50,
+);
+
+// the rate controllers work in gyro LSB / 4 at 16.4 LSB per deg/s
+#define OFFBOARD_ANGLE_RATE_SCALE (16.4f / 4)
+
+static offboardSetpoint_t offboardSetpoint;
+static uint32_t offboardReceivedAt;
+static bool haveOffboardSetpoint = false;
+
+static bool offboardActive = false;
+static float offboardAngleRate[3];
+
+bool offboardSetpointReceive(const offboardSetpoint_t *setpoint)
+{
+    uint32_t now = micros();
+    bool fresh = haveOffboardSetpoint && (now - offboardReceivedAt) < offboardConfig()->timeout_ms * 1000;
+
+    // a sender restarting after a timeout starts a new sequence
+    if (fresh && (int16_t)(setpoint->sequence - offboardSetpoint.sequence) <= 0) {
+        return false;
+    }
+
+    offboardSetpoint = *setpoint;
+    offboardReceivedAt = now;
+    haveOffboardSetpoint = true;
+
+    return true;
+}
+
+// Same euler angles as imuUpdateEulerAngles(), in decidegrees
+static void offboardAttitudeToEuler(const float *q, float *euler)
+{
+    float r00 = 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3]);
+    float r10 = 2.0f * (q[1] * q[2] + q[0] * q[3]);
+    float r20 = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    float r21 = 2.0f * (q[2] * q[3] + q[0] * q[1]);
+    float r22 = 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]);
+
+    euler[FD_ROLL] = atan2_approx(r21, r22) * (1800.0f / M_PIf);
+    euler[FD_PITCH] = ((0.5f * M_PIf) - acos_approx(-r20)) * (1800.0f / M_PIf);
+    euler[FD_YAW] = -atan2_approx(r10, r00) * (1800.0f / M_PIf) + magneticDeclination;
+}
+
+static void offboardUpdateAngleRates(void)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        offboardAngleRate[axis] = 0;
+        if (offboardSetpoint.flags & (OFFBOARD_SETPOINT_ROLL_RATE << axis)) {
+            offboardAngleRate[axis] = offboardSetpoint.rates[axis] * OFFBOARD_ANGLE_RATE_SCALE;
+        }
+    }
+
+    if (offboardSetpoint.flags & OFFBOARD_SETPOINT_ATTITUDE) {
+        float target[3];
+        offboardAttitudeToEuler(offboardSetpoint.q, target);
+
+        // no steeper than ANGLE mode
+        const float maxInclination = imuConfig()->max_angle_inclination;
+        target[FD_ROLL] = constrainf(target[FD_ROLL], -maxInclination, maxInclination);
+        target[FD_PITCH] = constrainf(target[FD_PITCH], -maxInclination, maxInclination);
+
+        for (int axis = 0; axis < 3; axis++) {
+            float errorAngle = target[axis] - attitude.raw[axis];
+            if (axis == FD_YAW) {
+                // shortest way round, the heading grows to the right and the yaw rate to the left
+                while (errorAngle > 1800) errorAngle -= 3600;
+                while (errorAngle < -1800) errorAngle += 3600;
+                errorAngle = -errorAngle;
+            }
+            // as ANGLE mode in the float controller
+            offboardAngleRate[axis] += errorAngle * pidProfile()->P8[PIDLEVEL] / 16.0f;
+        }
+    }
+}
+
+void offboardUpdate(uint32_t currentTime)
+{
+    offboardActive = haveOffboardSetpoint
+        && rcModeIsActive(BOXOFFBOARD)
+        && ARMING_FLAG(ARMED)
+        && !failsafeIsActive()
+        && pidProfile()->pidController != PID_CONTROLLER_MW23
+        && (currentTime - offboardReceivedAt) < offboardConfig()->timeout_ms * 1000;
+
+    if (offboardActive) {
+        offboardUpdateAngleRates();
+    }
+}
+
+bool offboardIsActive(void)
+{
+    return offboardActive;
+}
+
+void offboardApplyThrottle(void)
+{
+    if (!offboardActive || !(offboardSetpoint.flags & OFFBOARD_SETPOINT_THRUST)) {
+        return;
+    }
+
+    float thrust = constrainf(offboardSetpoint.thrust, 0.0f, 1.0f);
+    rcCommand[THROTTLE] = motorAndServoConfig()->minthrottle + lrintf(thrust * (motorAndServoConfig()->maxthrottle - motorAndServoConfig()->minthrottle));
+}
+
+bool offboardGetAngleRate(int axis, float *angleRate)
+{
+    if (!offboardActive) {
+        return false;
+    }
+
+    const uint8_t axisFlags = (OFFBOARD_SETPOINT_ROLL_RATE << axis) | OFFBOARD_SETPOINT_ATTITUDE;
+    if (!(offboardSetpoint.flags & axisFlags)) {
+        return false;
+    }
+
+    *angleRate = offboardAngleRate[axis];
+    return true;
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#define OFFBOARD_TIMEOUT_MS_MAX     1000
+
+typedef struct offboardConfig_s {
+    uint16_t timeout_ms;                    // setpoints older than this are ignored and the sticks take over
+} offboardConfig_t;
+
+PG_DECLARE(offboardConfig_t, offboardConfig);
+
+typedef enum {
+    OFFBOARD_SETPOINT_ROLL_RATE  = (1 << 0),
+    OFFBOARD_SETPOINT_PITCH_RATE = (1 << 1),
+    OFFBOARD_SETPOINT_YAW_RATE   = (1 << 2),
+    OFFBOARD_SETPOINT_ATTITUDE   = (1 << 3),
+    OFFBOARD_SETPOINT_THRUST     = (1 << 4)
+} offboardSetpointFlags_e;
+
+#define OFFBOARD_SETPOINT_RATES (OFFBOARD_SETPOINT_ROLL_RATE | OFFBOARD_SETPOINT_PITCH_RATE | OFFBOARD_SETPOINT_YAW_RATE)
+
+/*
+ * Setpoint from a companion computer.  The rates are feed forward on top of
+ * the attitude when both are given.
+ */
+typedef struct offboardSetpoint_s {
+    uint16_t sequence;                      // increments with every setpoint, older ones are dropped
+    uint8_t  flags;                         // offboardSetpointFlags_e, the fields without a flag are ignored
+    float    rates[3];                      // body rates, deg/s, roll pitch yaw
+    float    q[4];                          // attitude quaternion w x y z, in the frame of the IMU quaternion
+    float    thrust;                        // [0;1]
+} offboardSetpoint_t;
+
+bool offboardSetpointReceive(const offboardSetpoint_t *setpoint);
+
+void offboardUpdate(uint32_t currentTime);
+bool offboardIsActive(void);
+void offboardApplyThrottle(void);
+bool offboardGetAngleRate(int axis, float *angleRate);
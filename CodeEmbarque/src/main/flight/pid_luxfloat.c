@@ -54,6 +54,7 @@
 #include "flight/navigation.h"
 #include "flight/gtune.h"
 #include "flight/mixer.h"
+#include "flight/offboard.h"
 
 extern float dT;
 extern uint8_t PIDweight[3];
@@ -187,6 +188,9 @@ void pidLuxFloat(const pidProfile_t *pidProfile, const controlRateConfig_t *cont
             }
         }
 
+        // offboard setpoints replace the stick derived rate
+        offboardGetAngleRate(axis, &angleRate);
+
         // --------low-level gyro-based PID. ----------
         const float gyroRate = luxGyroScale * gyroADC[axis] * gyro.scale;
         axisPID[axis] = pidLuxFloatCore(axis, pidProfile, gyroRate, angleRate);
@@ -52,6 +52,7 @@
 #include "flight/navigation.h"
 #include "flight/gtune.h"
 #include "flight/mixer.h"
+#include "flight/offboard.h"
 
 
 extern uint8_t PIDweight[3];
@@ -185,6 +186,12 @@ void pidMultiWiiRewrite(const pidProfile_t *pidProfile, const controlRateConfig_
             }
         }
 
+        // offboard setpoints replace the stick derived rate
+        float offboardAngleRate;
+        if (offboardGetAngleRate(axis, &offboardAngleRate)) {
+            angleRate = lrintf(offboardAngleRate);
+        }
+
         // --------low-level gyro-based PID. ----------
         const int32_t gyroRate = gyroADC[axis] / 4;
         axisPID[axis] = pidMultiWiiRewriteCore(axis, pidProfile, gyroRate, angleRate);
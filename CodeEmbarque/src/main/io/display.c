@@ -76,6 +76,9 @@ static char lineBuffer[SCREEN_CHARACTER_COLUMN_COUNT + 1];
 #define PAGE_TOGGLE_FREQUENCY (MICROSECONDS_IN_A_SECOND / 2)
 #define GPS_DISPLAY_FORCE_UPDATE_FREQUENCY (MICROSECONDS_IN_A_SECOND * 1)
 
+// Bytes of changed screen content sent to the display per TASK_DISPLAY run, one full page line
+#define DISPLAY_FLUSH_BYTES_PER_UPDATE SCREEN_WIDTH
+
 #define PAGE_TITLE_LINE_COUNT 1
 
 #define HALF_SCREEN_CHARACTER_COLUMN_COUNT (SCREEN_CHARACTER_COLUMN_COUNT / 2)
@@ -586,6 +589,11 @@ void updateDisplay(void)
     uint32_t now = micros();
     static uint8_t previousArmedState = 0;
 
+    // Finish sending the previous frame before drawing a new one
+    if (displayPresent && !i2c_OLED_flush(DISPLAY_FLUSH_BYTES_PER_UPDATE)) {
+        return;
+    }
+
     bool updateNow = (int32_t)(now - nextDisplayUpdateAt) >= 0L;
     if (!updateNow) {
         return;
@@ -694,6 +702,7 @@ void updateDisplay(void)
         updateTicker();
     }
 
+    i2c_OLED_flush(DISPLAY_FLUSH_BYTES_PER_UPDATE);
 }
 
 void displaySetPage(pageId_e pageId)
@@ -712,6 +721,9 @@ void displayInit(void)
     displaySetPage(PAGE_WELCOME);
 
     updateDisplay();
+    if (displayPresent) {
+        i2c_OLED_flush(SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+    }
 
     displaySetNextPageChangeAt(micros() + (1000 * 1000 * 5));
 }
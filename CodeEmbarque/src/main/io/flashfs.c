@@ -33,31 +33,35 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "common/ring_buffer.h"
+
 #include "drivers/flash_m25p16.h"
 #include "flashfs.h"
 
 static uint8_t flashWriteBuffer[FLASHFS_WRITE_BUFFER_SIZE];
 
-/* The position of our head and tail in the circular flash write buffer.
- *
- * The head is the index that a byte would be inserted into on writing, while the tail is the index of the
- * oldest byte that has yet to be written to flash.
+/* The circular flash write buffer.
  *
- * When the circular buffer is empty, head == tail
+ * The head is where a byte would be inserted on writing, while the tail is the oldest byte that has yet to be
+ * written to flash.
  */
-static uint8_t bufferHead = 0, bufferTail = 0;
+static ringBuffer_t flashWriteRing = {
+    .buffer = flashWriteBuffer,
+    .size = FLASHFS_WRITE_BUFFER_SIZE,
+    .mask = FLASHFS_WRITE_BUFFER_SIZE - 1,
+};
 
 // The position of the buffer's tail in the overall flash address space:
 static uint32_t tailAddress = 0;
 
 static void flashfsClearBuffer()
 {
-    bufferTail = bufferHead = 0;
+    ringBufferReset(&flashWriteRing);
 }
 
 static bool flashfsBufferIsEmpty()
 {
-    return bufferTail == bufferHead;
+    return ringBufferIsEmpty(&flashWriteRing);
 }
 
 static void flashfsSetTailAddress(uint32_t address)
@@ -116,10 +120,7 @@ uint32_t flashfsGetSize()
 
 static uint32_t flashfsTransmitBufferUsed()
 {
-    if (bufferHead >= bufferTail)
-        return bufferHead - bufferTail;
-
-    return FLASHFS_WRITE_BUFFER_SIZE - bufferTail + bufferHead;
+    return ringBufferCount(&flashWriteRing);
 }
 
 /**
@@ -253,16 +254,13 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
  */
 static void flashfsGetDirtyDataBuffers(uint8_t const *buffers[], uint32_t bufferSizes[])
 {
-    buffers[0] = flashWriteBuffer + bufferTail;
-    buffers[1] = flashWriteBuffer + 0;
+    const volatile uint8_t *tail;
 
-    if (bufferHead >= bufferTail) {
-        bufferSizes[0] = bufferHead - bufferTail;
-        bufferSizes[1] = 0;
-    } else {
-        bufferSizes[0] = FLASHFS_WRITE_BUFFER_SIZE - bufferTail;
-        bufferSizes[1] = bufferHead;
-    }
+    bufferSizes[0] = ringBufferReadSpan(&flashWriteRing, &tail);
+    bufferSizes[1] = ringBufferCount(&flashWriteRing) - bufferSizes[0];
+
+    buffers[0] = (const uint8_t *)tail;
+    buffers[1] = flashWriteBuffer + 0;
 }
 
 /**
@@ -285,12 +283,7 @@ uint32_t flashfsGetOffset()
  */
 static void flashfsAdvanceTailInBuffer(uint32_t delta)
 {
-    bufferTail += delta;
-
-    // Wrap tail around the end of the buffer
-    if (bufferTail >= FLASHFS_WRITE_BUFFER_SIZE) {
-        bufferTail -= FLASHFS_WRITE_BUFFER_SIZE;
-    }
+    ringBufferConsume(&flashWriteRing, delta);
 
     if (flashfsBufferIsEmpty()) {
         flashfsClearBuffer(); // Bring buffer pointers back to the start to be tidier
@@ -361,10 +354,8 @@ void flashfsSeekRel(int32_t offset)
  */
 void flashfsWriteByte(uint8_t byte)
 {
-    flashWriteBuffer[bufferHead++] = byte;
-
-    if (bufferHead >= FLASHFS_WRITE_BUFFER_SIZE) {
-        bufferHead = 0;
+    if (ringBufferFree(&flashWriteRing)) {
+        ringBufferPush(&flashWriteRing, byte);
     }
 
     if (flashfsTransmitBufferUsed() >= FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN) {
@@ -435,25 +426,7 @@ void flashfsWrite(const uint8_t *data, unsigned int len, bool sync)
     }
 
     // Buffer up the data the user supplied instead of writing it right away
-
-    // First write the portion before we wrap around the end of the circular buffer
-    unsigned int bufferBytesBeforeWrap = FLASHFS_WRITE_BUFFER_SIZE - bufferHead;
-
-    unsigned int firstPortion = len < bufferBytesBeforeWrap ? len : bufferBytesBeforeWrap;
-
-    memcpy(flashWriteBuffer + bufferHead, data, firstPortion);
-
-    bufferHead += firstPortion;
-
-    data += firstPortion;
-    len -= firstPortion;
-
-    // If we wrap the head around, write the remainder to the start of the buffer (if any)
-    if (bufferHead == FLASHFS_WRITE_BUFFER_SIZE) {
-        memcpy(flashWriteBuffer + 0, data, len);
-
-        bufferHead = len;
-    }
+    ringBufferWrite(&flashWriteRing, data, len);
 }
 
 /**
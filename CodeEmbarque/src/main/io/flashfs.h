@@ -22,7 +22,7 @@
 #include "drivers/flash.h"
 
 #define FLASHFS_WRITE_BUFFER_SIZE 128
-#define FLASHFS_WRITE_BUFFER_USABLE (FLASHFS_WRITE_BUFFER_SIZE - 1)
+#define FLASHFS_WRITE_BUFFER_USABLE FLASHFS_WRITE_BUFFER_SIZE
 
 // Automatically trigger a flush when this much data is in the buffer
 #define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN 64
@@ -29,6 +29,7 @@
 #include "common/maths.h"
 #include "common/axis.h"
 #include "common/utils.h"
+#include "common/crc.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
@@ -813,8 +814,7 @@ enum {
 } ubx_nav_status_bits;
 
 // Packet checksum accumulators
-static uint8_t _ck_a;
-static uint8_t _ck_b;
+static fletcher8_t _ck;
 
 // State machine state
 static bool _skip_packet;
@@ -860,15 +860,6 @@ static union {
     uint8_t bytes[UBLOX_BUFFER_SIZE];
 } _buffer;
 
-void _update_checksum(uint8_t *data, uint8_t len, uint8_t *ck_a, uint8_t *ck_b)
-{
-    while (len--) {
-        *ck_a += *data;
-        *ck_b += *ck_a;
-        data++;
-    }
-}
-
 
 static bool UBLOX_parse_gps(void)
 {
@@ -960,21 +951,21 @@ static bool gpsNewFrameUBLOX(uint8_t data)
         case 2: // Class
             _step++;
             _class = data;
-            _ck_b = _ck_a = data;   // reset the checksum accumulators
+            _ck.b = _ck.a = data;   // reset the checksum accumulators
             break;
         case 3: // Id
             _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
+            fletcher8Update(&_ck, data);    // checksum byte
             _msg_id = data;
             break;
         case 4: // Payload length (part 1)
             _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
+            fletcher8Update(&_ck, data);    // checksum byte
             _payload_length = data; // payload length low byte
             break;
         case 5: // Payload length (part 2)
             _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
+            fletcher8Update(&_ck, data);    // checksum byte
             _payload_length |= (uint16_t)(data << 8);
 
             if (_payload_length > MAX_UBLOX_PAYLOAD_SIZE ) {
@@ -998,7 +989,7 @@ static bool gpsNewFrameUBLOX(uint8_t data)
             }
             break;
         case 6:
-            _ck_b += (_ck_a += data);       // checksum byte
+            fletcher8Update(&_ck, data);    // checksum byte
             if (_payload_counter < UBLOX_BUFFER_SIZE) {
                 _buffer.bytes[_payload_counter] = data;
             }
@@ -1010,7 +1001,7 @@ static bool gpsNewFrameUBLOX(uint8_t data)
             break;
         case 7:
             _step++;
-            if (_ck_a != data) {
+            if (_ck.a != data) {
                 _skip_packet = true;          // bad checksum
                 gpsData.errors++;
             }
@@ -1020,7 +1011,7 @@ static bool gpsNewFrameUBLOX(uint8_t data)
 
             shiftPacketLog();
 
-            if (_ck_b != data) {
+            if (_ck.b != data) {
                 *gpsPacketLogChar = LOG_ERROR;
                 gpsData.errors++;
                 break;              // bad checksum
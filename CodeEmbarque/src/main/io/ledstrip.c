@@ -125,6 +125,28 @@ STATIC_UNIT_TESTED uint8_t lowestXValueForEast;
 uint8_t ledCount;
 uint8_t ledRingCount;
 static uint8_t ledRingSeqLen;
+static uint16_t ledFunctionsUsed;       // LED_FLAG_FUNCTION() of every configured LED
+
+// inputs the layers draw from, the strip is recomposed only when one of them or a layer timer changes
+typedef enum {
+    LED_INPUT_FLIGHT_MODE   = 1 << 0,
+    LED_INPUT_ARMED         = 1 << 1,
+    LED_INPUT_GPS           = 1 << 2,
+    LED_INPUT_HUE           = 1 << 3,
+    LED_INPUT_STICKS        = 1 << 4,
+} ledInput_e;
+
+typedef struct ledStripInputs_s {
+    uint16_t flightModeFlags;
+    bool armed;
+    uint8_t gpsState;                   // 0 no sats, 1 sats without fix, 2 fix
+    int16_t throttleHue;                // hue offsets as drawn by the hue layer
+    int16_t rssiHue;
+    uint16_t indicatorQuadrants;        // quadrant_e pointed to by the sticks
+} ledStripInputs_t;
+
+static ledStripInputs_t ledStripInputs;
+static bool ledStripInputsValid = false;
 
 // macro for initializer
 #define LF(name) LED_FLAG_FUNCTION(LED_FUNCTION_ ## name)
@@ -258,6 +280,7 @@ STATIC_UNIT_TESTED void determineOrientationLimits(void)
 static void updateLedCount(void)
 {
     int count = 0, countRing = 0;
+    uint16_t functions = 0;
 
     for (int ledIndex = 0; ledIndex < LED_MAX_STRIP_LENGTH; ledIndex++) {
         const ledConfig_t *ledConfig = ledConfigs(ledIndex);
@@ -266,9 +289,11 @@ static void updateLedCount(void)
         count++;
         if ((ledConfig->flags & LED_FLAG_FUNCTION(LED_FUNCTION_THRUST_RING)))
             countRing++;
+        functions |= ledConfig->flags & LED_FLAG_FUNCTION_MASK;
     }
     ledCount = count;
     ledRingCount = countRing;
+    ledFunctionsUsed = functions;
 }
 
 void reevalulateLedConfig(void)
@@ -277,6 +302,9 @@ void reevalulateLedConfig(void)
     determineLedStripDimensions();
     determineOrientationLimits();
     updateLedRingCounts();
+
+    // colours or layout changed, redraw everything on the next update
+    ledStripInputsValid = false;
 }
 
 // get specialColor by index
@@ -512,9 +540,13 @@ static void applyLedModeLayer(void)
     }
 }
 
-static void applyLedHue(ledFunctionId_e flag, int16_t value, int16_t minRange, int16_t maxRange)
+static int16_t ledHueOffset(int16_t value, int16_t minRange, int16_t maxRange)
+{
+    return scaleRange(value, minRange, maxRange, -60, +60);
+}
+
+static void applyLedHue(ledFunctionId_e flag, int scaled)
 {
-    int scaled = scaleRange(value, minRange, maxRange, -60, +60);
     scaled += HSV_HUE_MAX;   // wrap negative values correctly
 
     for (int i = 0; i < ledCount; ++i) {
@@ -531,8 +563,8 @@ static void applyLedHue(ledFunctionId_e flag, int16_t value, int16_t minRange, i
 
 static void applyLedHueLayer(void)
 {
-    applyLedHue(LED_FUNCTION_THROTTLE, rcData[THROTTLE], PWM_RANGE_MIN, PWM_RANGE_MAX);
-    applyLedHue(LED_FUNCTION_RSSI, rssi, 0, 1023);
+    applyLedHue(LED_FUNCTION_THROTTLE, ledStripInputs.throttleHue);
+    applyLedHue(LED_FUNCTION_RSSI, ledStripInputs.rssiHue);
 }
 
 typedef enum {
@@ -642,6 +674,22 @@ static void applyLedGpsLayer(bool updateNow, uint32_t *timer)
 
 #define INDICATOR_DEADBAND 25
 
+static quadrant_e getIndicatorQuadrants(void)
+{
+    quadrant_e quadrants = 0;
+    if (rcCommand[ROLL] > INDICATOR_DEADBAND) {
+        quadrants |= QUADRANT_NORTH_EAST | QUADRANT_SOUTH_EAST;
+    } else if (rcCommand[ROLL] < -INDICATOR_DEADBAND) {
+        quadrants |= QUADRANT_NORTH_WEST | QUADRANT_SOUTH_WEST;
+    }
+    if (rcCommand[PITCH] > INDICATOR_DEADBAND) {
+        quadrants |= QUADRANT_NORTH_EAST | QUADRANT_NORTH_WEST;
+    } else if (rcCommand[PITCH] < -INDICATOR_DEADBAND) {
+        quadrants |= QUADRANT_SOUTH_EAST | QUADRANT_SOUTH_WEST;
+    }
+    return quadrants;
+}
+
 static void applyLedIndicatorLayer(bool updateNow, uint32_t *timer)
 {
     static uint8_t flashCounter = 0;
@@ -660,17 +708,7 @@ static void applyLedIndicatorLayer(bool updateNow, uint32_t *timer)
     }
     const hsvColor_t *flashColor = flashCounter ? &HSV(ORANGE) : &HSV(BLACK); // TODO - use user color?
 
-    quadrant_e quadrants = 0;
-    if (rcCommand[ROLL] > INDICATOR_DEADBAND) {
-        quadrants |= QUADRANT_NORTH_EAST | QUADRANT_SOUTH_EAST;
-    } else if (rcCommand[ROLL] < -INDICATOR_DEADBAND) {
-        quadrants |= QUADRANT_NORTH_WEST | QUADRANT_SOUTH_WEST;
-    }
-    if (rcCommand[PITCH] > INDICATOR_DEADBAND) {
-        quadrants |= QUADRANT_NORTH_EAST | QUADRANT_NORTH_WEST;
-    } else if (rcCommand[PITCH] < -INDICATOR_DEADBAND) {
-        quadrants |= QUADRANT_SOUTH_EAST | QUADRANT_SOUTH_WEST;
-    }
+    quadrant_e quadrants = ledStripInputs.indicatorQuadrants;
 
     for (int ledIndex = 0; ledIndex < ledCount; ledIndex++) {
         const ledConfig_t *ledConfig = ledConfigs(ledIndex);
@@ -817,31 +855,92 @@ static uint32_t timerVal[timTimerCount];
 typedef void applyLayerFn_timed(bool updateNow, uint32_t* timer);
 typedef void applyLayerFn(void);
 
+#define LF(name) LED_FLAG_FUNCTION(LED_FUNCTION_ ## name)
+
 static const struct {
     int8_t timId;                          // timer id for update, -1 if none
+    uint8_t inputs;                        // ledInput_e the layer output depends on
+    uint16_t ledFunctions;                 // LED_FLAG_FUNCTION() drawn by the layer, 0 for all LEDs
     union {
         applyLayerFn *apply;               // function to apply layer unconditionally
         applyLayerFn_timed *applyTimed;    // apply with timer
     } f;
 } layerTable[] = {
     // LAYER 1
-    { -1,             .f.apply      = &applyLedModeLayer },
-    { -1,             .f.apply      = &applyLedHueLayer },
+    {-1,           LED_INPUT_FLIGHT_MODE | LED_INPUT_ARMED,  0,                          .f.apply = &applyLedModeLayer},
+    {-1,           LED_INPUT_HUE,                            LF(THROTTLE) | LF(RSSI),    .f.apply = &applyLedHueLayer},
     // LAYER 2
-    {timWarning,      .f.applyTimed = &applyLedWarningLayer},
+    {timWarning,   0,                                        LF(WARNING),                .f.applyTimed = &applyLedWarningLayer},
 #ifdef GPS
-    {timGps,          .f.applyTimed = &applyLedGpsLayer},
+    {timGps,       LED_INPUT_GPS,                            LF(GPS),                    .f.applyTimed = &applyLedGpsLayer},
 #endif
     // LAYER 3
-    {timIndicator,    .f.applyTimed = &applyLedIndicatorLayer},
+    {timIndicator, LED_INPUT_STICKS,                         LF(INDICATOR),              .f.applyTimed = &applyLedIndicatorLayer},
     // LAYER 4
-    {timBlink,        .f.applyTimed = &applyLedBlinkLayer},
+    {timBlink,     0,                                        LF(BLINK),                  .f.applyTimed = &applyLedBlinkLayer},
 #ifdef USE_LED_ANIMATION
-    {timAnimation,    .f.applyTimed = &applyLedAnimationLayer},
+    {timAnimation, LED_INPUT_ARMED,                          0,                          .f.applyTimed = &applyLedAnimationLayer},
 #endif
-    {timRotation,     .f.applyTimed = &applyLedThrustRingLayer},
+    {timRotation,  LED_INPUT_ARMED,                          LF(THRUST_RING),            .f.applyTimed = &applyLedThrustRingLayer},
 };
 
+#undef LF
+
+static uint8_t getGpsLedState(void)
+{
+#ifdef GPS
+    if (GPS_numSat == 0 || !sensors(SENSOR_GPS)) {
+        return 0;
+    }
+    return STATE(GPS_FIX) ? 2 : 1;
+#else
+    return 0;
+#endif
+}
+
+// sample the layer inputs and return the ledInput_e that changed since the last composition
+static uint8_t updateLedStripInputs(void)
+{
+    ledStripInputs_t inputs;
+
+    inputs.flightModeFlags = flightModeFlags;
+    inputs.armed = ARMING_FLAG(ARMED);
+    inputs.gpsState = getGpsLedState();
+    inputs.throttleHue = ledHueOffset(rcData[THROTTLE], PWM_RANGE_MIN, PWM_RANGE_MAX);
+    inputs.rssiHue = ledHueOffset(rssi, 0, 1023);
+    inputs.indicatorQuadrants = getIndicatorQuadrants();
+
+    uint8_t changed = 0;
+    if (!ledStripInputsValid) {
+        changed = 0xFF;
+    } else {
+        if (inputs.flightModeFlags != ledStripInputs.flightModeFlags)
+            changed |= LED_INPUT_FLIGHT_MODE;
+        if (inputs.armed != ledStripInputs.armed)
+            changed |= LED_INPUT_ARMED;
+        if (inputs.gpsState != ledStripInputs.gpsState)
+            changed |= LED_INPUT_GPS;
+        if (inputs.throttleHue != ledStripInputs.throttleHue || inputs.rssiHue != ledStripInputs.rssiHue)
+            changed |= LED_INPUT_HUE;
+        if (inputs.indicatorQuadrants != ledStripInputs.indicatorQuadrants)
+            changed |= LED_INPUT_STICKS;
+    }
+
+    ledStripInputs = inputs;
+    ledStripInputsValid = true;
+
+    return changed;
+}
+
+static bool isLedLayerUsed(unsigned layer)
+{
+    return !layerTable[layer].ledFunctions || (layerTable[layer].ledFunctions & ledFunctionsUsed);
+}
+
+/*
+ * Event driven composition: every layer is redrawn, in order, only when an input one of the used
+ * layers depends on changed or when the timer of a used layer expired. Otherwise the strip is left alone.
+ */
 void updateLedStrip(void)
 {
 
@@ -856,6 +955,9 @@ void updateLedStrip(void)
         }
         return;
     }
+    if (!ledStripEnabled) {
+        ledStripInputsValid = false;    // back from BOXLEDLOW, the strip is black
+    }
     ledStripEnabled = true;
 
     uint32_t now = micros();
@@ -873,7 +975,23 @@ void updateLedStrip(void)
         }
     }
 
-    if (!timActive)
+    uint8_t changedInputs = updateLedStripInputs();
+
+    bool recompose = false;
+    for(unsigned i = 0; i < ARRAYLEN(layerTable); i++) {
+        if (!isLedLayerUsed(i))
+            continue;
+        int timId = layerTable[i].timId;
+        if ((changedInputs & layerTable[i].inputs) || (timId >= 0 && (timActive & (1 << timId)))) {
+            recompose = true;
+            break;
+        }
+    }
+    if (changedInputs == 0xFF) {
+        recompose = true;
+    }
+
+    if (!recompose)
         return;          // no change this update, keep old state
 
     // apply all layers; triggered timed functions has to update timers
@@ -934,6 +1052,8 @@ bool parseColor(int index, const char *colorConfig)
         memset(color, 0, sizeof(*color));
     }
 
+    ledStripInputsValid = false;
+
     return result;
 }
 
@@ -956,6 +1076,7 @@ bool setModeColor(ledModeIndex_e modeIndex, int modeColorIndex, int colorIndex)
     } else {
         return false;
     }
+    ledStripInputsValid = false;
     return true;
 }
 
@@ -38,7 +38,7 @@
   #define DEFAULT_PWM_RATE BRUSHLESS_MOTORS_PWM_RATE
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(motorAndServoConfig_t, motorAndServoConfig, PG_MOTOR_AND_SERVO_CONFIG, 0);
+PG_REGISTER_WITH_RESET_TEMPLATE(motorAndServoConfig_t, motorAndServoConfig, PG_MOTOR_AND_SERVO_CONFIG, 2);
 
 PG_RESET_TEMPLATE(motorAndServoConfig_t, motorAndServoConfig,
     .minthrottle      = 1150,
@@ -47,4 +47,7 @@ PG_RESET_TEMPLATE(motorAndServoConfig_t, motorAndServoConfig,
     .servoCenterPulse = 1500,
     .motor_pwm_rate   = DEFAULT_PWM_RATE,
     .servo_pwm_rate   = 50,
+    .motor_protocol   = 0,
+    .thrust_linear    = 0,
+    .vbat_sag_compensation = 0,
 );
@@ -26,7 +26,10 @@ typedef struct motorAndServoConfig_s {
     uint16_t servoCenterPulse;              // This is the value for servos when they should be in the middle. e.g. 1500.
 
     uint16_t motor_pwm_rate;                // The update rate of motor outputs (50-498Hz)
-    uint16_t servo_pwm_rate;                // The update rate of servo outputs (50-498Hz)
+    uint16_t servo_pwm_rate;                // The update rate of servo outputs (50-560Hz, above 333Hz only for narrow pulse digital servos)
+    uint8_t motor_protocol;                 // motorProtocol_e, PWM (or OneShot125 when the feature is enabled) or DShot150/300/600
+    uint8_t thrust_linear;                  // 0-100%, share of the thrust that goes with the square of the motor command
+    uint8_t vbat_sag_compensation;          // 0-100%, how much of the battery sag is compensated on the motor commands
 } motorAndServoConfig_t;
 
 PG_DECLARE(motorAndServoConfig_t, motorAndServoConfig);
@@ -79,6 +79,7 @@
 #include "sensors/barometer.h"
 #include "sensors/compass.h"
 #include "sensors/gyro.h"
+#include "sensors/esc_sensor.h"
 
 #include "flight/mixer.h"
 #include "flight/servos.h"
@@ -87,6 +88,7 @@
 #include "flight/failsafe.h"
 #include "flight/navigation.h"
 #include "flight/altitudehold.h"
+#include "flight/offboard.h"
 
 #include "blackbox/blackbox.h"
 
@@ -168,6 +170,7 @@ static const box_t boxes[CHECKBOX_ITEM_COUNT] = {
     { "BLACKBOX",  BOXBLACKBOX,  26 },
     { "FAILSAFE",  BOXFAILSAFE,  27 },
     { "AIR MODE",  BOXAIRMODE,   28 },
+    { "OFFBOARD",  BOXOFFBOARD,  29 },
 };
 
 static const char pidnames[] =
@@ -256,6 +259,7 @@ static void initActiveBoxIds(void)
     #endif //BARO
 
     ena |= 1 << BOXAIRMODE;
+    ena |= 1 << BOXOFFBOARD;
 
     if (sensors(SENSOR_ACC) || sensors(SENSOR_MAG)) {
         ena |= 1 << BOXMAG;
@@ -586,6 +590,8 @@ static int processOutCommand(mspPacket_t *cmd, mspPacket_t *reply)
             sbufWriteU8(dst, getCurrentProfile());
             if(cmd->cmd == MSP_STATUS_EX) {
                 sbufWriteU16(dst, averageSystemLoadPercent);
+                // bit 0: DShot was requested but the motors fell back to PWM
+                sbufWriteU8(dst, pwmGetOutputConfiguration()->dshotServoConflict ? 1 : 0);
             }
             break;
 
@@ -637,6 +643,24 @@ static int processOutCommand(mspPacket_t *cmd, mspPacket_t *reply)
             }
             break;
 
+#ifdef USE_ESC_SENSOR
+        case MSP_ESC_SENSOR_DATA:
+            if (isEscSensorActive()) {
+                sbufWriteU8(dst, MAX_SUPPORTED_MOTORS);
+                for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+                    escSensorData_t *escData = getEscSensorData(i);
+                    sbufWriteU8(dst, escData->dataAge);
+                    sbufWriteU8(dst, escData->temperature);
+                    sbufWriteU16(dst, escData->voltage);
+                    sbufWriteU16(dst, (uint16_t)constrain(escData->current, 0, 0xFFFF));
+                    sbufWriteU16(dst, (uint16_t)constrain(escData->rpm, 0, 0xFFFF));
+                }
+            } else {
+                sbufWriteU8(dst, 0);
+            }
+            break;
+#endif
+
         case MSP_RC:
             for (int i = 0; i < rxRuntimeConfig.channelCount; i++)
                 sbufWriteU16(dst, rcData[i]);
@@ -1063,6 +1087,24 @@ static int processInCommand(mspPacket_t *cmd)
             break;
         }
 
+        case MSP_SET_OFFBOARD_SETPOINT: {
+            // rates in 0.1 deg/s, quaternion in Q14, thrust in 0.1 %
+            // handled by the 100Hz serial task, MAVLink on its own port is the low latency way in
+            if (len != 4 + 2 + 1 + 3 * 2 + 4 * 2 + 2)
+                return -1;
+            offboardSetpoint_t setpoint;
+            sbufAdvance(src, 4);        // sender time, not synchronised with ours so not used
+            setpoint.sequence = sbufReadU16(src);
+            setpoint.flags = sbufReadU8(src);
+            for (i = 0; i < 3; i++)
+                setpoint.rates[i] = (int16_t)sbufReadU16(src) / 10.0f;
+            for (i = 0; i < 4; i++)
+                setpoint.q[i] = (int16_t)sbufReadU16(src) / 16384.0f;
+            setpoint.thrust = sbufReadU16(src) / 1000.0f;
+            offboardSetpointReceive(&setpoint);
+            break;
+        }
+
         case MSP_SET_ACC_TRIM:
             accelerometerConfig()->accelerometerTrims.values.pitch = sbufReadU16(src);
             accelerometerConfig()->accelerometerTrims.values.roll  = sbufReadU16(src);
@@ -1420,6 +1462,7 @@ static int processInCommand(mspPacket_t *cmd)
                     color->s = s;
                     color->v = v;
                 }
+                reevalulateLedConfig();
                 break;
 
             case MSP_SET_LED_STRIP_CONFIG: {
@@ -217,6 +217,7 @@
 #define MSP_3D                   124    //out message         Settings needed for reversible ESCs
 #define MSP_RC_DEADBAND          125    //out message         deadbands for yaw alt pitch roll
 #define MSP_SENSOR_ALIGNMENT     126    //out message         orientation of acc,gyro,mag
+#define MSP_ESC_SENSOR_DATA      134    //out message         per motor temperature, voltage, current and eRPM from ESC telemetry
 
 #define MSP_SET_RAW_RC           200    //in message          8 rc chan
 #define MSP_SET_RAW_GPS          201    //in message          fix, numsat, lat, lon, alt, speed
@@ -237,6 +238,7 @@
 #define MSP_SET_RC_DEADBAND      218    //in message          deadbands for yaw alt pitch roll
 #define MSP_SET_RESET_CURR_PID   219    //in message          resetting the current pid profile to defaults
 #define MSP_SET_SENSOR_ALIGNMENT 220    //in message          set the orientation of the acc,gyro,mag
+#define MSP_SET_OFFBOARD_SETPOINT 221   //in message          offboard rate/attitude/thrust setpoint, serial task rate, not low latency
 
 // #define MSP_BIND                 240    //in message          no param
 // #define MSP_ALARMS               242
@@ -247,7 +249,7 @@
 #define MSP_DEBUG                254    //out message         debug1,debug2,debug3,debug4
 
 // Additional commands that are not compatible with MultiWii
-#define MSP_STATUS_EX            150    //out message         cycletime, errors_count, CPU load, sensor present etc
+#define MSP_STATUS_EX            150    //out message         cycletime, errors_count, CPU load, sensor present, output warnings etc
 #define MSP_UID                  160    //out message         Unique device ID
 #define MSP_GPSSVINFO            164    //out message         get Signal Strength (only U-Blox)
 #define MSP_ACC_TRIM             240    //out message         get acc angle trim values
@@ -49,6 +49,7 @@ typedef enum {
     BOXBLACKBOX,
     BOXFAILSAFE,
     BOXAIRMODE,
+    BOXOFFBOARD,
     CHECKBOX_ITEM_COUNT
 } boxId_e;
 
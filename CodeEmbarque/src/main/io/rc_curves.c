@@ -27,39 +27,57 @@
 
 #include "io/rc_curves.h"
 
-int16_t lookupPitchRollRC[PITCH_LOOKUP_LENGTH];     // lookup table for expo & RC rate PITCH+ROLL
-int16_t lookupYawRC[YAW_LOOKUP_LENGTH];     // lookup table for expo & RC rate YAW
-int16_t lookupThrottleRC[THROTTLE_LOOKUP_LENGTH];   // lookup table for expo & mid THROTTLE
+rcCurve_t pitchRollCurve;     // expo & RC rate PITCH+ROLL, stick deflection [0;500]
+rcCurve_t yawCurve;           // expo & RC rate YAW, stick deflection [0;500]
+rcCurve_t throttleCurve;      // expo & mid THROTTLE, throttle [0;1000] -> [MINTHROTTLE;MAXTHROTTLE]
 
+/*
+ * The curves are sampled from their closed forms over the whole input range,
+ * the stick position is the deflection in units of 100 as in the former
+ * 100 step lookup tables.
+ */
+static void generateCurve(rcCurve_t *curve, int32_t inputMax, float (*function)(float stick))
+{
+    curve->inputScale = (float)RC_CURVE_SEGMENTS / inputMax;
 
-void generatePitchRollCurve()
+    for (int i = 0; i <= RC_CURVE_SEGMENTS; i++) {
+        curve->points[i] = function((float)i * inputMax / RC_CURVE_SEGMENTS / 100);
+    }
+}
+
+static float pitchRollCurveFunction(float stick)
 {
-    uint8_t i;
+    return (2500 + currentControlRateProfile->rcExpo8 * (stick * stick - 25)) * stick * currentControlRateProfile->rcRate8 / 2500;
+}
 
-    for (i = 0; i < PITCH_LOOKUP_LENGTH; i++)
-        lookupPitchRollRC[i] = (2500 + currentControlRateProfile->rcExpo8 * (i * i - 25)) * i * (int32_t) currentControlRateProfile->rcRate8 / 2500;
+static float yawCurveFunction(float stick)
+{
+    return (2500 + currentControlRateProfile->rcYawExpo8 * (stick * stick - 25)) * stick / 25;
 }
 
-void generateYawCurve()
+static float throttleCurveFunction(float stick)
 {
-    uint8_t i;
+    float tmp = 10 * stick - currentControlRateProfile->thrMid8;
+    float y = 1;
+    if (tmp > 0)
+        y = 100 - currentControlRateProfile->thrMid8;
+    if (tmp < 0)
+        y = currentControlRateProfile->thrMid8;
+    float throttle = 10 * currentControlRateProfile->thrMid8 + tmp * (100 - currentControlRateProfile->thrExpo8 + currentControlRateProfile->thrExpo8 * (tmp * tmp) / (y * y)) / 10;
+    return motorAndServoConfig()->minthrottle + (motorAndServoConfig()->maxthrottle - motorAndServoConfig()->minthrottle) * throttle / 1000; // [MINTHROTTLE;MAXTHROTTLE]
+}
 
-    for (i = 0; i < YAW_LOOKUP_LENGTH; i++)
-        lookupYawRC[i] = (2500 + currentControlRateProfile->rcYawExpo8 * (i * i - 25)) * i / 25;
+void generatePitchRollCurve()
+{
+    generateCurve(&pitchRollCurve, PITCH_ROLL_CURVE_INPUT_MAX, pitchRollCurveFunction);
 }
 
-void generateThrottleCurve()
+void generateYawCurve()
 {
-    uint8_t i;
+    generateCurve(&yawCurve, YAW_CURVE_INPUT_MAX, yawCurveFunction);
+}
 
-    for (i = 0; i < THROTTLE_LOOKUP_LENGTH; i++) {
-        int16_t tmp = 10 * i - currentControlRateProfile->thrMid8;
-        uint8_t y = 1;
-        if (tmp > 0)
-            y = 100 - currentControlRateProfile->thrMid8;
-        if (tmp < 0)
-            y = currentControlRateProfile->thrMid8;
-        lookupThrottleRC[i] = 10 * currentControlRateProfile->thrMid8 + tmp * (100 - currentControlRateProfile->thrExpo8 + (int32_t) currentControlRateProfile->thrExpo8 * (tmp * tmp) / (y * y)) / 10;
-        lookupThrottleRC[i] = motorAndServoConfig()->minthrottle + (int32_t) (motorAndServoConfig()->maxthrottle - motorAndServoConfig()->minthrottle) * lookupThrottleRC[i] / 1000; // [MINTHROTTLE;MAXTHROTTLE]
-    }
+void generateThrottleCurve()
+{
+    generateCurve(&throttleCurve, THROTTLE_CURVE_INPUT_MAX, throttleCurveFunction);
 }
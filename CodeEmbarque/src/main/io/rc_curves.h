@@ -17,12 +17,32 @@
 
 #pragma once
 
-#define PITCH_LOOKUP_LENGTH 7
-#define YAW_LOOKUP_LENGTH 7
-#define THROTTLE_LOOKUP_LENGTH 12
-extern int16_t lookupPitchRollRC[PITCH_LOOKUP_LENGTH];   // lookup table for expo & RC rate PITCH+ROLL
-extern int16_t lookupYawRC[YAW_LOOKUP_LENGTH];     // lookup table for expo & RC rate YAW
-extern int16_t lookupThrottleRC[THROTTLE_LOOKUP_LENGTH];   // lookup table for expo & mid THROTTLE
+#define PITCH_ROLL_CURVE_INPUT_MAX 500
+#define YAW_CURVE_INPUT_MAX 500
+#define THROTTLE_CURVE_INPUT_MAX 1000
+
+#define RC_CURVE_SEGMENTS 256
+
+typedef struct rcCurve_s {
+    float points[RC_CURVE_SEGMENTS + 1];
+    float inputScale;                       // segments per input unit
+} rcCurve_t;
+
+extern rcCurve_t pitchRollCurve;   // expo & RC rate PITCH+ROLL
+extern rcCurve_t yawCurve;         // expo & RC rate YAW
+extern rcCurve_t throttleCurve;    // expo & mid THROTTLE
+
+// Linear interpolation between the samples, input in [0;input max of the curve]
+static inline float rcCurveLookup(const rcCurve_t *curve, int32_t input)
+{
+    float position = input * curve->inputScale;
+    int index = (int)position;
+
+    if (index >= RC_CURVE_SEGMENTS) {
+        return curve->points[RC_CURVE_SEGMENTS];
+    }
+    return curve->points[index] + (curve->points[index + 1] - curve->points[index]) * (position - index);
+}
 
 void generatePitchRollCurve();
 void generateYawCurve();
@@ -384,6 +384,7 @@ void closeSerialPort(serialPort_t *serialPort)
     // TODO wait until data has been transmitted.
 
     serialPort->callback = NULL;
+    serialPort->burstCallback = NULL;
 
     serialPortUsage->function = FUNCTION_NONE;
     serialPortUsage->serialPort = NULL;
@@ -33,7 +33,8 @@ typedef enum {
     FUNCTION_TELEMETRY_SMARTPORT = (1 << 5), // 32
     FUNCTION_RX_SERIAL           = (1 << 6), // 64
     FUNCTION_BLACKBOX            = (1 << 7), // 128
-    FUNCTION_TELEMETRY_MAVLINK   = (1 << 8)  // 256
+    FUNCTION_TELEMETRY_MAVLINK   = (1 << 8), // 256
+    FUNCTION_ESC_SENSOR          = (1 << 9)  // 512
 } serialPortFunction_e;
 
 typedef enum {
@@ -46,6 +46,7 @@
 #include "drivers/bus_i2c.h"
 #include "drivers/gpio.h"
 #include "drivers/timer.h"
+#include "drivers/pwm_mapping.h"
 #include "drivers/pwm_rx.h"
 #include "drivers/sdcard.h"
 #include "drivers/buf_writer.h"
@@ -72,6 +73,8 @@
 #include "sensors/gyro.h"
 #include "sensors/compass.h"
 #include "sensors/barometer.h"
+#include "sensors/esc_sensor.h"
+#include "sensors/rpm_filter.h"
 
 #include "blackbox/blackbox.h"
 
@@ -83,6 +86,7 @@
 #include "flight/navigation.h"
 #include "flight/failsafe.h"
 #include "flight/altitudehold.h"
+#include "flight/offboard.h"
 
 #include "telemetry/telemetry.h"
 #include "telemetry/frsky.h"
@@ -185,6 +189,8 @@ typedef enum {
     TABLE_SERIAL_RX,
     TABLE_GYRO_FILTER,
     TABLE_GYRO_LPF,
+    TABLE_MOTOR_PROTOCOL,
+    TABLE_RC_SMOOTHING,
 } lookupTableIndex_e;
 
 typedef enum {
@@ -306,6 +312,7 @@ static const char * const featureNames[] = {
     "BLACKBOX", 
     "CHANNEL_FORWARDING", 
     "TRANSPONDER", 
+    "ESC_SENSOR",
     NULL
 };
 
@@ -429,7 +436,8 @@ static const char * const lookupTableAlignment[] = {
 static const char * const lookupTableCurrentSensor[] = {
     "NONE", 
     "ADC", 
-    "VIRTUAL"
+    "VIRTUAL",
+    "ESC"
 };
 
 static const char * const lookupTableGimbalMode[] = {
@@ -457,7 +465,8 @@ static const char * const lookupTableSerialRX[] = {
     "SUMH",
     "XB-B",
     "XB-B-RJ01",
-    "IBUS"
+    "IBUS",
+    "CRSF"
 };
 
 static const char * const lookupTableGyroFilter[] = {
@@ -476,6 +485,20 @@ static const char * const lookupTableGyroLpf[] = {
     "10HZ"
 };
 
+static const char * const lookupTableMotorProtocol[] = {
+    "PWM",
+    "DSHOT150",
+    "DSHOT300",
+    "DSHOT600"
+};
+
+static const char * const lookupTableRcSmoothing[] = {
+    "OFF",
+    "INTERPOLATE",
+    "PT1",
+    "FEEDFORWARD"
+};
+
 static const lookupTableEntry_t lookupTables[] = {
     { lookupTableOffOn,     sizeof(lookupTableOffOn) / sizeof(char *) },
     { lookupTableUnit,      sizeof(lookupTableUnit) / sizeof(char *) },
@@ -493,6 +516,8 @@ static const lookupTableEntry_t lookupTables[] = {
     { lookupTableSerialRX,      sizeof(lookupTableSerialRX) / sizeof(char *) },
     { lookupTableGyroFilter,    sizeof(lookupTableGyroFilter) / sizeof(char *) },
     { lookupTableGyroLpf,       sizeof(lookupTableGyroLpf) / sizeof(char *) },
+    { lookupTableMotorProtocol, sizeof(lookupTableMotorProtocol) / sizeof(char *) },
+    { lookupTableRcSmoothing,   sizeof(lookupTableRcSmoothing) / sizeof(char *) },
 };
 
 const clivalue_t valueTable[] = {
@@ -508,7 +533,8 @@ const clivalue_t valueTable[] = {
     { "rssi_channel",               VAR_INT8   | MASTER_VALUE, .config.minmax = { 0,  MAX_SUPPORTED_RC_CHANNEL_COUNT } , PG_RX_CONFIG, offsetof(rxConfig_t, rssi_channel)},
     { "rssi_scale",                 VAR_UINT8  | MASTER_VALUE, .config.minmax = { RSSI_SCALE_MIN,  RSSI_SCALE_MAX } , PG_RX_CONFIG, offsetof(rxConfig_t, rssi_scale)},
     { "rssi_ppm_invert",            VAR_INT8   | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON } , PG_RX_CONFIG, offsetof(rxConfig_t, rssi_ppm_invert)},
-    { "rc_smoothing",               VAR_INT8   | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON } , PG_RX_CONFIG, offsetof(rxConfig_t, rcSmoothing)},
+    { "rc_smoothing",               VAR_INT8   | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_RC_SMOOTHING } , PG_RX_CONFIG, offsetof(rxConfig_t, rcSmoothing)},
+    { "offboard_timeout_ms",        VAR_UINT16 | MASTER_VALUE, .config.minmax = { 0, OFFBOARD_TIMEOUT_MS_MAX } , PG_OFFBOARD_CONFIG, offsetof(offboardConfig_t, timeout_ms)},
     { "rx_min_usec",                VAR_UINT16 | MASTER_VALUE, .config.minmax = { PWM_PULSE_MIN,  PWM_PULSE_MAX } , PG_RX_CONFIG, offsetof(rxConfig_t, rx_min_usec)},
     { "rx_max_usec",                VAR_UINT16 | MASTER_VALUE, .config.minmax = { PWM_PULSE_MIN,  PWM_PULSE_MAX } , PG_RX_CONFIG, offsetof(rxConfig_t, rx_max_usec)},
     { "serialrx_provider",          VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_SERIAL_RX } , PG_RX_CONFIG, offsetof(rxConfig_t, serialrx_provider)},
@@ -522,7 +548,11 @@ const clivalue_t valueTable[] = {
     { "min_command",                VAR_UINT16 | MASTER_VALUE, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, mincommand)},
     { "servo_center_pulse",         VAR_UINT16 | MASTER_VALUE, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, servoCenterPulse)},
     { "motor_pwm_rate",             VAR_UINT16 | MASTER_VALUE, .config.minmax = { 50,  32000 } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, motor_pwm_rate)},
-    { "servo_pwm_rate",             VAR_UINT16 | MASTER_VALUE, .config.minmax = { 50,  498 } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, servo_pwm_rate)},
+    { "servo_pwm_rate",             VAR_UINT16 | MASTER_VALUE, .config.minmax = { 50,  560 } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, servo_pwm_rate)},
+    { "esc_sensor_motor_poles",     VAR_UINT8  | MASTER_VALUE, .config.minmax = { 2,  254 } , PG_ESC_SENSOR_CONFIG, offsetof(escSensorConfig_t, motorPoles)},
+    { "motor_protocol",             VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_MOTOR_PROTOCOL } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, motor_protocol)},
+    { "thrust_linear",              VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  100 } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, thrust_linear)},
+    { "vbat_sag_compensation",      VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  100 } , PG_MOTOR_AND_SERVO_CONFIG, offsetof(motorAndServoConfig_t, vbat_sag_compensation)},
 
     { "retarded_arm",               VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON } , PG_ARMING_CONFIG, offsetof(armingConfig_t, retarded_arm)},
     { "disarm_kill_switch",         VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON } , PG_ARMING_CONFIG, offsetof(armingConfig_t, disarm_kill_switch)},
@@ -595,7 +625,13 @@ const clivalue_t valueTable[] = {
     { "max_angle_inclination",      VAR_UINT16 | MASTER_VALUE, .config.minmax = { 100,  900 } , PG_IMU_CONFIG, offsetof(imuConfig_t, max_angle_inclination) },
 
     { "gyro_lpf",                   VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_GYRO_LPF } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, gyro_lpf)},
+    { "gyro_fifo",                  VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, gyro_fifo)},
     { "gyro_soft_lpf",              VAR_UINT16 | MASTER_VALUE, .config.minmax = { 0,  500 } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, soft_gyro_lpf_hz)},
+#ifdef USE_RPM_FILTER
+    { "rpm_notch_harmonics",        VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  RPM_FILTER_HARMONICS_MAX } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, rpm_notch_harmonics)},
+    { "rpm_notch_min_hz",           VAR_UINT8  | MASTER_VALUE, .config.minmax = { 50,  200 } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, rpm_notch_min_hz)},
+    { "rpm_notch_q",                VAR_UINT16 | MASTER_VALUE, .config.minmax = { 100,  3000 } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, rpm_notch_q)},
+#endif
     { "moron_threshold",            VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  128 } , PG_GYRO_CONFIG, offsetof(gyroConfig_t, gyroMovementCalibrationThreshold)},
     { "imu_dcm_kp",                 VAR_UINT16 | MASTER_VALUE, .config.minmax = { 0,  20000 } , PG_IMU_CONFIG, offsetof(imuConfig_t, dcm_kp)},
     { "imu_dcm_ki",                 VAR_UINT16 | MASTER_VALUE, .config.minmax = { 0,  20000 } , PG_IMU_CONFIG, offsetof(imuConfig_t, dcm_ki)},
@@ -2058,6 +2094,16 @@ static void cliStatus(char *cmdline)
     #endif //USE_I2C
 
     cliPrintf("Cycle Time: %d, I2C Errors: %d, registry size: %d\r\n", cycleTime, i2cErrorCounter, PG_REGISTRY_SIZE); 
+
+    if (gyro.readBatch) {
+        cliPrintf("Gyro FIFO overruns: %d\r\n", gyroGetBatchOverrunCount());
+    }
+
+    #ifdef USE_DSHOT
+      if (pwmGetOutputConfiguration()->dshotServoConflict) {
+          cliPrint("DShot disabled, a servo in use shares a motor timer: motors use PWM\r\n");
+      }
+    #endif //USE_DSHOT
     UNUSED(cmdline);
 }
 
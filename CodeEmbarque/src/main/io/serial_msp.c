@@ -26,6 +26,7 @@
 
 #include "common/streambuf.h"
 #include "common/utils.h"
+#include "common/crc.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
@@ -103,18 +104,6 @@ void mspSerialInit(void)
     mspSerialAllocatePorts();
 }
 
-static uint8_t mspSerialChecksum(uint8_t checksum, uint8_t byte)
-{
-    return checksum ^ byte;
-}
-
-static uint8_t mspSerialChecksumBuf(uint8_t checksum, uint8_t *data, int len)
-{
-    while(len-- > 0)
-        checksum = mspSerialChecksum(checksum, *data++);
-    return checksum;
-}
-
 static void mspSerialResponse(mspPort_t *msp, mspPacket_t *reply)
 {
     serialBeginWrite(msp->port);
@@ -122,10 +111,10 @@ static void mspSerialResponse(mspPort_t *msp, mspPacket_t *reply)
     uint8_t hdr[] = {'$', 'M', reply->result < 0 ? '!' : '>', len, reply->cmd};
     uint8_t csum = 0;                                       // initial checksum value
     serialWriteBuf(msp->port, hdr, sizeof(hdr));
-    csum = mspSerialChecksumBuf(csum, hdr + 3, 2);          // checksum starts from len field
+    csum = checksumXor(csum, hdr + 3, 2);          // checksum starts from len field
     if(len > 0) {
         serialWriteBuf(msp->port, sbufPtr(&reply->buf), len);
-        csum = mspSerialChecksumBuf(csum, sbufPtr(&reply->buf), len);
+        csum = checksumXor(csum, sbufPtr(&reply->buf), len);
     }
     serialWrite(msp->port, csum);
     serialEndWrite(msp->port);
@@ -192,9 +181,9 @@ static bool mspSerialProcessReceivedByte(mspPort_t *msp, uint8_t c)
                 msp->inBuf[msp->offset++] = c;
             } else {
                 uint8_t checksum = 0;
-                checksum = mspSerialChecksum(checksum, msp->dataSize);
-                checksum = mspSerialChecksum(checksum, msp->cmdMSP);
-                checksum = mspSerialChecksumBuf(checksum, msp->inBuf, msp->dataSize);
+                checksum = checksumXorUpdate(checksum, msp->dataSize);
+                checksum = checksumXorUpdate(checksum, msp->cmdMSP);
+                checksum = checksumXor(checksum, msp->inBuf, msp->dataSize);
                 if(c == checksum)
                     msp->c_state = COMMAND_RECEIVED;
                 else
@@ -213,18 +202,23 @@ void mspSerialProcess(void)
             continue;
         }
 
-        while (serialRxBytesWaiting(msp->port)) {
-            uint8_t c = serialRead(msp->port);
-            bool consumed = mspSerialProcessReceivedByte(msp, c);
-
-            if (!consumed && !ARMING_FLAG(ARMED)) {
-                evaluateOtherData(msp->port, c);
-            }
-
-            if (msp->c_state == COMMAND_RECEIVED) {
-                mspSerialProcessReceivedCommand(msp);
-                break; // process one command at a time so as not to block and handle modal command immediately
+        // parse in place from the receive buffer
+        const volatile uint8_t *data;
+        uint32_t count;
+        while (msp->c_state != COMMAND_RECEIVED && (count = serialPeekRx(msp->port, &data)) > 0) {
+            uint32_t used = 0;
+            while (used < count && msp->c_state != COMMAND_RECEIVED) {
+                uint8_t c = data[used++];
+                bool consumed = mspSerialProcessReceivedByte(msp, c);
+
+                if (!consumed && !ARMING_FLAG(ARMED)) {
+                    evaluateOtherData(msp->port, c);
+                }
             }
+            serialConsumeRx(msp->port, used);
+        }
+        if (msp->c_state == COMMAND_RECEIVED) {
+            mspSerialProcessReceivedCommand(msp);  // process one command at a time so as not to block and handle modal command immediately
         }
 #ifdef USE_SERIAL_4WAY_BLHELI_INTERFACE
         if(mspEnterEsc4way) {
@@ -88,6 +88,8 @@
 #include "sensors/battery.h"
 #include "sensors/boardalignment.h"
 #include "sensors/initialisation.h"
+#include "sensors/esc_sensor.h"
+#include "sensors/rpm_filter.h"
 
 #include "telemetry/telemetry.h"
 #include "blackbox/blackbox.h"
@@ -338,6 +340,15 @@ void init(void)
     //Initialisation TIMER
     timerInit();  // timer must be initialized before any channel is allocated
 
+    //Base de temps micros() sur timer materiel, uniquement si ses canaux ne servent pas d'entrees RC
+    //Avec la config par defaut (RX_PARALLEL_PWM) TIM2 lit RC_CH1-4 : micros() reste alors sur la SysTick,
+    //la base materielle ne sert qu'avec un recepteur serie ou MSP (aucun autre timer 32 bits sur le F303)
+    #ifdef USE_HARDWARE_TIMEBASE
+        if (!feature(FEATURE_RX_PARALLEL_PWM) && !feature(FEATURE_RX_PPM)) {
+            timebaseInit();
+        }
+    #endif //USE_HARDWARE_TIMEBASE
+
     //Initialisation DMA
     dmaInit();
 
@@ -397,6 +408,7 @@ void init(void)
     pwm_params.servoPwmRate         = motorAndServoConfig()->servo_pwm_rate;
     // -- Configuration PWM : Fonctionnalités MOTORS
     pwm_params.useOneshot           = feature(FEATURE_ONESHOT125);
+    pwm_params.motorProtocol        = motorAndServoConfig()->motor_protocol;
     pwm_params.motorPwmRate         = motorAndServoConfig()->motor_pwm_rate;
     pwm_params.idlePulse            = motorAndServoConfig()->mincommand;
     if (pwm_params.motorPwmRate > 500){
@@ -479,7 +491,8 @@ void init(void)
     gyroSetSampleRate(imuConfig()->looptime,
                       gyroConfig()->gyro_lpf,
                       imuConfig()->gyroSync,
-                      imuConfig()->gyroSyncDenominator);
+                      imuConfig()->gyroSyncDenominator,
+                      gyroConfig()->gyro_fifo);
 
     //Verification présence IMU
     if (!sensorsAutodetect()) {
@@ -559,6 +572,18 @@ void init(void)
         }
     #endif //TELEMETRY
 
+    //Initialisation telemetrie ESC, les demandes passent par les trames DShot
+    #ifdef USE_ESC_SENSOR
+        if (feature(FEATURE_ESC_SENSOR)) {
+            escSensorInit();
+        }
+    #endif //USE_ESC_SENSOR
+
+    //Initialisation des filtres coupe-bande sur le regime moteur, la periode gyro est connue depuis sensorsAutodetect
+    #ifdef USE_RPM_FILTER
+        rpmFilterInit(gyroSamplePeriod);
+    #endif //USE_RPM_FILTER
+
     //Initialisation TRANSPONDEUR
     #ifdef TRANSPONDER
         if (feature(FEATURE_TRANSPONDER)) {
@@ -665,7 +690,7 @@ void init(void)
 #ifdef SOFTSERIAL_LOOPBACK
     void processLoopback(void) {
         if (loopbackPort) {
-            uint8_t bytesWaiting;
+            uint32_t bytesWaiting;
             while ((bytesWaiting = serialRxBytesWaiting(loopbackPort))) {
                 uint8_t b = serialRead(loopbackPort);
                 serialWrite(loopbackPort, b);
@@ -724,6 +749,9 @@ int main(void) {
     #ifdef TRANSPONDER
         setTaskEnabled(TASK_TRANSPONDER, feature(FEATURE_TRANSPONDER));
     #endif //TRANSPONDER
+    #ifdef USE_ESC_SENSOR
+        setTaskEnabled(TASK_ESC_SENSOR, isEscSensorActive());
+    #endif //USE_ESC_SENSOR
 
     //Boucle systeme
     // 1 - MAJ SCHELUDER
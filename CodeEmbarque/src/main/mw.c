@@ -41,6 +41,7 @@
 #include "drivers/system.h"
 #include "drivers/serial.h"
 #include "drivers/gyro_sync.h"
+#include "drivers/pwm_output.h"
 
 #include "io/rc_controls.h"
 #include "io/rate_profile.h"
@@ -52,6 +53,7 @@
 #include "sensors/acceleration.h"
 #include "sensors/gyro.h"
 #include "sensors/battery.h"
+#include "sensors/esc_sensor.h"
 
 #include "io/beeper.h"
 #include "io/display.h"
@@ -70,6 +72,7 @@
 #include "rx/msp.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/mavlink.h"
 #include "blackbox/blackbox.h"
 
 #include "flight/mixer.h"
@@ -80,6 +83,7 @@
 #include "flight/failsafe.h"
 #include "flight/gtune.h"
 #include "flight/navigation.h"
+#include "flight/offboard.h"
 
 #include "config/runtime_config.h"
 #include "config/config.h"
@@ -166,14 +170,18 @@ bool isCalibrating(void)
     return (!isAccelerationCalibrationComplete() && sensors(SENSOR_ACC)) || (!isGyroCalibrationComplete());
 }
 
+// rcCommand[] shaped from the last RX frame, copied to rcCommand[] each PID cycle
+static int16_t rcSetpoint[4];
+static bool haveRcSetpoint = false;
+
 /*
 This function processes RX dependent coefficients when new RX commands are available
-Those are: TPA, throttle expo
+Those are: TPA, throttle expo, deadbands, HEADFREE rotation (with the attitude at the frame)
 */
-static void updateRcCommands(void)
+static void updateRcSetpoint(void)
 {
 
-    int32_t tmp, tmp2;
+    int32_t tmp;
     int32_t axis, prop1 = 0, prop2;
 
     // PITCH & ROLL only dynamic PID adjustment,  depending on throttle value
@@ -198,8 +206,7 @@ static void updateRcCommands(void)
                 }
             }
 
-            tmp2 = tmp / 100;
-            rcCommand[axis] = lookupPitchRollRC[tmp2] + (tmp - tmp2 * 100) * (lookupPitchRollRC[tmp2 + 1] - lookupPitchRollRC[tmp2]) / 100;
+            rcSetpoint[axis] = lrintf(rcCurveLookup(&pitchRollCurve, tmp));
             prop1 = 100 - (uint16_t)currentControlRateProfile->rates[axis] * tmp / 500;
             prop1 = (uint16_t)prop1 * prop2 / 100;
         } else if (axis == YAW) {
@@ -210,8 +217,7 @@ static void updateRcCommands(void)
                     tmp = 0;
                 }
             }
-            tmp2 = tmp / 100;
-            rcCommand[axis] = (lookupYawRC[tmp2] + (tmp - tmp2 * 100) * (lookupYawRC[tmp2 + 1] - lookupYawRC[tmp2]) / 100) * -rcControlsConfig()->yaw_control_direction;
+            rcSetpoint[axis] = lrintf(rcCurveLookup(&yawCurve, tmp)) * -rcControlsConfig()->yaw_control_direction;
             prop1 = 100 - (uint16_t)currentControlRateProfile->rates[axis] * ABS(tmp) / 500;
         }
 #ifndef SKIP_PID_MW23
@@ -229,21 +235,34 @@ static void updateRcCommands(void)
         }
 
         if (rcData[axis] < rxConfig()->midrc)
-            rcCommand[axis] = -rcCommand[axis];
+            rcSetpoint[axis] = -rcSetpoint[axis];
     }
 
     tmp = constrain(rcData[THROTTLE], rxConfig()->mincheck, PWM_RANGE_MAX);
     tmp = (uint32_t)(tmp - rxConfig()->mincheck) * PWM_RANGE_MIN / (PWM_RANGE_MAX - rxConfig()->mincheck);       // [MINCHECK;2000] -> [0;1000]
-    tmp2 = tmp / 100;
-    rcCommand[THROTTLE] = lookupThrottleRC[tmp2] + (tmp - tmp2 * 100) * (lookupThrottleRC[tmp2 + 1] - lookupThrottleRC[tmp2]) / 100;    // [0;1000] -> expo -> [MINTHROTTLE;MAXTHROTTLE]
+    rcSetpoint[THROTTLE] = lrintf(rcCurveLookup(&throttleCurve, tmp));    // [0;1000] -> expo -> [MINTHROTTLE;MAXTHROTTLE]
 
     if (FLIGHT_MODE(HEADFREE_MODE)) {
         float radDiff = degreesToRadians(DECIDEGREES_TO_DEGREES(attitude.values.yaw) - headFreeModeHold);
         float cosDiff = cos_approx(radDiff);
         float sinDiff = sin_approx(radDiff);
-        int16_t rcCommand_PITCH = rcCommand[PITCH] * cosDiff + rcCommand[ROLL] * sinDiff;
-        rcCommand[ROLL] = rcCommand[ROLL] * cosDiff - rcCommand[PITCH] * sinDiff;
-        rcCommand[PITCH] = rcCommand_PITCH;
+        int16_t rcSetpoint_PITCH = rcSetpoint[PITCH] * cosDiff + rcSetpoint[ROLL] * sinDiff;
+        rcSetpoint[ROLL] = rcSetpoint[ROLL] * cosDiff - rcSetpoint[PITCH] * sinDiff;
+        rcSetpoint[PITCH] = rcSetpoint_PITCH;
+    }
+
+    haveRcSetpoint = true;
+}
+
+// rcCommand[] is adjusted downstream each cycle, restart from the cached setpoint
+static void updateRcCommands(void)
+{
+    if (isRXDataNew || !haveRcSetpoint) {
+        updateRcSetpoint();
+    }
+
+    for (int axis = 0; axis < 4; axis++) {
+        rcCommand[axis] = rcSetpoint[axis];
     }
 }
 
@@ -584,36 +603,93 @@ void processRx(void)
 
 }
 
-void filterRc(void){
-    static int16_t lastCommand[4] = { 0, 0, 0, 0 };
-    static int16_t deltaRC[4] = { 0, 0, 0, 0 };
-    static int16_t factor, rcInterpolationFactor;
-    uint16_t rxRefreshRate;
+// accepted range of a measured RC frame interval
+#define RC_FRAME_INTERVAL_MIN_US 1000
+#define RC_FRAME_INTERVAL_MAX_US 100000
+// weight of a new interval in the running estimate
+#define RC_FRAME_INTERVAL_GAIN 0.1f
 
-    // Set RC refresh rate for sampling and channels to filter
-    initRxRefreshRate(&rxRefreshRate);
+/*
+ * Smooths rcCommand[] between RC frames, based on the frame times reported by
+ * the receiver and a running estimate of the frame interval.  Dropped frames
+ * show as a multiple of the interval and do not disturb the estimate, the
+ * output holds at the end of an interval until the next frame.
+ *
+ * The estimate starts from the first measured interval rather than the
+ * protocol refresh rate: an estimate that is too high comes back down since
+ * every interval then rounds to one frame, one that is too low would lock on
+ * a fraction of the real interval.
+ */
+void filterRc(void)
+{
+    static float frameIntervalUs = 0;
+    static uint32_t lastFrameAt;
+    static bool haveFrame = false;
+    static bool haveInterval = false;
+    static float rcFrom[4], rcTarget[4], rcSlope[4], rcOut[4];
+
+    if (frameIntervalUs == 0) {
+        uint16_t rxRefreshRate;
+        initRxRefreshRate(&rxRefreshRate);
+        frameIntervalUs = rxRefreshRate;
+    }
+
+    uint32_t frameAt = rxRuntimeConfig.frameTimeUs;
+    int32_t frameDelta = cmp32(frameAt, lastFrameAt);
+
+    if (isRXDataNew && haveFrame && frameDelta <= 0) {
+        // 50Hz run without a new frame, only follow the commands that changed without one (failsafe)
+        for (int channel = 0; channel < 4; channel++) {
+            if (rcCommand[channel] != rcTarget[channel]) {
+                rcFrom[channel] = rcOut[channel];
+                rcTarget[channel] = rcCommand[channel];
+                rcSlope[channel] = 0.0f;
+            }
+        }
+    } else if (isRXDataNew) {
+        bool haveDelta = haveFrame && frameDelta >= RC_FRAME_INTERVAL_MIN_US && frameDelta <= RC_FRAME_INTERVAL_MAX_US;
 
-    rcInterpolationFactor = rxRefreshRate / filteredCycleTime + 1;
+        if (haveDelta && !haveInterval) {
+            frameIntervalUs = frameDelta;
+            haveInterval = true;
+        } else if (haveDelta) {
+            int frames = MAX(lrintf(frameDelta / frameIntervalUs), 1);
+            frameIntervalUs += RC_FRAME_INTERVAL_GAIN * ((float)frameDelta / frames - frameIntervalUs);
+        }
 
-    if (isRXDataNew) {
-        for (int channel=0; channel < 4; channel++) {
-            deltaRC[channel] = rcCommand[channel] -  (lastCommand[channel] - deltaRC[channel] * factor / rcInterpolationFactor);
-            lastCommand[channel] = rcCommand[channel];
+        for (int channel = 0; channel < 4; channel++) {
+            rcFrom[channel] = haveFrame ? rcOut[channel] : rcCommand[channel];
+            rcOut[channel] = rcFrom[channel];
+            rcSlope[channel] = haveDelta ? (rcCommand[channel] - rcTarget[channel]) / frameDelta : 0.0f;
+            rcTarget[channel] = rcCommand[channel];
         }
 
-        isRXDataNew = false;
-        factor = rcInterpolationFactor - 1;
-    } else {
-        factor--;
+        lastFrameAt = frameAt;
+        haveFrame = true;
     }
 
-    // Interpolate steps of rcCommand
-    if (factor > 0) {
-        for (int channel=0; channel < 4; channel++) {
-            rcCommand[channel] = lastCommand[channel] - deltaRC[channel] * factor/rcInterpolationFactor;
-         }
-    } else {
-        factor = 0;
+    if (!haveFrame) {
+        return;
+    }
+
+    float sinceFrameUs = constrainf(cmp32(currentTime, lastFrameAt), 0.0f, frameIntervalUs);
+    // time constant of half a frame interval
+    float pt1Gain = cycleTime / (frameIntervalUs / 2 + cycleTime);
+
+    for (int channel = 0; channel < 4; channel++) {
+        switch (rxConfig()->rcSmoothing) {
+            case RC_SMOOTHING_INTERPOLATE:
+            default:
+                rcOut[channel] = rcFrom[channel] + (rcTarget[channel] - rcFrom[channel]) * sinceFrameUs / frameIntervalUs;
+                break;
+            case RC_SMOOTHING_PT1:
+                rcOut[channel] += (rcTarget[channel] - rcOut[channel]) * pt1Gain;
+                break;
+            case RC_SMOOTHING_FEEDFORWARD:
+                rcOut[channel] = rcTarget[channel] + rcSlope[channel] * sinceFrameUs;
+                break;
+        }
+        rcCommand[channel] = lrintf(rcOut[channel]);
     }
 }
 
@@ -639,6 +715,7 @@ void taskMainPidLoop(void)
     if (rxConfig()->rcSmoothing) {
         filterRc();
     }
+    isRXDataNew = false;
 
 #if defined(BARO) || defined(SONAR)
     haveUpdatedRcCommandsOnce = true;
@@ -687,6 +764,17 @@ void taskMainPidLoop(void)
     }
 #endif
 
+#ifdef TELEMETRY
+    // MAVLink setpoints are read here rather than in the telemetry task, so that this loop uses them
+    if (!cliMode && feature(FEATURE_TELEMETRY)) {
+        handleMAVLinkSetpoints();
+    }
+#endif
+
+    // fresh offboard setpoints take over from the sticks, after alt hold and the throttle correction
+    offboardUpdate(micros());
+    offboardApplyThrottle();
+
     // PID - note this is function pointer set by setPIDController()
     pid_controller(
         pidProfile(),
@@ -698,6 +786,9 @@ void taskMainPidLoop(void)
 
     mixTable();
     filterServos();
+
+    // servos and motors are written together and latched on the same timer updates, see writeMotors()
+    pwmStartOutputUpdate();
     writeServos();
 
     //if (motorControlEnable) {
@@ -901,3 +992,10 @@ void taskTransponder(void)
     }
 }
 #endif
+
+#ifdef USE_ESC_SENSOR
+void taskEscSensor(void)
+{
+    escSensorProcess(currentTime);
+}
+#endif
@@ -0,0 +1,268 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Driver for CRSF (TBS Crossfire) receivers.
+ *
+ * Frame: address, length, type, payload, CRC8 (DVB-S2) of type and payload.
+ * The length counts the type, the payload and the CRC.
+ *
+ * RC channels frames come every 6.67ms (150Hz) and link statistics frames are
+ * interleaved.  The link is half duplex on one wire, telemetry replies are sent
+ * right after an RC channels frame.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <platform.h>
+
+#include "build_config.h"
+
+#include "common/crc.h"
+
+#include "config/parameter_group.h"
+
+#include "drivers/system.h"
+
+#include "drivers/serial.h"
+#include "drivers/serial_uart.h"
+#include "io/serial.h"
+
+#include "rx/rx.h"
+#include "rx/crsf.h"
+
+#define CRSF_MAX_CHANNEL 16
+
+// start, 8 data and 1 stop bits at 420000 baud
+#define CRSF_TIME_PER_BYTE 24
+#define CRSF_TIME_NEEDED_PER_FRAME (CRSF_FRAME_SIZE_MAX * CRSF_TIME_PER_BYTE)
+
+#define CRSF_PORT_OPTIONS (SERIAL_STOPBITS_1 | SERIAL_PARITY_NO | SERIAL_BIDIR)
+
+#define CRSF_ADDRESS_BROADCAST          0x00
+#define CRSF_ADDRESS_FLIGHT_CONTROLLER  0xC8
+#define CRSF_ADDRESS_RADIO_TRANSMITTER  0xEA
+
+#define CRSF_FRAMETYPE_LINK_STATISTICS  0x14
+#define CRSF_FRAMETYPE_RC_CHANNELS      0x16
+
+#define CRSF_FRAME_LENGTH_MIN           2       // type and CRC
+#define CRSF_FRAME_HEADER_SIZE          2       // address and length
+#define CRSF_FRAME_PAYLOAD_SIZE_MAX     (CRSF_FRAME_SIZE_MAX - CRSF_FRAME_HEADER_SIZE - CRSF_FRAME_LENGTH_MIN)
+
+#define CRSF_RC_CHANNELS_PAYLOAD_SIZE   22      // 16 channels * 11 bits
+#define CRSF_LINK_STATISTICS_PAYLOAD_SIZE 10
+
+#define CRSF_CHANNEL_BITS 11
+#define CRSF_CHANNEL_MASK ((1 << CRSF_CHANNEL_BITS) - 1)
+
+// 172 -> 988us, 992 -> 1500us, 1811 -> 2012us
+#define CRSF_SCALE_CHANNEL(value) ((((int32_t)(value) - 992) * 5) / 8 + 1500)
+
+static volatile bool crsfFrameDone = false;
+static void crsfDataReceive(const volatile uint8_t *data, uint16_t count, uint32_t firstByteTime);
+static uint16_t crsfReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
+
+// scaled to [1000;2000], published to rx.c as a complete frame
+static uint16_t crsfChannelData[CRSF_MAX_CHANNEL];
+
+// the ISR fills one payload while the other, complete one is decoded
+static uint8_t crsfChannelPayloads[2][CRSF_RC_CHANNELS_PAYLOAD_SIZE];
+static volatile uint8_t crsfReadyPayloadIndex = 0;
+static volatile uint32_t crsfFrameEndAt = 0;
+
+static crsfLinkStatistics_t crsfLinkStatistics;
+static volatile bool crsfHaveLinkStatistics = false;
+
+static serialPort_t *crsfPort = NULL;
+
+static uint8_t crsfTelemetryFrame[CRSF_FRAME_SIZE_MAX];
+static uint8_t crsfTelemetryFrameSize = 0;
+
+static uint8_t crsfFrameCrc(const uint8_t *frame)
+{
+    // the CRC covers the type and the payload
+    return crc8DvbS2(0, &frame[CRSF_FRAME_HEADER_SIZE], frame[1] - 1);
+}
+
+bool crsfInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
+{
+    for (int i = 0; i < CRSF_MAX_CHANNEL; i++) {
+        crsfChannelData[i] = rxConfig()->midrc;
+    }
+    if (callback)
+        *callback = crsfReadRawRC;
+    rxRuntimeConfig->channelCount = CRSF_MAX_CHANNEL;
+    rxRuntimeConfig->channelData = crsfChannelData;
+
+    serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
+    if (!portConfig) {
+        return false;
+    }
+    crsfPort = openSerialPort(portConfig->identifier, FUNCTION_RX_SERIAL, NULL, CRSF_BAUDRATE, MODE_RXTX, CRSF_PORT_OPTIONS);
+    if (!crsfPort) {
+        return false;
+    }
+    serialSetReceiveBurstCallback(crsfPort, crsfDataReceive);
+
+    return true;
+}
+
+static void crsfHandleFrame(const uint8_t *frame, uint32_t frameEndAt)
+{
+    const uint8_t *payload = &frame[CRSF_FRAME_HEADER_SIZE + 1];
+    uint8_t payloadLength = frame[1] - CRSF_FRAME_LENGTH_MIN;
+
+    switch (frame[CRSF_FRAME_HEADER_SIZE]) {
+        case CRSF_FRAMETYPE_RC_CHANNELS:
+            if (payloadLength == CRSF_RC_CHANNELS_PAYLOAD_SIZE) {
+                uint8_t fillIndex = crsfReadyPayloadIndex ^ 1;
+                memcpy(crsfChannelPayloads[fillIndex], payload, CRSF_RC_CHANNELS_PAYLOAD_SIZE);
+                crsfFrameEndAt = frameEndAt;
+                crsfReadyPayloadIndex = fillIndex;
+                crsfFrameDone = true;
+            }
+            break;
+        case CRSF_FRAMETYPE_LINK_STATISTICS:
+            if (payloadLength == CRSF_LINK_STATISTICS_PAYLOAD_SIZE) {
+                crsfLinkStatistics.uplinkRssiAnt1 = payload[0];
+                crsfLinkStatistics.uplinkRssiAnt2 = payload[1];
+                crsfLinkStatistics.uplinkLinkQuality = payload[2];
+                crsfLinkStatistics.uplinkSnr = (int8_t)payload[3];
+                crsfLinkStatistics.activeAntenna = payload[4];
+                crsfLinkStatistics.rfMode = payload[5];
+                crsfLinkStatistics.uplinkTxPower = payload[6];
+                crsfLinkStatistics.downlinkRssi = payload[7];
+                crsfLinkStatistics.downlinkLinkQuality = payload[8];
+                crsfLinkStatistics.downlinkSnr = (int8_t)payload[9];
+                crsfHaveLinkStatistics = true;
+            }
+            break;
+        default:
+            // includes the echo of our own telemetry on the half duplex wire
+            break;
+    }
+}
+
+// Receive ISR callback, a burst is a run of back to back bytes
+static void crsfDataReceive(const volatile uint8_t *data, uint16_t count, uint32_t firstByteTime)
+{
+    static uint8_t crsfFrame[CRSF_FRAME_SIZE_MAX];
+    static uint8_t crsfFramePosition = 0;
+    static uint32_t crsfFrameStartAt = 0;
+
+    if ((int32_t)(firstByteTime - crsfFrameStartAt) > CRSF_TIME_NEEDED_PER_FRAME) {
+        crsfFramePosition = 0;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t c = data[i];
+
+        if (crsfFramePosition == 0) {
+            crsfFrameStartAt = firstByteTime + i * CRSF_TIME_PER_BYTE;
+        }
+
+        crsfFrame[crsfFramePosition++] = c;
+
+        if (crsfFramePosition == CRSF_FRAME_HEADER_SIZE
+            && (c < CRSF_FRAME_LENGTH_MIN || c > CRSF_FRAME_SIZE_MAX - CRSF_FRAME_HEADER_SIZE)) {
+            // not a length, resynchronise on the next byte
+            crsfFramePosition = 0;
+            continue;
+        }
+
+        if (crsfFramePosition > CRSF_FRAME_HEADER_SIZE && crsfFramePosition == crsfFrame[1] + CRSF_FRAME_HEADER_SIZE) {
+            if (crsfFrameCrc(crsfFrame) == crsfFrame[crsfFramePosition - 1]) {
+                crsfHandleFrame(crsfFrame, firstByteTime + (i + 1) * CRSF_TIME_PER_BYTE);
+            }
+            crsfFramePosition = 0;
+        }
+    }
+}
+
+static void crsfDecodeChannels(const uint8_t *payload)
+{
+    uint32_t bits = 0;
+    uint8_t bitCount = 0;
+
+    for (int chan = 0; chan < CRSF_MAX_CHANNEL; chan++) {
+        while (bitCount < CRSF_CHANNEL_BITS) {
+            bits |= (uint32_t)*payload++ << bitCount;
+            bitCount += 8;
+        }
+        crsfChannelData[chan] = CRSF_SCALE_CHANNEL(bits & CRSF_CHANNEL_MASK);
+        bits >>= CRSF_CHANNEL_BITS;
+        bitCount -= CRSF_CHANNEL_BITS;
+    }
+}
+
+static void crsfSendTelemetryFrame(void)
+{
+    if (crsfTelemetryFrameSize == 0 || serialTxBytesFree(crsfPort) < crsfTelemetryFrameSize) {
+        return;
+    }
+    serialWriteBuf(crsfPort, crsfTelemetryFrame, crsfTelemetryFrameSize);
+    crsfTelemetryFrameSize = 0;
+}
+
+uint8_t crsfFrameStatus(void)
+{
+    if (!crsfFrameDone) {
+        return SERIAL_RX_FRAME_PENDING;
+    }
+    crsfFrameDone = false;
+
+    crsfDecodeChannels(crsfChannelPayloads[crsfReadyPayloadIndex]);
+    rxRuntimeConfig.frameTimeUs = crsfFrameEndAt;
+
+    // the receiver listens right after sending its RC frame
+    crsfSendTelemetryFrame();
+
+    return SERIAL_RX_FRAME_COMPLETE;
+}
+
+const crsfLinkStatistics_t *crsfGetLinkStatistics(void)
+{
+    return crsfHaveLinkStatistics ? &crsfLinkStatistics : NULL;
+}
+
+bool crsfWriteTelemetryFrame(uint8_t frameType, const uint8_t *payload, uint8_t payloadLength)
+{
+    if (!crsfPort || payloadLength > CRSF_FRAME_PAYLOAD_SIZE_MAX) {
+        return false;
+    }
+
+    uint8_t *frame = crsfTelemetryFrame;
+    frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    frame[1] = payloadLength + CRSF_FRAME_LENGTH_MIN;
+    frame[2] = frameType;
+    memcpy(&frame[3], payload, payloadLength);
+    frame[payloadLength + 3] = crsfFrameCrc(frame);
+    crsfTelemetryFrameSize = payloadLength + CRSF_FRAME_HEADER_SIZE + CRSF_FRAME_LENGTH_MIN;
+
+    return true;
+}
+
+static uint16_t crsfReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
+{
+    UNUSED(rxRuntimeConfig);
+    return crsfChannelData[chan];
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#define CRSF_BAUDRATE           420000
+
+#define CRSF_FRAME_SIZE_MAX     64      // address and length bytes included
+
+typedef struct crsfLinkStatistics_s {
+    uint8_t uplinkRssiAnt1;             // dBm * -1
+    uint8_t uplinkRssiAnt2;             // dBm * -1
+    uint8_t uplinkLinkQuality;          // percentage of received packets
+    int8_t  uplinkSnr;                  // dB
+    uint8_t activeAntenna;
+    uint8_t rfMode;
+    uint8_t uplinkTxPower;
+    uint8_t downlinkRssi;               // dBm * -1
+    uint8_t downlinkLinkQuality;
+    int8_t  downlinkSnr;
+} crsfLinkStatistics_t;
+
+uint8_t crsfFrameStatus(void);
+bool crsfInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback);
+
+// NULL until a link statistics frame has been received
+const crsfLinkStatistics_t *crsfGetLinkStatistics(void);
+
+// queues a telemetry frame, sent on the wire after the next RC channels frame
+bool crsfWriteTelemetryFrame(uint8_t frameType, const uint8_t *payload, uint8_t payloadLength);
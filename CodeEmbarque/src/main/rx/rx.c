@@ -56,6 +56,7 @@
 #include "rx/msp.h"
 #include "rx/xbus.h"
 #include "rx/ibus.h"
+#include "rx/crsf.h"
 
 #include "rx/rx.h"
 
@@ -264,11 +265,16 @@ void serialRxInit(rxConfig_t *rxConfig)
         case SERIALRX_IBUS:
             enabled = ibusInit(&rxRuntimeConfig, &rcReadRawFunc);
             break;
+        case SERIALRX_CRSF:
+            rxRefreshRate = 6667;
+            enabled = crsfInit(&rxRuntimeConfig, &rcReadRawFunc);
+            break;
     }
 
     if (!enabled) {
         featureClear(FEATURE_RX_SERIAL);
         rcReadRawFunc = nullReadRawRC;
+        rxRuntimeConfig.channelData = NULL;
     }
 }
 
@@ -298,6 +304,8 @@ uint8_t serialRxFrameStatus(void)
             return xBusFrameStatus();
         case SERIALRX_IBUS:
             return ibusFrameStatus();
+        case SERIALRX_CRSF:
+            return crsfFrameStatus();
     }
     return SERIAL_RX_FRAME_PENDING;
 }
@@ -366,6 +374,9 @@ void updateRx(uint32_t currentTime)
 
         if (frameStatus & SERIAL_RX_FRAME_COMPLETE) {
             rxDataReceived = true;
+            if (!rxRuntimeConfig.channelData) {
+                rxRuntimeConfig.frameTimeUs = currentTime;
+            }
             rxIsInFailsafeMode = (frameStatus & SERIAL_RX_FRAME_FAILSAFE) != 0;
             rxSignalReceived = !rxIsInFailsafeMode;
             needRxSignalBefore = currentTime + DELAY_10_HZ;
@@ -380,6 +391,7 @@ void updateRx(uint32_t currentTime)
             rxSignalReceived = true;
             rxIsInFailsafeMode = false;
             needRxSignalBefore = currentTime + DELAY_5_HZ;
+            rxRuntimeConfig.frameTimeUs = currentTime;
         }
     }
 
@@ -485,13 +497,15 @@ STATIC_UNIT_TESTED uint16_t applyRxChannelRangeConfiguraton(int sample, rxChanne
 static void readRxChannelsApplyRanges(void)
 {
     uint8_t channel;
+    // drivers decoding whole frames publish them, the snapshot is taken from a single frame
+    const uint16_t *channelData = rxRuntimeConfig.channelData;
 
     for (channel = 0; channel < rxRuntimeConfig.channelCount; channel++) {
 
         uint8_t rawChannel = calculateChannelRemapping(rxConfig()->rcmap, ARRAYLEN(rxConfig()->rcmap), channel);
 
         // sample the channel
-        uint16_t sample = rcReadRawFunc(&rxRuntimeConfig, rawChannel);
+        uint16_t sample = channelData ? channelData[rawChannel] : rcReadRawFunc(&rxRuntimeConfig, rawChannel);
 
         // apply the rx calibration
         if (channel < NON_AUX_CHANNEL_COUNT) {
@@ -581,6 +595,11 @@ void calculateRxChannelsAndUpdateFailsafe(uint32_t currentTime)
         return;
     }
 
+    if (!isRxDataDriven()) {
+        // PPM and PWM are sampled, the sample time stands for the frame time
+        rxRuntimeConfig.frameTimeUs = currentTime;
+    }
+
     readRxChannelsApplyRanges();
     detectAndApplySignalLossBehaviour();
 
@@ -613,16 +632,11 @@ void updateRSSIPWM(void)
     rssi = (uint16_t)((constrain(pwmRssi - 1000, 0, 1000) / 1000.0f) * 1023.0f);
 }
 
-#define RSSI_ADC_SAMPLE_COUNT 16
-//#define RSSI_SCALE (0xFFF / 100.0f)
-
 void updateRSSIADC(uint32_t currentTime)
 {
 #ifndef USE_ADC
     UNUSED(currentTime);
 #else
-    static uint8_t adcRssiSamples[RSSI_ADC_SAMPLE_COUNT];
-    static uint8_t adcRssiSampleIndex = 0;
     static uint32_t rssiUpdateAt = 0;
 
     if ((int32_t)(currentTime - rssiUpdateAt) < 0) {
@@ -630,31 +644,40 @@ void updateRSSIADC(uint32_t currentTime)
     }
     rssiUpdateAt = currentTime + DELAY_50_HZ;
 
-    int16_t adcRssiMean = 0;
-    uint16_t adcRssiSample = adcGetChannel(ADC_RSSI);
-    uint8_t rssiPercentage = adcRssiSample / rxConfig()->rssi_scale;
+    // the ADC driver averages the samples of each DMA block
+    int16_t rssiPercentage = adcGetChannel(ADC_RSSI) / rxConfig()->rssi_scale;
 
-    adcRssiSampleIndex = (adcRssiSampleIndex + 1) % RSSI_ADC_SAMPLE_COUNT;
-
-    adcRssiSamples[adcRssiSampleIndex] = rssiPercentage;
-
-    uint8_t sampleIndex;
+    rssi = (uint16_t)((constrain(rssiPercentage, 0, 100) / 100.0f) * 1023.0f);
+#endif
+}
 
-    for (sampleIndex = 0; sampleIndex < RSSI_ADC_SAMPLE_COUNT; sampleIndex++) {
-        adcRssiMean += adcRssiSamples[sampleIndex];
+#ifdef SERIAL_RX
+// CRSF reports the uplink quality, rssi follows the link quality percentage
+static bool updateRSSICrsf(void)
+{
+    if (!feature(FEATURE_RX_SERIAL) || rxConfig()->serialrx_provider != SERIALRX_CRSF) {
+        return false;
     }
 
-    adcRssiMean = adcRssiMean / RSSI_ADC_SAMPLE_COUNT;
+    const crsfLinkStatistics_t *linkStatistics = crsfGetLinkStatistics();
+    if (!linkStatistics) {
+        return false;
+    }
 
-    rssi = (uint16_t)((constrain(adcRssiMean, 0, 100) / 100.0f) * 1023.0f);
-#endif
+    rssi = (constrain(linkStatistics->uplinkLinkQuality, 0, 100) * 1023) / 100;
+    return true;
 }
+#endif
 
 void updateRSSI(uint32_t currentTime)
 {
 
     if (rxConfig()->rssi_channel > 0) {
         updateRSSIPWM();
+#ifdef SERIAL_RX
+    } else if (updateRSSICrsf()) {
+        return;
+#endif
     } else if (feature(FEATURE_RSSI_ADC)) {
         updateRSSIADC(currentTime);
     }
@@ -51,6 +51,15 @@ typedef enum {
     SERIAL_RX_FRAME_FAILSAFE = (1 << 1)
 } serialrxFrameState_t;
 
+// -- RC SMOOTHING
+
+typedef enum {
+    RC_SMOOTHING_OFF         = 0,
+    RC_SMOOTHING_INTERPOLATE = 1,            // ramp to the new frame over one frame interval
+    RC_SMOOTHING_PT1         = 2,            // first order low pass with a time constant of half a frame interval
+    RC_SMOOTHING_FEEDFORWARD = 3             // extrapolate the slope of the last two frames, up to one frame interval
+} rcSmoothing_e;
+
 // -- RX SERIAL
 
 typedef enum {
@@ -62,7 +71,8 @@ typedef enum {
     SERIALRX_XBUS_MODE_B      = 5,
     SERIALRX_XBUS_MODE_B_RJ01 = 6,
     SERIALRX_IBUS             = 7,
-    SERIALRX_PROVIDER_MAX     = SERIALRX_IBUS
+    SERIALRX_CRSF             = 8,
+    SERIALRX_PROVIDER_MAX     = SERIALRX_CRSF
 } SerialRXType;
 
 #define SERIALRX_PROVIDER_COUNT                     (SERIALRX_PROVIDER_MAX + 1)
@@ -128,7 +138,7 @@ typedef struct rxConfig_s {
     uint8_t  rssi_channel;
     uint8_t  rssi_scale;
     uint8_t  rssi_ppm_invert;
-    uint8_t  rcSmoothing;                    // Enable/Disable RC filtering
+    uint8_t  rcSmoothing;                    // RC smoothing between frames, see rcSmoothing_e
     uint16_t midrc;                          // Some radios have not a neutral point centered on 1500. can be changed here
     uint16_t mincheck;                       // minimum rc end
     uint16_t maxcheck;                       // maximum rc end
@@ -138,6 +148,8 @@ typedef struct rxConfig_s {
 
 typedef struct rxRuntimeConfig_s {
     uint8_t channelCount;                    // number of rc channels as reported by current input driver
+    const uint16_t *channelData;             // complete frame of scaled channels published by the driver, NULL to read channels one by one
+    uint32_t frameTimeUs;                    // end of the last complete frame, set by drivers that publish channelData, else by rx.c on reception
 } rxRuntimeConfig_t;
 
 // VARIABLES EXTERNES -------------------------------------------------------------
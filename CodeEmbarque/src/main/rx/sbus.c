@@ -50,6 +50,8 @@
  */
 
 #define SBUS_TIME_NEEDED_PER_FRAME 3000
+// start, 8 data, parity and 2 stop bits at 100000 baud
+#define SBUS_TIME_PER_BYTE 120
 
 #ifndef CJMCU
 //#define DEBUG_SBUS_PACKETS
@@ -74,29 +76,35 @@ static uint16_t sbusStateFlags = 0;
 #define SBUS_DIGITAL_CHANNEL_MIN 173
 #define SBUS_DIGITAL_CHANNEL_MAX 1812
 
-static bool sbusFrameDone = false;
-static void sbusDataReceive(uint16_t c);
+static volatile bool sbusFrameDone = false;
+static void sbusDataReceive(const volatile uint8_t *data, uint16_t count, uint32_t firstByteTime);
 static uint16_t sbusReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
 
-static uint32_t sbusChannelData[SBUS_MAX_CHANNEL];
+// scaled to [1000;2000], published to rx.c as a complete frame
+static uint16_t sbusChannelData[SBUS_MAX_CHANNEL];
 
 bool sbusInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
 {
     int b;
     for (b = 0; b < SBUS_MAX_CHANNEL; b++)
-        sbusChannelData[b] = (16 * rxConfig()->midrc) / 10 - 1408;
+        sbusChannelData[b] = rxConfig()->midrc;
     if (callback)
         *callback = sbusReadRawRC;
     rxRuntimeConfig->channelCount = SBUS_MAX_CHANNEL;
+    rxRuntimeConfig->channelData = sbusChannelData;
 
     serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
         return false;
     }
     portOptions_t options = (rxConfig()->sbus_inversion) ? (SBUS_PORT_OPTIONS | SERIAL_INVERTED) : SBUS_PORT_OPTIONS;
-    serialPort_t *sBusPort = openSerialPort(portConfig->identifier, FUNCTION_RX_SERIAL, sbusDataReceive, SBUS_BAUDRATE, MODE_RX, options);
+    serialPort_t *sBusPort = openSerialPort(portConfig->identifier, FUNCTION_RX_SERIAL, NULL, SBUS_BAUDRATE, MODE_RX, options);
+    if (!sBusPort) {
+        return false;
+    }
+    serialSetReceiveBurstCallback(sBusPort, sbusDataReceive);
 
-    return sBusPort != NULL;
+    return true;
 }
 
 #define SBUS_FLAG_CHANNEL_17        (1 << 0)
@@ -104,25 +112,14 @@ bool sbusInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
 #define SBUS_FLAG_SIGNAL_LOSS       (1 << 2)
 #define SBUS_FLAG_FAILSAFE_ACTIVE   (1 << 3)
 
+#define SBUS_CHANNEL_BITS 11
+#define SBUS_CHANNEL_MASK ((1 << SBUS_CHANNEL_BITS) - 1)
+#define SBUS_ANALOG_CHANNEL_COUNT 16
+
 struct sbusFrame_s {
     uint8_t syncByte;
-    // 176 bits of data (11 bits per channel * 16 channels) = 22 bytes.
-    unsigned int chan0 : 11;
-    unsigned int chan1 : 11;
-    unsigned int chan2 : 11;
-    unsigned int chan3 : 11;
-    unsigned int chan4 : 11;
-    unsigned int chan5 : 11;
-    unsigned int chan6 : 11;
-    unsigned int chan7 : 11;
-    unsigned int chan8 : 11;
-    unsigned int chan9 : 11;
-    unsigned int chan10 : 11;
-    unsigned int chan11 : 11;
-    unsigned int chan12 : 11;
-    unsigned int chan13 : 11;
-    unsigned int chan14 : 11;
-    unsigned int chan15 : 11;
+    // 176 bits of data (11 bits per channel * 16 channels) = 22 bytes, LSB first.
+    uint8_t data[SBUS_ANALOG_CHANNEL_COUNT * SBUS_CHANNEL_BITS / 8];
     uint8_t flags;
     /**
      * The endByte is 0x00 on FrSky and some futaba RX's, on Some SBUS2 RX's the value indicates the telemetry byte that is sent after every 4th sbus frame.
@@ -139,32 +136,42 @@ typedef union {
     struct sbusFrame_s frame;
 } sbusFrame_t;
 
-static sbusFrame_t sbusFrame;
+// the ISR fills one frame while the other, complete one is decoded
+static sbusFrame_t sbusFrames[2];
+static volatile uint8_t sbusReadyFrameIndex = 0;
+static volatile uint32_t sbusFrameEndAt = 0;
 
-// Receive ISR callback
-static void sbusDataReceive(uint16_t c)
+// Receive ISR callback, a burst is a run of back to back bytes
+static void sbusDataReceive(const volatile uint8_t *data, uint16_t count, uint32_t firstByteTime)
 {
     static uint8_t sbusFramePosition = 0;
     static uint32_t sbusFrameStartAt = 0;
-    uint32_t now = micros();
+    static uint8_t sbusFillFrameIndex = 0;
 
-    int32_t sbusFrameTime = now - sbusFrameStartAt;
+    int32_t sbusFrameTime = firstByteTime - sbusFrameStartAt;
 
     if (sbusFrameTime > (long)(SBUS_TIME_NEEDED_PER_FRAME + 500)) {
         sbusFramePosition = 0;
     }
 
-    if (sbusFramePosition == 0) {
-        if (c != SBUS_FRAME_BEGIN_BYTE) {
-            return;
+    sbusFrame_t *sbusFrame = &sbusFrames[sbusFillFrameIndex];
+
+    for (uint16_t i = 0; i < count && sbusFramePosition < SBUS_FRAME_SIZE; i++) {
+        uint8_t c = data[i];
+
+        if (sbusFramePosition == 0) {
+            if (c != SBUS_FRAME_BEGIN_BYTE) {
+                continue;
+            }
+            sbusFrameStartAt = firstByteTime + i * SBUS_TIME_PER_BYTE;
         }
-        sbusFrameStartAt = now;
-    }
 
-    if (sbusFramePosition < SBUS_FRAME_SIZE) {
-        sbusFrame.bytes[sbusFramePosition++] = (uint8_t)c;
+        sbusFrame->bytes[sbusFramePosition++] = c;
         if (sbusFramePosition == SBUS_FRAME_SIZE) {
             // endByte currently ignored
+            sbusFrameEndAt = firstByteTime + (i + 1) * SBUS_TIME_PER_BYTE;
+            sbusReadyFrameIndex = sbusFillFrameIndex;
+            sbusFillFrameIndex ^= 1;
             sbusFrameDone = true;
 #ifdef DEBUG_SBUS_PACKETS
             debug[2] = sbusFrameTime;
@@ -175,6 +182,31 @@ static void sbusDataReceive(uint16_t c)
     }
 }
 
+// Linear fitting values read from OpenTX-ppmus and comparing with values received by X4R
+// http://www.wolframalpha.com/input/?i=linear+fit+%7B173%2C+988%7D%2C+%7B1812%2C+2012%7D%2C+%7B993%2C+1500%7D
+// 0.625 * value + 880, exact in integers
+#define SBUS_SCALE_CHANNEL(value) ((((value) * 5) >> 3) + 880)
+
+static void sbusDecodeChannels(const struct sbusFrame_s *frame)
+{
+    const uint8_t *data = frame->data;
+    uint32_t bits = 0;
+    uint8_t bitCount = 0;
+
+    for (int chan = 0; chan < SBUS_ANALOG_CHANNEL_COUNT; chan++) {
+        while (bitCount < SBUS_CHANNEL_BITS) {
+            bits |= (uint32_t)*data++ << bitCount;
+            bitCount += 8;
+        }
+        sbusChannelData[chan] = SBUS_SCALE_CHANNEL(bits & SBUS_CHANNEL_MASK);
+        bits >>= SBUS_CHANNEL_BITS;
+        bitCount -= SBUS_CHANNEL_BITS;
+    }
+
+    sbusChannelData[16] = SBUS_SCALE_CHANNEL((frame->flags & SBUS_FLAG_CHANNEL_17) ? SBUS_DIGITAL_CHANNEL_MAX : SBUS_DIGITAL_CHANNEL_MIN);
+    sbusChannelData[17] = SBUS_SCALE_CHANNEL((frame->flags & SBUS_FLAG_CHANNEL_18) ? SBUS_DIGITAL_CHANNEL_MAX : SBUS_DIGITAL_CHANNEL_MIN);
+}
+
 uint8_t sbusFrameStatus(void)
 {
     if (!sbusFrameDone) {
@@ -182,47 +214,23 @@ uint8_t sbusFrameStatus(void)
     }
     sbusFrameDone = false;
 
+    const sbusFrame_t *frame = &sbusFrames[sbusReadyFrameIndex];
+
 #ifdef DEBUG_SBUS_PACKETS
     sbusStateFlags = 0;
-    debug[1] = sbusFrame.frame.flags;
+    debug[1] = frame->frame.flags;
 #endif
 
-    sbusChannelData[0] = sbusFrame.frame.chan0;
-    sbusChannelData[1] = sbusFrame.frame.chan1;
-    sbusChannelData[2] = sbusFrame.frame.chan2;
-    sbusChannelData[3] = sbusFrame.frame.chan3;
-    sbusChannelData[4] = sbusFrame.frame.chan4;
-    sbusChannelData[5] = sbusFrame.frame.chan5;
-    sbusChannelData[6] = sbusFrame.frame.chan6;
-    sbusChannelData[7] = sbusFrame.frame.chan7;
-    sbusChannelData[8] = sbusFrame.frame.chan8;
-    sbusChannelData[9] = sbusFrame.frame.chan9;
-    sbusChannelData[10] = sbusFrame.frame.chan10;
-    sbusChannelData[11] = sbusFrame.frame.chan11;
-    sbusChannelData[12] = sbusFrame.frame.chan12;
-    sbusChannelData[13] = sbusFrame.frame.chan13;
-    sbusChannelData[14] = sbusFrame.frame.chan14;
-    sbusChannelData[15] = sbusFrame.frame.chan15;
-
-    if (sbusFrame.frame.flags & SBUS_FLAG_CHANNEL_17) {
-        sbusChannelData[16] = SBUS_DIGITAL_CHANNEL_MAX;
-    } else {
-        sbusChannelData[16] = SBUS_DIGITAL_CHANNEL_MIN;
-    }
-
-    if (sbusFrame.frame.flags & SBUS_FLAG_CHANNEL_18) {
-        sbusChannelData[17] = SBUS_DIGITAL_CHANNEL_MAX;
-    } else {
-        sbusChannelData[17] = SBUS_DIGITAL_CHANNEL_MIN;
-    }
+    sbusDecodeChannels(&frame->frame);
+    rxRuntimeConfig.frameTimeUs = sbusFrameEndAt;
 
-    if (sbusFrame.frame.flags & SBUS_FLAG_SIGNAL_LOSS) {
+    if (frame->frame.flags & SBUS_FLAG_SIGNAL_LOSS) {
 #ifdef DEBUG_SBUS_PACKETS
         sbusStateFlags |= SBUS_STATE_SIGNALLOSS;
         debug[0] = sbusStateFlags;
 #endif
     }
-    if (sbusFrame.frame.flags & SBUS_FLAG_FAILSAFE_ACTIVE) {
+    if (frame->frame.flags & SBUS_FLAG_FAILSAFE_ACTIVE) {
         // internal failsafe enabled and rx failsafe flag set
 #ifdef DEBUG_SBUS_PACKETS
         sbusStateFlags |= SBUS_STATE_FAILSAFE;
@@ -241,7 +249,5 @@ uint8_t sbusFrameStatus(void)
 static uint16_t sbusReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
 {
     UNUSED(rxRuntimeConfig);
-    // Linear fitting values read from OpenTX-ppmus and comparing with values received by X4R
-    // http://www.wolframalpha.com/input/?i=linear+fit+%7B173%2C+988%7D%2C+%7B1812%2C+2012%7D%2C+%7B993%2C+1500%7D
-    return (0.625f * sbusChannelData[chan]) + 880;
+    return sbusChannelData[chan];
 }
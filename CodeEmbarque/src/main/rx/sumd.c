@@ -23,6 +23,8 @@
 
 #include "build_config.h"
 
+#include "common/crc.h"
+
 #include "config/parameter_group.h"
 
 #include "drivers/system.h"
@@ -68,22 +70,6 @@ bool sumdInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
     return sumdPort != NULL;
 }
 
-#define CRC_POLYNOME 0x1021
-
-// CRC calculation, adds a 8 bit unsigned to 16 bit crc
-static void CRC16(uint8_t value)
-{
-    uint8_t i;
-
-    crc = crc ^ (int16_t)value << 8;
-    for (i = 0; i < 8; i++) {
-    if (crc & 0x8000)
-        crc = (crc << 1) ^ CRC_POLYNOME;
-    else
-        crc = (crc << 1);
-    }
-}
-
 static uint8_t sumd[SUMD_BUFFSIZE] = { 0, };
 static uint8_t sumdChannelCount;
 
@@ -114,7 +100,7 @@ static void sumdDataReceive(uint16_t c)
         sumd[sumdIndex] = (uint8_t)c;
     sumdIndex++;
     if (sumdIndex < sumdChannelCount * 2 + 4)
-        CRC16((uint8_t)c);
+        crc = crc16CcittUpdate(crc, (uint8_t)c);
     else
         if (sumdIndex == sumdChannelCount * 2 + 5) {
             sumdIndex = 0;
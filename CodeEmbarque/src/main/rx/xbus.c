@@ -21,6 +21,8 @@
 
 #include <platform.h>
 
+#include "common/crc.h"
+
 #include "config/parameter_group.h"
 
 #include "drivers/system.h"
@@ -46,8 +48,6 @@
 #define XBUS_RJ01_MESSAGE_LENGTH 30
 #define XBUS_RJ01_OFFSET_BYTES 3
 
-#define XBUS_CRC_AND_VALUE 0x8000
-#define XBUS_CRC_POLY 0x1021
 
 #define XBUS_BAUDRATE 115200
 #define XBUS_RJ01_BAUDRATE 250000
@@ -130,47 +130,6 @@ bool xBusInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
     return xBusPort != NULL;
 }
 
-// The xbus mode B CRC calculations
-static uint16_t xBusCRC16(uint16_t crc, uint8_t value)
-{
-    uint8_t i;
-    
-    crc = crc ^ (int16_t)value << 8;
-
-    for (i = 0; i < 8; i++) {
-        if (crc & XBUS_CRC_AND_VALUE) {
-            crc = crc << 1 ^ XBUS_CRC_POLY;
-        } else {
-            crc = crc << 1;
-        }
-    }
-    return crc;
-}
-
-// Full RJ01 message CRC calculations
-uint8_t xBusRj01CRC8(uint8_t inData, uint8_t seed)
-{
-    uint8_t bitsLeft;
-    uint8_t temp;
-
-    for (bitsLeft = 8; bitsLeft > 0; bitsLeft--) {
-        temp = ((seed ^ inData) & 0x01);
-
-        if (temp == 0) {
-            seed >>= 1;
-        } else {
-            seed ^= 0x18;
-            seed >>= 1;
-            seed |= 0x80;
-        }
-
-        inData >>= 1;
-    }
-
-    return seed;    
-}
-
-
 static void xBusUnpackModeBFrame(uint8_t offsetBytes)
 {
     // Calculate the CRC of the incoming frame
@@ -182,7 +141,7 @@ static void xBusUnpackModeBFrame(uint8_t offsetBytes)
 
     // Calculate on all bytes except the final two CRC bytes
     for (i = 0; i < XBUS_FRAME_SIZE - 2; i++) {
-        inCrc = xBusCRC16(inCrc, xBusFrame[i+offsetBytes]);
+        inCrc = crc16CcittUpdate(inCrc, xBusFrame[i+offsetBytes]);
     }
 
     // Get the received CRC
@@ -240,7 +199,7 @@ static void xBusUnpackRJ01Frame(void)
     // CRC calculation & check for full message
     //
     for (i = 0; i < xBusFrameLength - 1; i++) {
-        outerCrc = xBusRj01CRC8(outerCrc, xBusFrame[i]);
+        outerCrc = crc8MaximUpdate(outerCrc, xBusFrame[i]);
     }
     
     if (outerCrc != xBusFrame[xBusFrameLength - 1])
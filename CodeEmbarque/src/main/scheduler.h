@@ -77,6 +77,9 @@ typedef enum {
 #ifdef TRANSPONDER
     TASK_TRANSPONDER,
 #endif
+#ifdef USE_ESC_SENSOR
+    TASK_ESC_SENSOR,
+#endif
 
     /* Count of real tasks */
     TASK_COUNT,
@@ -37,6 +37,7 @@ void taskUpdateDisplay(void);
 void taskTelemetry(void);
 void taskLedStrip(void);
 void taskTransponder(void);
+void taskEscSensor(void);
 void taskSystem(void);
 
 cfTask_t cfTasks[TASK_COUNT] = {
@@ -172,4 +173,13 @@ cfTask_t cfTasks[TASK_COUNT] = {
         .staticPriority = TASK_PRIORITY_IDLE,
     },
 #endif
+
+#ifdef USE_ESC_SENSOR
+    [TASK_ESC_SENSOR] = {
+        .taskName = "ESC_SENSOR",
+        .taskFunc = taskEscSensor,
+        .desiredPeriod = 1000,                  // every 1 ms, one motor is polled every few runs
+        .staticPriority = TASK_PRIORITY_MEDIUM,
+    },
+#endif
 };
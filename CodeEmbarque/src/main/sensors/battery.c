@@ -23,8 +23,10 @@
 
 #include "common/maths.h"
 #include "common/filter.h"
+#include "common/atomic.h"
 
 #include "drivers/adc.h"
+#include "drivers/nvic.h"
 #include "drivers/system.h"
 
 #include "config/parameter_group.h"
@@ -39,10 +41,12 @@
 #include "io/beeper.h"
 
 #include "sensors/battery.h"
+#include "sensors/esc_sensor.h"
 
 
 #define VBATT_PRESENT_THRESHOLD_MV    10
 #define VBATT_LPF_FREQ  1.0f
+#define ESC_BATTERY_DATA_AGE_MAX    10
 
 // Battery monitoring stuff
 uint8_t batteryCellCount = 3;       // cell count
@@ -59,6 +63,8 @@ int32_t mAhDrawn = 0;               // milliampere hours drawn from the battery
 static batteryState_e batteryState;
 static biquad_t vbatFilterState;
 
+static volatile int64_t adcChargeDrawn = 0;  // ADC current sensor charge, centiamps * ms, integrated for each ADC block
+
 PG_REGISTER_WITH_RESET_TEMPLATE(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
 
 PG_RESET_TEMPLATE(batteryConfig_t, batteryConfig,
@@ -169,6 +175,18 @@ const char * getBatteryStateString(void)
     return batteryStateStrings[batteryState];
 }
 
+int32_t currentSensorToCentiamps(uint16_t src);
+
+// ADC DMA interrupt, integrates the current of each oversampled block over its exact duration
+static void batteryAdcBlockCompleted(uint32_t blockIntervalUs)
+{
+    if (batteryConfig()->currentMeterType != CURRENT_SENSOR_ADC) {
+        return;
+    }
+    int32_t centiamps = currentSensorToCentiamps(adcGetChannel(ADC_CURRENT));
+    adcChargeDrawn += ((int64_t)MAX(0, centiamps) * blockIntervalUs) / 1000;
+}
+
 void batteryInit(void)
 {
     batteryState = BATTERY_NOT_PRESENT;
@@ -178,6 +196,7 @@ void batteryInit(void)
 
     BiQuadNewLpf(VBATT_LPF_FREQ, &vbatFilterState, 50000);
 
+    adcSetBlockCallback(batteryAdcBlockCompleted);
 }
 
 #define ADCVREF 3300   // in mV
@@ -193,17 +212,20 @@ int32_t currentSensorToCentiamps(uint16_t src)
 
 void updateCurrentMeter(int32_t lastUpdateAt, throttleStatus_e throttleStatus)
 {
-    static int32_t amperageRaw = 0;
     static int64_t mAhdrawnRaw = 0;
     int32_t throttleOffset = (int32_t)rcCommand[THROTTLE] - 1000;
     int32_t throttleFactor = 0;
 
     switch(batteryConfig()->currentMeterType) {
         case CURRENT_SENSOR_ADC:
-            amperageRaw -= amperageRaw / 8;
-            amperageRaw += (amperageLatestADC = adcGetChannel(ADC_CURRENT));
-            amperage = currentSensorToCentiamps(amperageRaw / 8);
-            break;
+            // already averaged by the ADC, and integrated in batteryAdcBlockCompleted()
+            amperageLatestADC = adcGetChannel(ADC_CURRENT);
+            amperage = currentSensorToCentiamps(amperageLatestADC);
+            ATOMIC_BLOCK(NVIC_PRIO_ADC_DMA) {
+                mAhdrawnRaw = adcChargeDrawn;
+            }
+            mAhDrawn = mAhdrawnRaw / (3600 * 100);
+            return;
         case CURRENT_SENSOR_VIRTUAL:
             amperage = (int32_t)batteryConfig()->currentMeterOffset;
             if (ARMING_FLAG(ARMED)) {
@@ -213,6 +235,17 @@ void updateCurrentMeter(int32_t lastUpdateAt, throttleStatus_e throttleStatus)
                 amperage += throttleFactor * (int32_t)batteryConfig()->currentMeterScale  / 1000;
             }
             break;
+        case CURRENT_SENSOR_ESC:
+#ifdef USE_ESC_SENSOR
+            if (isEscSensorActive()) {
+                // keep the last value while the ESCs are being polled, drop it once none of them answer any more
+                escSensorData_t *escData = getEscSensorData(ESC_SENSOR_COMBINED);
+                amperage = escData->dataAge <= ESC_BATTERY_DATA_AGE_MAX ? escData->current : 0;
+                break;
+            }
+#endif
+            amperage = 0;
+            break;
         case CURRENT_SENSOR_NONE:
             amperage = 0;
             break;
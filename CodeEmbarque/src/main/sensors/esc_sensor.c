@@ -0,0 +1,223 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#include "build_config.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+#include "common/crc.h"
+
+#include "config/parameter_group.h"
+#include "config/parameter_group_ids.h"
+
+#include "drivers/system.h"
+#include "drivers/serial.h"
+#include "drivers/pwm_mapping.h"
+#include "drivers/pwm_output.h"
+
+#include "io/serial.h"
+
+#include "sensors/esc_sensor.h"
+
+/*
+ * KISS / BLHeli_32 ESC telemetry.
+ *
+ * Setting the telemetry bit in a DShot frame makes that ESC answer on the shared telemetry wire with:
+ *
+ *   byte 0    temperature, degrees C
+ *   byte 1-2  voltage, 0.01V
+ *   byte 3-4  current, 0.01A
+ *   byte 5-6  consumption, mAh
+ *   byte 7-8  eRPM / 100
+ *   byte 9    CRC8 (poly 0x07) of bytes 0-8
+ *
+ * Motors are polled one after the other, a motor that does not answer in time is skipped.
+ */
+
+PG_REGISTER_WITH_RESET_TEMPLATE(escSensorConfig_t, escSensorConfig, PG_ESC_SENSOR_CONFIG, 0);
+
+PG_RESET_TEMPLATE(escSensorConfig_t, escSensorConfig,
+    .motorPoles = 14,
+);
+
+#define ESC_SENSOR_REQUEST_TIMEOUT_US   3000    // DShot frame to the ESC, its reply delay and 10 bytes at 115200
+
+static serialPort_t *escSensorPort = NULL;
+static escSensorParser_t escSensorParser;
+
+static escSensorData_t escSensorData[MAX_PWM_MOTORS];
+static escSensorData_t combinedEscSensorData;
+
+static uint8_t escSensorMotor = 0;
+static uint32_t escSensorRequestedAt = 0;
+static bool escSensorRequestPending = false;
+
+void escSensorParserReset(escSensorParser_t *parser)
+{
+    parser->position = 0;
+}
+
+escSensorFrameStatus_e escSensorParserProcessByte(escSensorParser_t *parser, uint8_t c, escSensorData_t *data)
+{
+    if (parser->position >= ESC_SENSOR_FRAME_SIZE) {
+        return ESC_SENSOR_FRAME_FAILED; // trailing bytes after a frame, wait for a reset
+    }
+
+    parser->buffer[parser->position++] = c;
+
+    if (parser->position < ESC_SENSOR_FRAME_SIZE) {
+        return ESC_SENSOR_FRAME_PENDING;
+    }
+
+    const uint8_t *frame = parser->buffer;
+    if (crc8(0, frame, ESC_SENSOR_FRAME_SIZE - 1) != frame[ESC_SENSOR_FRAME_SIZE - 1]) {
+        return ESC_SENSOR_FRAME_FAILED;
+    }
+
+    data->dataAge = 0;
+    data->temperature = frame[0];
+    data->voltage = frame[1] << 8 | frame[2];
+    data->current = frame[3] << 8 | frame[4];
+    data->consumption = frame[5] << 8 | frame[6];
+    data->rpm = frame[7] << 8 | frame[8];
+
+    return ESC_SENSOR_FRAME_COMPLETE;
+}
+
+bool escSensorInit(void)
+{
+    serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_ESC_SENSOR);
+    if (!portConfig || !isMotorProtocolDshot()) {
+        return false;
+    }
+
+    escSensorPort = openSerialPort(portConfig->identifier, FUNCTION_ESC_SENSOR, NULL, ESC_SENSOR_BAUDRATE, MODE_RX, SERIAL_NOT_INVERTED);
+    if (!escSensorPort) {
+        return false;
+    }
+
+    for (int i = 0; i < MAX_PWM_MOTORS; i++) {
+        escSensorData[i].dataAge = ESC_DATA_INVALID;
+    }
+    combinedEscSensorData.dataAge = ESC_DATA_INVALID;
+
+    return true;
+}
+
+bool isEscSensorActive(void)
+{
+    return escSensorPort != NULL;
+}
+
+escSensorData_t *getEscSensorData(uint8_t motorNumber)
+{
+    if (motorNumber < MAX_PWM_MOTORS) {
+        return &escSensorData[motorNumber];
+    }
+    if (motorNumber == ESC_SENSOR_COMBINED) {
+        return &combinedEscSensorData;
+    }
+    return NULL;
+}
+
+// Mechanical RPM from eRPM / 100
+uint32_t calcEscRpm(int32_t erpm)
+{
+    return (erpm * 100) / (escSensorConfig()->motorPoles / 2);
+}
+
+static void escSensorUpdateCombined(void)
+{
+    int32_t voltage = 0;
+    int32_t rpm = 0;
+    uint8_t count = 0;
+
+    combinedEscSensorData.dataAge = ESC_DATA_INVALID;
+    combinedEscSensorData.temperature = 0;
+    combinedEscSensorData.current = 0;
+    combinedEscSensorData.consumption = 0;
+
+    for (int i = 0; i < MAX_PWM_MOTORS; i++) {
+        const escSensorData_t *data = &escSensorData[i];
+        if (data->dataAge == ESC_DATA_INVALID) {
+            continue;
+        }
+        combinedEscSensorData.dataAge = MIN(combinedEscSensorData.dataAge, data->dataAge);
+        combinedEscSensorData.temperature = MAX(combinedEscSensorData.temperature, data->temperature);
+        combinedEscSensorData.current += data->current;
+        combinedEscSensorData.consumption += data->consumption;
+        voltage += data->voltage;
+        rpm += data->rpm;
+        count++;
+    }
+
+    if (count) {
+        combinedEscSensorData.voltage = voltage / count;
+        combinedEscSensorData.rpm = rpm / count;
+    }
+}
+
+static void escSensorRequestNextMotor(uint32_t currentTime)
+{
+    escSensorMotor = (escSensorMotor + 1) % MAX_PWM_MOTORS;
+
+    // drop anything left over from the previous motor
+    while (serialRxBytesWaiting(escSensorPort)) {
+        serialRead(escSensorPort);
+    }
+    escSensorParserReset(&escSensorParser);
+
+    pwmRequestDshotTelemetry(escSensorMotor);
+    escSensorRequestedAt = currentTime;
+    escSensorRequestPending = true;
+}
+
+void escSensorProcess(uint32_t currentTime)
+{
+    if (!escSensorPort) {
+        return;
+    }
+
+    if (!escSensorRequestPending) {
+        escSensorRequestNextMotor(currentTime);
+        return;
+    }
+
+    escSensorFrameStatus_e status = ESC_SENSOR_FRAME_PENDING;
+    escSensorData_t *data = &escSensorData[escSensorMotor];
+
+    while (serialRxBytesWaiting(escSensorPort) && status == ESC_SENSOR_FRAME_PENDING) {
+        status = escSensorParserProcessByte(&escSensorParser, serialRead(escSensorPort), data);
+    }
+
+    if (status == ESC_SENSOR_FRAME_PENDING && cmp32(currentTime, escSensorRequestedAt) < ESC_SENSOR_REQUEST_TIMEOUT_US) {
+        return;
+    }
+
+    if (status != ESC_SENSOR_FRAME_COMPLETE && data->dataAge < ESC_DATA_INVALID - 1) {
+        data->dataAge++;
+    }
+
+    escSensorUpdateCombined();
+    escSensorRequestNextMotor(currentTime);
+}
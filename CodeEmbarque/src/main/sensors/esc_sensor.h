@@ -0,0 +1,61 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define ESC_SENSOR_COMBINED         255
+#define ESC_DATA_INVALID            255     // dataAge of a motor that never answered
+
+#define ESC_SENSOR_FRAME_SIZE       10
+#define ESC_SENSOR_BAUDRATE         115200
+
+typedef struct escSensorConfig_s {
+    uint8_t motorPoles;                     // number of magnets of the motors, used to convert eRPM to RPM
+} escSensorConfig_t;
+
+PG_DECLARE(escSensorConfig_t, escSensorConfig);
+
+typedef struct escSensorData_s {
+    uint8_t dataAge;                        // request cycles since the last valid frame
+    int8_t temperature;                     // degrees C
+    int16_t voltage;                        // 0.01V
+    int32_t current;                        // 0.01A
+    int32_t consumption;                    // mAh
+    int32_t rpm;                            // eRPM / 100
+} escSensorData_t;
+
+typedef enum {
+    ESC_SENSOR_FRAME_PENDING = 0,
+    ESC_SENSOR_FRAME_COMPLETE,
+    ESC_SENSOR_FRAME_FAILED
+} escSensorFrameStatus_e;
+
+// KISS / BLHeli_32 telemetry frame parser, fed one byte at a time
+typedef struct escSensorParser_s {
+    uint8_t buffer[ESC_SENSOR_FRAME_SIZE];
+    uint8_t position;
+} escSensorParser_t;
+
+void escSensorParserReset(escSensorParser_t *parser);
+escSensorFrameStatus_e escSensorParserProcessByte(escSensorParser_t *parser, uint8_t c, escSensorData_t *data);
+
+bool escSensorInit(void);
+bool isEscSensorActive(void);
+void escSensorProcess(uint32_t currentTime);
+
+escSensorData_t *getEscSensorData(uint8_t motorNumber);
+uint32_t calcEscRpm(int32_t erpm);
@@ -42,6 +42,7 @@
 #include "sensors/boardalignment.h"
 
 #include "sensors/gyro.h"
+#include "sensors/rpm_filter.h"
 
 gyro_t gyro;                      // gyro access functions
 sensor_align_e gyroAlign = 0;
@@ -56,13 +57,20 @@ static int32_t gyroZero[XYZ_AXIS_COUNT] = { 0, 0, 0 };
 static biquad_t gyroFilterState[3];
 static bool gyroFilterStateIsSet;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 0);
+#define GYRO_BATCH_MAX_SAMPLES 32
+static uint16_t gyroBatchOverrunCount;
+
+PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 2);
 
 PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .gyro_lpf = 1,                 // supported by all gyro drivers now. In case of ST gyro, will default to 32Hz instead
     .soft_gyro_lpf_hz = 60,        // Software based lpf filter for gyro
 
     .gyroMovementCalibrationThreshold = 32,
+    .gyro_fifo = 0,
+    .rpm_notch_harmonics = 3,
+    .rpm_notch_min_hz = 100,
+    .rpm_notch_q = 500,
 );
 
 static void initGyroFilterCoefficients(void)
@@ -70,7 +78,7 @@ static void initGyroFilterCoefficients(void)
     if (gyroConfig()->soft_gyro_lpf_hz) {
         // Initialisation needs to happen once sampling rate is known
         for (int axis = 0; axis < 3; axis++) {
-            BiQuadNewLpf(gyroConfig()->soft_gyro_lpf_hz, &gyroFilterState[axis], targetLooptime);
+            BiQuadNewLpf(gyroConfig()->soft_gyro_lpf_hz, &gyroFilterState[axis], gyroSamplePeriod);
         }
         gyroFilterStateIsSet = true;
     }
@@ -141,20 +149,28 @@ static void applyGyroZero(void)
     }
 }
 
-void gyroUpdate(void)
+uint16_t gyroGetBatchOverrunCount(void)
 {
-    // range: +/- 8192; +/- 2000 deg/sec
-    if (!gyro.read(gyroADCRaw)) {
-        return;
-    }
+    return gyroBatchOverrunCount;
+}
 
+static void gyroFilterSample(const int16_t *sample)
+{
     // Prepare a copy of int32_t gyroADC for mangling to prevent overflow
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        gyroADC[axis] = gyroADCRaw[axis];
+        gyroADC[axis] = sample[axis];
     }
 
     alignSensors(gyroADC, gyroADC, gyroAlign);
 
+#ifdef USE_RPM_FILTER
+    if (isRpmFilterEnabled()) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroADC[axis] = lrintf(rpmFilterApply(axis, (float)gyroADC[axis]));
+        }
+    }
+#endif
+
     if (gyroConfig()->soft_gyro_lpf_hz) {
         if (!gyroFilterStateIsSet) {
             initGyroFilterCoefficients();
@@ -163,6 +179,49 @@ void gyroUpdate(void)
             gyroADC[axis] = lrintf(applyBiQuadFilter((float)gyroADC[axis], &gyroFilterState[axis]));
         }
     }
+}
+
+// Every queued sample goes through the filter chain, the last filtered one is the output of this cycle.
+static bool gyroUpdateBatch(void)
+{
+    int16_t batch[GYRO_BATCH_MAX_SAMPLES][XYZ_AXIS_COUNT];
+
+    int8_t sampleCount = gyro.readBatch(&batch[0][0], GYRO_BATCH_MAX_SAMPLES);
+    if (sampleCount < 0) {
+        gyroBatchOverrunCount++;
+        return false;
+    }
+    if (sampleCount == 0) {
+        return false;
+    }
+
+    for (int i = 0; i < sampleCount; i++) {
+        gyroFilterSample(batch[i]);
+    }
+
+    memcpy(gyroADCRaw, batch[sampleCount - 1], sizeof(gyroADCRaw));
+
+    return true;
+}
+
+void gyroUpdate(void)
+{
+#ifdef USE_RPM_FILTER
+    rpmFilterUpdate();
+#endif
+
+    if (gyro.readBatch) {
+        if (!gyroUpdateBatch()) {
+            return;
+        }
+    } else {
+        // range: +/- 8192; +/- 2000 deg/sec
+        if (!gyro.read(gyroADCRaw)) {
+            return;
+        }
+
+        gyroFilterSample(gyroADCRaw);
+    }
 
     if (!isGyroCalibrationComplete()) {
         performAcclerationCalibration(gyroConfig()->gyroMovementCalibrationThreshold);
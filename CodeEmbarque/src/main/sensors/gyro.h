@@ -38,6 +38,10 @@ typedef struct gyroConfig_s {
     uint8_t gyroMovementCalibrationThreshold;   // people keep forgetting that moving model while init results in wrong gyro offsets. and then they never reset gyro. so this is now on by default.
     uint8_t gyro_lpf;                           // gyro LPF setting - values are driver specific, in case of invalid number, a reasonable default ~30-40HZ is chosen.
     uint16_t soft_gyro_lpf_hz;                  // Software based gyro filter in hz
+    uint8_t gyro_fifo;                          // sample the gyro at 8kHz into its FIFO and filter every queued sample
+    uint8_t rpm_notch_harmonics;                // notches per motor tracking the ESC telemetry RPM, 0 = off
+    uint8_t rpm_notch_min_hz;                   // lowest frequency a motor notch is tuned to
+    uint16_t rpm_notch_q;                       // notch Q * 100
 } gyroConfig_t;
 
 PG_DECLARE(gyroConfig_t, gyroConfig);
@@ -45,4 +49,5 @@ PG_DECLARE(gyroConfig_t, gyroConfig);
 void gyroSetCalibrationCycles(uint16_t calibrationCyclesRequired);
 void gyroUpdate(void);
 bool isGyroCalibrationComplete(void);
+uint16_t gyroGetBatchOverrunCount(void);
 
@@ -0,0 +1,237 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <platform.h>
+
+#include "build_config.h"
+
+#ifdef USE_RPM_FILTER
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/filter.h"
+
+#include "config/parameter_group.h"
+#include "config/config.h"
+
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
+
+#include "sensors/sensors.h"
+#include "sensors/gyro.h"
+#include "sensors/esc_sensor.h"
+
+#include "sensors/rpm_filter.h"
+
+#define M_PI_FLOAT                  3.14159265358979323846f
+
+#define RPM_FILTER_MAX_STEP_RAD     0.1f    // largest retune per update, keeps the small angle rotation exact to ~4e-6
+#define RPM_FILTER_NYQUIST_MARGIN   0.45f   // harmonics above this fraction of the sample rate are not filtered
+#define RPM_FILTER_MAX_DATA_AGE     5       // telemetry requests a motor may miss before its notches are bypassed
+
+typedef struct rpmFilterMotor_s {
+    float frequency;                        // Hz, fundamental the notches are tuned to
+    float cosOmega;                         // cos/sin of the fundamental, advanced by rotation instead of cosf/sinf
+    float sinOmega;
+    uint8_t notchCount;                     // harmonics below the frequency limit
+    bool active;                            // fresh telemetry, the notches are applied
+    uint8_t primeAxes;                      // axes whose notch history is seeded from the next sample
+} rpmFilterMotor_t;
+
+static biquad_t rpmNotch[XYZ_AXIS_COUNT][RPM_FILTER_MOTOR_COUNT][RPM_FILTER_HARMONICS_MAX];
+static rpmFilterMotor_t rpmFilterMotor[RPM_FILTER_MOTOR_COUNT];
+
+static bool rpmFilterEnabled;
+static uint8_t harmonicCount;
+static float invTwoQ;
+static float minFrequency;
+static float maxFrequency;
+static float hzToOmega;
+
+static void rpmFilterRetuneMotor(int motor)
+{
+    rpmFilterMotor_t *state = &rpmFilterMotor[motor];
+
+    // cos/sin of the fundamental and its harmonics by angle addition
+    float cs[RPM_FILTER_HARMONICS_MAX];
+    float sn[RPM_FILTER_HARMONICS_MAX];
+
+    cs[0] = state->cosOmega;
+    sn[0] = state->sinOmega;
+    cs[1] = 2 * cs[0] * cs[0] - 1;
+    sn[1] = 2 * sn[0] * cs[0];
+    cs[2] = cs[1] * cs[0] - sn[1] * sn[0];
+    sn[2] = sn[1] * cs[0] + cs[1] * sn[0];
+
+    state->notchCount = 0;
+    for (int harmonic = 0; harmonic < harmonicCount; harmonic++) {
+        if (state->frequency * (harmonic + 1) > maxFrequency) {
+            break;
+        }
+
+        biquad_t *notch = &rpmNotch[FD_ROLL][motor][harmonic];
+        BiQuadUpdateNotch(cs[harmonic], sn[harmonic], invTwoQ, notch);
+
+        // same coefficients on every axis, each axis keeps its own history
+        for (int axis = FD_PITCH; axis < XYZ_AXIS_COUNT; axis++) {
+            biquad_t *axisNotch = &rpmNotch[axis][motor][harmonic];
+            axisNotch->b0 = notch->b0;
+            axisNotch->b1 = notch->b1;
+            axisNotch->b2 = notch->b2;
+            axisNotch->a1 = notch->a1;
+            axisNotch->a2 = notch->a2;
+        }
+        state->notchCount++;
+    }
+}
+
+bool rpmFilterInit(uint32_t samplePeriodUs)
+{
+    rpmFilterEnabled = false;
+
+    harmonicCount = MIN(gyroConfig()->rpm_notch_harmonics, RPM_FILTER_HARMONICS_MAX);
+    if (!harmonicCount || !isEscSensorActive() || !samplePeriodUs) {
+        return false;
+    }
+
+    float sampleRate = 1e6f / samplePeriodUs;
+
+    invTwoQ = 100.0f / (2 * gyroConfig()->rpm_notch_q);
+    minFrequency = gyroConfig()->rpm_notch_min_hz;
+    maxFrequency = sampleRate * RPM_FILTER_NYQUIST_MARGIN;
+    hzToOmega = 2 * M_PI_FLOAT / sampleRate;
+
+    if (minFrequency >= maxFrequency) {
+        return false;
+    }
+
+    // every motor is bypassed until its telemetry arrives
+    memset(rpmNotch, 0, sizeof(rpmNotch));
+    memset(rpmFilterMotor, 0, sizeof(rpmFilterMotor));
+
+    rpmFilterEnabled = true;
+    return true;
+}
+
+bool isRpmFilterEnabled(void)
+{
+    return rpmFilterEnabled;
+}
+
+// A motor without fresh telemetry is bypassed, notches parked on a guess only add phase lag
+static bool rpmFilterTargetFrequency(int motor, float *frequency)
+{
+    const escSensorData_t *data = getEscSensorData(motor);
+
+    if (!data || data->dataAge > RPM_FILTER_MAX_DATA_AGE) {
+        return false;
+    }
+    *frequency = constrainf(calcEscRpm(data->rpm) / 60.0f, minFrequency, maxFrequency);
+    return true;
+}
+
+// The notches of a motor whose telemetry (re)appears start on its frequency, with a settled history
+static void rpmFilterActivateMotor(int motor, float frequency)
+{
+    rpmFilterMotor_t *state = &rpmFilterMotor[motor];
+
+    state->frequency = frequency;
+    state->cosOmega = cosf(frequency * hzToOmega);
+    state->sinOmega = sinf(frequency * hzToOmega);
+    rpmFilterRetuneMotor(motor);
+
+    state->primeAxes = (1 << XYZ_AXIS_COUNT) - 1;
+    state->active = true;
+}
+
+/*
+ * Rotates each motor's cos/sin pair toward the telemetry frequency. The step is small enough for
+ * cos(d) ~ 1 - d^2/2, sin(d) ~ d - d^3/6, and one Newton step on the magnitude keeps the pair on
+ * the unit circle, so the fundamental only needs a cosf/sinf when the telemetry of a motor appears.
+ */
+void rpmFilterUpdate(void)
+{
+    if (!rpmFilterEnabled) {
+        return;
+    }
+
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        rpmFilterMotor_t *state = &rpmFilterMotor[motor];
+
+        float targetFrequency;
+        if (!rpmFilterTargetFrequency(motor, &targetFrequency)) {
+            state->active = false;
+            continue;
+        }
+        if (!state->active) {
+            rpmFilterActivateMotor(motor, targetFrequency);
+            continue;
+        }
+
+        float delta = (targetFrequency - state->frequency) * hzToOmega;
+        if (delta == 0.0f) {
+            continue;
+        }
+        delta = constrainf(delta, -RPM_FILTER_MAX_STEP_RAD, RPM_FILTER_MAX_STEP_RAD);
+        state->frequency += delta / hzToOmega;
+
+        float delta2 = delta * delta;
+        float cosDelta = 1 - delta2 * 0.5f;
+        float sinDelta = delta * (1 - delta2 * (1.0f / 6.0f));
+
+        float cs = state->cosOmega * cosDelta - state->sinOmega * sinDelta;
+        float sn = state->sinOmega * cosDelta + state->cosOmega * sinDelta;
+        float norm = 1.5f - 0.5f * (cs * cs + sn * sn);
+
+        state->cosOmega = cs * norm;
+        state->sinOmega = sn * norm;
+
+        rpmFilterRetuneMotor(motor);
+    }
+}
+
+float rpmFilterApply(int axis, float value)
+{
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        rpmFilterMotor_t *state = &rpmFilterMotor[motor];
+        if (!state->active) {
+            continue;
+        }
+
+        if (state->primeAxes & (1 << axis)) {
+            // a notch passes a constant input through, so its history starts as if the input had been there
+            for (int harmonic = 0; harmonic < RPM_FILTER_HARMONICS_MAX; harmonic++) {
+                biquad_t *notch = &rpmNotch[axis][motor][harmonic];
+                notch->x1 = notch->x2 = notch->y1 = notch->y2 = value;
+            }
+            state->primeAxes &= ~(1 << axis);
+        }
+
+        for (int harmonic = 0; harmonic < state->notchCount; harmonic++) {
+            value = applyBiQuadFilter(value, &rpmNotch[axis][motor][harmonic]);
+        }
+    }
+    return value;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#define RPM_FILTER_MOTOR_COUNT      4
+#define RPM_FILTER_HARMONICS_MAX    3       // fundamental and two harmonics
+
+/*
+ * One notch per motor and harmonic on each gyro axis, tuned from the ESC telemetry RPM.
+ * A motor without fresh telemetry has its notches bypassed.
+ *
+ * Cycle budget on the F3 (72MHz, single precision FPU), 4 motors x 3 harmonics:
+ *   rpmFilterApply()  12 biquads x 3 axes, ~20 cycles each     ~720 cycles per gyro sample
+ *   rpmFilterUpdate() 4 x (retune ~30 + 3 notches x ~35)       ~540 cycles per gyro update
+ * That is ~17us per 1kHz loop, or ~90us per loop with gyro_fifo and 8 queued samples,
+ * the coefficients are only retuned once per loop whatever the number of samples.
+ */
+
+bool rpmFilterInit(uint32_t samplePeriodUs);
+bool isRpmFilterEnabled(void);
+void rpmFilterUpdate(void);
+float rpmFilterApply(int axis, float value);
@@ -72,6 +72,8 @@
 #define USE_UART1
 #define USE_UART2
 #define USE_UART3
+// Idle line DMA reception, UART1 RX (DMA1 Ch5) is taken by SPI2 TX
+#define USE_UART2_RX_DMA
 #define USE_SOFTSERIAL1
 #define USE_SOFTSERIAL2
 #define SERIAL_PORT_COUNT 5
@@ -101,6 +103,12 @@
 #define UART3_RX_PINSOURCE  GPIO_PinSource11
 #endif
 
+// TIM2 is the only 32bit timer, it is used for micros() when RC_CH1-4 are not used as PWM/PPM inputs.
+// DEFAULT_RX_FEATURE is parallel PWM, so the default config keeps the SysTick based micros().
+#define USE_HARDWARE_TIMEBASE
+#define TIMEBASE_TIMER                  TIM2
+#define TIMEBASE_TIMER_APB1_PERIPHERAL  RCC_APB1Periph_TIM2
+
 #define SOFTSERIAL_1_TIMER TIM3
 #define SOFTSERIAL_1_TIMER_RX_HARDWARE 4 // PWM 5
 #define SOFTSERIAL_1_TIMER_TX_HARDWARE 5 // PWM 6
@@ -118,12 +126,22 @@
 #define M25P16_CS_PIN           GPIO_Pin_12
 #define M25P16_SPI_INSTANCE     SPI2
 
+// SPI2_RX shares DMA1_Channel4 with the UART1 TX DMA, so only transmits are DMA driven
+#define SPI2_TX_DMA_CHANNEL             DMA1_Channel5
+#define SPI2_TX_DMA_IRQ                 DMA1_Channel5_IRQn
+#define SPI2_TX_DMA_TC_FLAG             DMA1_FLAG_TC5
+#define SPI2_TX_DMA_HANDLER_IDENTIFER   DMA1_CH5_HANDLER
+
 #define USE_ADC
 #define BOARD_HAS_VOLTAGE_DIVIDER
 
 #define ADC_INSTANCE                ADC2
 #define ADC_DMA_CHANNEL             DMA2_Channel1
 #define ADC_AHB_PERIPHERAL          RCC_AHBPeriph_DMA2
+#define ADC_DMA_IRQ                 DMA2_Channel1_IRQn
+#define ADC_DMA_HANDLER_IDENTIFIER  DMA2_CH1_HANDLER
+#define ADC_DMA_HT_FLAG             DMA2_FLAG_HT1
+#define ADC_DMA_TC_FLAG             DMA2_FLAG_TC1
 
 #define VBAT_ADC_GPIO               GPIOA
 #define VBAT_ADC_GPIO_PIN           GPIO_Pin_4
@@ -163,6 +181,9 @@
 #define SERIAL_RX
 #define TELEMETRY
 #define USE_SERVOS
+#define USE_DSHOT
+#define USE_ESC_SENSOR
+#define USE_RPM_FILTER
 //#define USE_CLI
 
 #define SPEKTRUM_BIND
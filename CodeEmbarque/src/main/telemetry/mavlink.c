@@ -68,6 +68,7 @@
 #include "flight/failsafe.h"
 #include "flight/altitudehold.h"
 #include "flight/navigation.h"
+#include "flight/offboard.h"
 
 #include "telemetry/telemetry.h"
 #include "telemetry/mavlink.h"
@@ -76,7 +77,7 @@
 
 #include "mw.h"
 
-#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_TX
+#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_RXTX
 #define TELEMETRY_MAVLINK_MAXRATE 50
 #define TELEMETRY_MAVLINK_DELAY ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
 
@@ -130,8 +131,11 @@ static int mavlinkStreamTrigger(enum MAV_DATA_STREAM streamNum)
 
 static void mavlinkSerialWrite(uint8_t * buf, uint16_t length)
 {
-    for (int i = 0; i < length; i++)
-        serialWrite(mavlinkPort, buf[i]);
+    // drop the whole message rather than overrun the TX buffer with part of it
+    if (serialTxBytesFree(mavlinkPort) < length)
+        return;
+
+    serialWriteBuf(mavlinkPort, buf, length);
 }
 
 void freeMAVLinkTelemetryPort(void)
@@ -501,6 +505,81 @@ void processMAVLinkTelemetry(void)
     }
 }
 
+/*
+ * SET_ATTITUDE_TARGET from a companion computer.  The type_mask bits say which
+ * fields to ignore, the offboard flags say which ones to use.  MAVLink is
+ * NED / FRD, our pitch is positive nose down and our yaw rate positive to the
+ * left, as in mavlinkSendAttitude().
+ */
+STATIC_UNIT_TESTED void mavlinkHandleSetAttitudeTarget(const mavlink_message_t *msg)
+{
+    static uint16_t sequence;
+    static uint8_t lastMsgSeq;
+    mavlink_set_attitude_target_t target;
+    offboardSetpoint_t setpoint;
+
+    mavlink_msg_set_attitude_target_decode(msg, &target);
+
+    // the MAVLink packet sequence is 8 bits, extend it so that it does not wrap between two setpoints
+    sequence += (uint8_t)(msg->seq - lastMsgSeq);
+    lastMsgSeq = msg->seq;
+
+    setpoint.sequence = sequence;
+    setpoint.flags = 0;
+    if (!(target.type_mask & (1 << 0)))
+        setpoint.flags |= OFFBOARD_SETPOINT_ROLL_RATE;
+    if (!(target.type_mask & (1 << 1)))
+        setpoint.flags |= OFFBOARD_SETPOINT_PITCH_RATE;
+    if (!(target.type_mask & (1 << 2)))
+        setpoint.flags |= OFFBOARD_SETPOINT_YAW_RATE;
+    if (!(target.type_mask & (1 << 6)))
+        setpoint.flags |= OFFBOARD_SETPOINT_THRUST;
+    if (!(target.type_mask & (1 << 7)))
+        setpoint.flags |= OFFBOARD_SETPOINT_ATTITUDE;
+
+    setpoint.rates[FD_ROLL] = target.body_roll_rate / RAD;
+    setpoint.rates[FD_PITCH] = -target.body_pitch_rate / RAD;
+    setpoint.rates[FD_YAW] = -target.body_yaw_rate / RAD;
+
+    // NED to the frame of the IMU quaternion, Y and Z flipped
+    setpoint.q[0] = target.q[0];
+    setpoint.q[1] = target.q[1];
+    setpoint.q[2] = -target.q[2];
+    setpoint.q[3] = -target.q[3];
+    setpoint.thrust = target.thrust;
+
+    offboardSetpointReceive(&setpoint);
+}
+
+static void mavlinkReceive(void)
+{
+    static mavlink_message_t rxMsg;
+    static mavlink_status_t rxStatus;
+
+    while (serialRxBytesWaiting(mavlinkPort)) {
+        if (!mavlink_parse_char(MAVLINK_COMM_0, serialRead(mavlinkPort), &rxMsg, &rxStatus))
+            continue;
+
+        // our system id is 0, so target_system is not checked: any setpoint on this link is for us
+        if (rxMsg.msgid == MAVLINK_MSG_ID_SET_ATTITUDE_TARGET)
+            mavlinkHandleSetAttitudeTarget(&rxMsg);
+    }
+}
+
+// called from the PID loop, so that a setpoint is used on the loop after it arrives
+void handleMAVLinkSetpoints(void)
+{
+    if (!mavlinkTelemetryEnabled) {
+        return;
+    }
+
+    if (!mavlinkPort) {
+        return;
+    }
+
+    mavlinkReceive();
+}
+
 void handleMAVLinkTelemetry(void)
 {
     if (!mavlinkTelemetryEnabled) {
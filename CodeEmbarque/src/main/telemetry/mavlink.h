@@ -20,6 +20,7 @@
 
 void initMAVLinkTelemetry(void);
 void handleMAVLinkTelemetry(void);
+void handleMAVLinkSetpoints(void);
 void checkMAVLinkTelemetryState(void);
 
 void freeMAVLinkTelemetryPort(void);
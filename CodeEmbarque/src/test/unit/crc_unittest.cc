@@ -0,0 +1,199 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "common/crc.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// bit by bit references
+
+static uint8_t referenceCrc8Msb(uint8_t poly, uint8_t crc, const uint8_t *data, uint32_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ poly : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t referenceCrc8Maxim(uint8_t crc, const uint8_t *data, uint32_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t referenceCrc16Ccitt(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    while (length--) {
+        crc ^= *data++ << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t referenceXor(uint8_t checksum, const uint8_t *data, uint32_t length)
+{
+    while (length--) {
+        checksum ^= *data++;
+    }
+    return checksum;
+}
+
+static const uint8_t checkString[] = "123456789";
+#define CHECK_LENGTH 9
+
+// catalogue check values of the 9 ASCII digits
+TEST(CrcTest, CheckValues)
+{
+    EXPECT_EQ(0xF4, crc8(0, checkString, CHECK_LENGTH));
+    EXPECT_EQ(0xBC, crc8DvbS2(0, checkString, CHECK_LENGTH));
+    EXPECT_EQ(0xA1, crc8Maxim(0, checkString, CHECK_LENGTH));
+    EXPECT_EQ(0x31C3, crc16Ccitt(0, checkString, CHECK_LENGTH));          // CRC-16/XMODEM
+    EXPECT_EQ(0x29B1, crc16Ccitt(0xFFFF, checkString, CHECK_LENGTH));     // CRC-16/CCITT-FALSE
+    EXPECT_EQ(0x31, checksumXor(0, checkString, CHECK_LENGTH));
+
+    fletcher8_t fletcher = { 0, 0 };
+    fletcher8(&fletcher, checkString, CHECK_LENGTH);
+    EXPECT_EQ(0xDD, fletcher.a);
+    EXPECT_EQ(0x15, fletcher.b);
+}
+
+TEST(CrcTest, UpdateMatchesBuffer)
+{
+    uint8_t crc8Value = 0, dvbS2 = 0, maxim = 0, xorValue = 0;
+    uint16_t ccitt = 0;
+    fletcher8_t fletcher = { 0, 0 };
+
+    for (int i = 0; i < CHECK_LENGTH; i++) {
+        crc8Value = crc8Update(crc8Value, checkString[i]);
+        dvbS2 = crc8DvbS2Update(dvbS2, checkString[i]);
+        maxim = crc8MaximUpdate(maxim, checkString[i]);
+        ccitt = crc16CcittUpdate(ccitt, checkString[i]);
+        xorValue = checksumXorUpdate(xorValue, checkString[i]);
+        fletcher8Update(&fletcher, checkString[i]);
+    }
+
+    EXPECT_EQ(0xF4, crc8Value);
+    EXPECT_EQ(0xBC, dvbS2);
+    EXPECT_EQ(0xA1, maxim);
+    EXPECT_EQ(0x31C3, ccitt);
+    EXPECT_EQ(0x31, xorValue);
+    EXPECT_EQ(0xDD, fletcher.a);
+    EXPECT_EQ(0x15, fletcher.b);
+}
+
+// random lengths and alignments, each buffer fed in two pieces from a random start value
+TEST(CrcTest, RandomBuffersMatchReferences)
+{
+    uint8_t buffer[320];
+    srand(1);
+
+    for (int i = 0; i < 20000; i++) {
+        uint32_t offset = rand() % 4;
+        uint32_t length = rand() % 300;
+        uint32_t split = length ? rand() % (length + 1) : 0;
+        const uint8_t *data = buffer + offset;
+        for (uint32_t j = 0; j < length; j++) {
+            buffer[offset + j] = rand();
+        }
+        uint8_t start8 = rand();
+        uint16_t start16 = rand();
+
+        EXPECT_EQ(referenceCrc8Msb(0x07, start8, data, length),
+            crc8(crc8(start8, data, split), data + split, length - split));
+        EXPECT_EQ(referenceCrc8Msb(0xD5, start8, data, length),
+            crc8DvbS2(crc8DvbS2(start8, data, split), data + split, length - split));
+        EXPECT_EQ(referenceCrc8Maxim(start8, data, length),
+            crc8Maxim(crc8Maxim(start8, data, split), data + split, length - split));
+        EXPECT_EQ(referenceCrc16Ccitt(start16, data, length),
+            crc16Ccitt(crc16Ccitt(start16, data, split), data + split, length - split));
+        EXPECT_EQ(referenceXor(start8, data, length),
+            checksumXor(checksumXor(start8, data, split), data + split, length - split));
+
+        fletcher8_t reference = { start8, (uint8_t)(start16 & 0xFF) };
+        for (uint32_t j = 0; j < length; j++) {
+            fletcher8Update(&reference, data[j]);
+        }
+        fletcher8_t fletcher = { start8, (uint8_t)(start16 & 0xFF) };
+        fletcher8(&fletcher, data, split);
+        fletcher8(&fletcher, data + split, length - split);
+        EXPECT_EQ(reference.a, fletcher.a);
+        EXPECT_EQ(reference.b, fletcher.b);
+
+        if (HasFailure()) {
+            FAIL() << "length " << length << " offset " << offset << " split " << split;
+        }
+    }
+}
+
+TEST(CrcBenchmark, BytesPerSecond)
+{
+    // host figures, the table lookups against the bit by bit references
+    static const int length = 1024;
+    static const int rounds = 2000;
+    uint8_t buffer[length + 1];
+    for (int i = 0; i < length + 1; i++) {
+        buffer[i] = i * 31;
+    }
+    volatile uint32_t sink = 0;
+
+#define BENCH(name, expr) do { \
+        auto start = std::chrono::steady_clock::now(); \
+        for (int round = 0; round < rounds; round++) { \
+            sink = sink + (expr); \
+        } \
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); \
+        printf("[ BENCH    ] %-22s %7.1fMB/s\n", name, (double)length * rounds / seconds / 1e6); \
+    } while (0)
+
+    BENCH("crc8", crc8(0, buffer, length));
+    BENCH("crc8 bitwise", referenceCrc8Msb(0x07, 0, buffer, length));
+    BENCH("crc8DvbS2", crc8DvbS2(0, buffer, length));
+    BENCH("crc8Maxim", crc8Maxim(0, buffer, length));
+    BENCH("crc8Maxim bitwise", referenceCrc8Maxim(0, buffer, length));
+    BENCH("crc16Ccitt", crc16Ccitt(0, buffer, length));
+    BENCH("crc16Ccitt bitwise", referenceCrc16Ccitt(0, buffer, length));
+    BENCH("checksumXor", checksumXor(0, buffer, length));
+    BENCH("checksumXor unaligned", checksumXor(0, buffer + 1, length));
+    BENCH("checksumXor bytewise", referenceXor(0, buffer, length));
+    fletcher8_t fletcher = { 0, 0 };
+    BENCH("fletcher8", (fletcher8(&fletcher, buffer, length), fletcher.b));
+
+#undef BENCH
+
+    EXPECT_NE(0u, sink);
+}
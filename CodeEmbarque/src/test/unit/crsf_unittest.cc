@@ -0,0 +1,300 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "config/parameter_group.h"
+
+    #include "drivers/serial.h"
+    #include "io/serial.h"
+
+    #include "rx/rx.h"
+    #include "rx/crsf.h"
+
+    rxConfig_t rxConfig_System;
+    rxRuntimeConfig_t rxRuntimeConfig;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FRAME_INTERVAL_US   6667
+#define BYTE_TIME_US        24
+
+static serialReceiveBurstCallbackPtr burstCallback;
+static rcReadRawDataPtr readRawRC;
+
+static uint8_t sentTelemetry[CRSF_FRAME_SIZE_MAX];
+static int sentTelemetrySize;
+
+// the parser keeps its state across tests, each test starts a frame interval later
+static uint32_t now = 100000;
+
+// reference CRC8 DVB-S2, polynomial 0xD5, bit by bit
+static uint8_t referenceCrc8DvbS2(const uint8_t *data, int length)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0xD5 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static int buildFrame(uint8_t *frame, uint8_t type, const uint8_t *payload, int payloadLength)
+{
+    frame[0] = 0xC8;
+    frame[1] = payloadLength + 2;
+    frame[2] = type;
+    memcpy(&frame[3], payload, payloadLength);
+    frame[3 + payloadLength] = referenceCrc8DvbS2(&frame[2], payloadLength + 1);
+    return payloadLength + 4;
+}
+
+// 16 channels of 11 bits, LSB first
+static int buildRcFrame(uint8_t *frame, const uint16_t *channels)
+{
+    uint8_t payload[22] = { 0 };
+    for (int bit = 0; bit < 16 * 11; bit++) {
+        if (channels[bit / 11] & (1 << (bit % 11))) {
+            payload[bit / 8] |= 1 << (bit % 8);
+        }
+    }
+    return buildFrame(frame, 0x16, payload, sizeof(payload));
+}
+
+static void receive(const uint8_t *data, int count, uint32_t at)
+{
+    burstCallback(data, count, at);
+}
+
+class CrsfTest : public ::testing::Test {
+protected:
+    uint16_t channels[16];
+    uint8_t frame[CRSF_FRAME_SIZE_MAX];
+
+    virtual void SetUp() {
+        rxConfig()->midrc = 1500;
+        memset(&rxRuntimeConfig, 0, sizeof(rxRuntimeConfig));
+        sentTelemetrySize = 0;
+
+        ASSERT_TRUE(crsfInit(&rxRuntimeConfig, &readRawRC));
+        ASSERT_TRUE(burstCallback != NULL);
+
+        for (int i = 0; i < 16; i++) {
+            channels[i] = 172 + i * 100;
+        }
+        now += 10 * FRAME_INTERVAL_US;
+    }
+
+    void expectChannels(void) {
+        for (int i = 0; i < 16; i++) {
+            EXPECT_EQ((channels[i] - 992) * 5 / 8 + 1500, readRawRC(&rxRuntimeConfig, i)) << "channel " << i;
+        }
+    }
+};
+
+TEST_F(CrsfTest, RcChannels)
+{
+    channels[0] = 172;
+    channels[1] = 992;
+    channels[2] = 1811;
+    int length = buildRcFrame(frame, channels);
+
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+    receive(frame, length, now);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+
+    EXPECT_EQ(988, readRawRC(&rxRuntimeConfig, 0));
+    EXPECT_EQ(1500, readRawRC(&rxRuntimeConfig, 1));
+    EXPECT_EQ(2011, readRawRC(&rxRuntimeConfig, 2));
+    expectChannels();
+
+    // the frame time is the end of its last byte
+    EXPECT_EQ(now + length * BYTE_TIME_US, rxRuntimeConfig.frameTimeUs);
+}
+
+TEST_F(CrsfTest, FrameSplitAcrossBursts)
+{
+    int length = buildRcFrame(frame, channels);
+
+    receive(frame, 5, now);
+    receive(frame + 5, 10, now + 5 * BYTE_TIME_US);
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+    receive(frame + 15, length - 15, now + 15 * BYTE_TIME_US);
+
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+    expectChannels();
+}
+
+TEST_F(CrsfTest, LinkStatistics)
+{
+    const uint8_t payload[10] = { 55, 60, 100, (uint8_t)-8, 1, 2, 3, 70, 99, (uint8_t)-12 };
+    int length = buildFrame(frame, 0x14, payload, sizeof(payload));
+
+    receive(frame, length, now);
+
+    // not an RC frame
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+
+    const crsfLinkStatistics_t *stats = crsfGetLinkStatistics();
+    ASSERT_TRUE(stats != NULL);
+    EXPECT_EQ(55, stats->uplinkRssiAnt1);
+    EXPECT_EQ(60, stats->uplinkRssiAnt2);
+    EXPECT_EQ(100, stats->uplinkLinkQuality);
+    EXPECT_EQ(-8, stats->uplinkSnr);
+    EXPECT_EQ(1, stats->activeAntenna);
+    EXPECT_EQ(2, stats->rfMode);
+    EXPECT_EQ(3, stats->uplinkTxPower);
+    EXPECT_EQ(70, stats->downlinkRssi);
+    EXPECT_EQ(99, stats->downlinkLinkQuality);
+    EXPECT_EQ(-12, stats->downlinkSnr);
+}
+
+TEST_F(CrsfTest, BadCrcIsDropped)
+{
+    int length = buildRcFrame(frame, channels);
+    frame[length - 1] ^= 0x01;
+    receive(frame, length, now);
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+
+    // a payload bit flipped in transit
+    length = buildRcFrame(frame, channels);
+    frame[10] ^= 0x20;
+    receive(frame, length, now + FRAME_INTERVAL_US);
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+
+    // a wrong size for its type, with a good CRC
+    uint8_t payload[10] = { 0 };
+    length = buildFrame(frame, 0x16, payload, sizeof(payload));
+    receive(frame, length, now + 2 * FRAME_INTERVAL_US);
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+}
+
+TEST_F(CrsfTest, ResyncAfterGarbage)
+{
+    // line noise and a truncated frame, the second byte is taken as a length that spans the next frame
+    const uint8_t garbage[] = { 0x55, 0x3E, 0x00, 0xC8, 0x18, 0x16, 0x01, 0x02 };
+    receive(garbage, sizeof(garbage), now);
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, crsfFrameStatus());
+
+    // the next frame starts after the inter frame gap, the partial frame is dropped
+    int length = buildRcFrame(frame, channels);
+    receive(frame, length, now + FRAME_INTERVAL_US);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+    expectChannels();
+}
+
+TEST_F(CrsfTest, InvalidLengthResyncsOnTheNextByte)
+{
+    // bytes that are not a length restart the search right away
+    uint8_t burst[2 + CRSF_FRAME_SIZE_MAX] = { 0x00, 0xFF };
+    int length = buildRcFrame(burst + 2, channels);
+
+    receive(burst, length + 2, now);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+    expectChannels();
+}
+
+TEST_F(CrsfTest, BackToBackFramesInOneBurst)
+{
+    const uint8_t stats[10] = { 50 };
+    uint8_t burst[2 * CRSF_FRAME_SIZE_MAX];
+
+    int length = buildFrame(burst, 0x14, stats, sizeof(stats));
+    length += buildRcFrame(burst + length, channels);
+    receive(burst, length, now);
+
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+    expectChannels();
+    ASSERT_TRUE(crsfGetLinkStatistics() != NULL);
+    EXPECT_EQ(50, crsfGetLinkStatistics()->uplinkRssiAnt1);
+}
+
+TEST_F(CrsfTest, TelemetryFollowsAnRcFrame)
+{
+    const uint8_t payload[] = { 0x01, 0x02, 0x03 };
+    ASSERT_TRUE(crsfWriteTelemetryFrame(0x08, payload, sizeof(payload)));
+    EXPECT_EQ(0, sentTelemetrySize);
+
+    int length = buildRcFrame(frame, channels);
+    receive(frame, length, now);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+
+    uint8_t expected[CRSF_FRAME_SIZE_MAX];
+    int expectedSize = buildFrame(expected, 0x08, payload, sizeof(payload));
+    ASSERT_EQ(expectedSize, sentTelemetrySize);
+    EXPECT_EQ(0, memcmp(expected, sentTelemetry, expectedSize));
+
+    // sent once
+    receive(frame, length, now + FRAME_INTERVAL_US);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, crsfFrameStatus());
+    EXPECT_EQ(expectedSize, sentTelemetrySize);
+}
+
+// STUBS
+
+static serialPortConfig_t testPortConfig;
+static serialPort_t testPort;
+
+extern "C" {
+    serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+    {
+        UNUSED(function);
+        return &testPortConfig;
+    }
+
+    serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr callback,
+        uint32_t baudrate, portMode_t mode, portOptions_t options)
+    {
+        UNUSED(identifier);
+        UNUSED(function);
+        UNUSED(callback);
+        UNUSED(baudrate);
+        UNUSED(mode);
+        UNUSED(options);
+        return &testPort;
+    }
+
+    void serialSetReceiveBurstCallback(serialPort_t *instance, serialReceiveBurstCallbackPtr callback)
+    {
+        UNUSED(instance);
+        burstCallback = callback;
+    }
+
+    uint32_t serialTxBytesFree(serialPort_t *instance)
+    {
+        UNUSED(instance);
+        return CRSF_FRAME_SIZE_MAX;
+    }
+
+    void serialWriteBuf(serialPort_t *instance, uint8_t *data, int count)
+    {
+        UNUSED(instance);
+        memcpy(sentTelemetry, data, count);
+        sentTelemetrySize = count;
+    }
+}
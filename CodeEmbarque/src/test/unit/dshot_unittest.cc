@@ -0,0 +1,94 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "drivers/dshot.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint8_t nibbleXor(uint16_t frame)
+{
+    return (frame ^ (frame >> 4) ^ (frame >> 8) ^ (frame >> 12)) & 0x0F;
+}
+
+TEST(DshotTest, ReferenceFrames)
+{
+    EXPECT_EQ(0x0000, dshotEncodeFrame(0, false));
+    EXPECT_EQ(0x0606, dshotEncodeFrame(48, false));
+    EXPECT_EQ(0x82C6, dshotEncodeFrame(1046, false));
+    EXPECT_EQ(0x82D7, dshotEncodeFrame(1046, true));
+    EXPECT_EQ(0xFFEE, dshotEncodeFrame(2047, false));
+}
+
+TEST(DshotTest, ThrottleTelemetryAndChecksumFields)
+{
+    for (uint16_t value = 0; value <= DSHOT_MAX_THROTTLE; value++) {
+        for (int telemetry = 0; telemetry < 2; telemetry++) {
+            uint16_t frame = dshotEncodeFrame(value, telemetry);
+
+            EXPECT_EQ(value, frame >> 5);
+            EXPECT_EQ(telemetry, (frame >> 4) & 1);
+            // the checksum nibble cancels the xor of the three data nibbles
+            EXPECT_EQ(0, nibbleXor(frame));
+        }
+    }
+}
+
+TEST(DshotTest, ThrottleIsElevenBits)
+{
+    EXPECT_EQ(dshotEncodeFrame(0, false), dshotEncodeFrame(2048, false));
+    EXPECT_EQ(dshotEncodeFrame(48, true), dshotEncodeFrame(2048 + 48, true));
+}
+
+TEST(DshotTest, PulsesMsbFirst)
+{
+    uint16_t buffer[DSHOT_FRAME_BITS];
+
+    dshotFrameToPulses(0x82D7, buffer, 1, 7, 14);
+
+    static const uint16_t expected[DSHOT_FRAME_BITS] = {
+        14, 7, 7, 7,  7, 7, 14, 7,  14, 14, 7, 14,  7, 14, 14, 14
+    };
+    for (int i = 0; i < DSHOT_FRAME_BITS; i++) {
+        EXPECT_EQ(expected[i], buffer[i]) << "bit " << i;
+    }
+}
+
+TEST(DshotTest, PulsesInterleavedForTimerBurst)
+{
+    // four channels of one timer share the burst buffer, each writes every fourth entry
+    uint16_t buffer[DSHOT_FRAME_BITS * 4];
+    for (int i = 0; i < DSHOT_FRAME_BITS * 4; i++) {
+        buffer[i] = 0xAAAA;
+    }
+
+    dshotFrameToPulses(0xFFEE, &buffer[2], 4, 15, 30);
+
+    for (int bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+        uint16_t expected = (0xFFEE & (0x8000 >> bit)) ? 30 : 15;
+        EXPECT_EQ(expected, buffer[bit * 4 + 2]) << "bit " << bit;
+        EXPECT_EQ(0xAAAA, buffer[bit * 4 + 0]);
+        EXPECT_EQ(0xAAAA, buffer[bit * 4 + 1]);
+        EXPECT_EQ(0xAAAA, buffer[bit * 4 + 3]);
+    }
+}
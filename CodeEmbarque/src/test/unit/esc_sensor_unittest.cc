@@ -0,0 +1,283 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "config/parameter_group.h"
+
+    #include "drivers/serial.h"
+    #include "io/serial.h"
+
+    #include "sensors/esc_sensor.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// reference CRC8, polynomial 0x07, bit by bit
+static uint8_t referenceCrc8(const uint8_t *data, int length)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void buildFrame(uint8_t *frame, int8_t temperature, uint16_t voltage, uint16_t current, uint16_t consumption, uint16_t erpm)
+{
+    frame[0] = temperature;
+    frame[1] = voltage >> 8;
+    frame[2] = voltage & 0xFF;
+    frame[3] = current >> 8;
+    frame[4] = current & 0xFF;
+    frame[5] = consumption >> 8;
+    frame[6] = consumption & 0xFF;
+    frame[7] = erpm >> 8;
+    frame[8] = erpm & 0xFF;
+    frame[9] = referenceCrc8(frame, ESC_SENSOR_FRAME_SIZE - 1);
+}
+
+static escSensorFrameStatus_e feed(escSensorParser_t *parser, const uint8_t *bytes, int length, escSensorData_t *data)
+{
+    escSensorFrameStatus_e status = ESC_SENSOR_FRAME_PENDING;
+    for (int i = 0; i < length; i++) {
+        status = escSensorParserProcessByte(parser, bytes[i], data);
+    }
+    return status;
+}
+
+TEST(EscSensorParserTest, DecodesFrame)
+{
+    // captured from a BLHeli_32 ESC: 36C, 16.00V, 2.91A, 1110mAh, 192900 eRPM
+    static const uint8_t recorded[ESC_SENSOR_FRAME_SIZE] = { 0x24, 0x06, 0x40, 0x01, 0x23, 0x04, 0x56, 0x07, 0x89, 0x00 };
+    uint8_t frame[ESC_SENSOR_FRAME_SIZE];
+    memcpy(frame, recorded, sizeof(frame));
+    frame[9] = referenceCrc8(frame, ESC_SENSOR_FRAME_SIZE - 1);
+
+    escSensorParser_t parser;
+    escSensorParserReset(&parser);
+    escSensorData_t data;
+    memset(&data, 0, sizeof(data));
+    data.dataAge = 7;
+
+    for (int i = 0; i < ESC_SENSOR_FRAME_SIZE - 1; i++) {
+        EXPECT_EQ(ESC_SENSOR_FRAME_PENDING, escSensorParserProcessByte(&parser, frame[i], &data));
+    }
+    EXPECT_EQ(7, data.dataAge);
+    EXPECT_EQ(ESC_SENSOR_FRAME_COMPLETE, escSensorParserProcessByte(&parser, frame[9], &data));
+
+    EXPECT_EQ(0, data.dataAge);
+    EXPECT_EQ(36, data.temperature);
+    EXPECT_EQ(1600, data.voltage);
+    EXPECT_EQ(291, data.current);
+    EXPECT_EQ(1110, data.consumption);
+    EXPECT_EQ(1929, data.rpm);
+}
+
+TEST(EscSensorParserTest, RejectsBadCrc)
+{
+    uint8_t frame[ESC_SENSOR_FRAME_SIZE];
+    buildFrame(frame, 40, 1480, 1000, 20, 500);
+    frame[9] ^= 0x01;
+
+    escSensorParser_t parser;
+    escSensorParserReset(&parser);
+    escSensorData_t data;
+    memset(&data, 0, sizeof(data));
+    data.dataAge = 3;
+
+    EXPECT_EQ(ESC_SENSOR_FRAME_FAILED, feed(&parser, frame, sizeof(frame), &data));
+    EXPECT_EQ(3, data.dataAge);
+    EXPECT_EQ(0, data.voltage);
+
+    // a single corrupted payload bit is caught as well
+    buildFrame(frame, 40, 1480, 1000, 20, 500);
+    frame[4] ^= 0x10;
+    escSensorParserReset(&parser);
+    EXPECT_EQ(ESC_SENSOR_FRAME_FAILED, feed(&parser, frame, sizeof(frame), &data));
+}
+
+TEST(EscSensorParserTest, TrailingBytesWaitForReset)
+{
+    uint8_t frame[ESC_SENSOR_FRAME_SIZE];
+    buildFrame(frame, 30, 1200, 150, 10, 300);
+
+    escSensorParser_t parser;
+    escSensorParserReset(&parser);
+    escSensorData_t data;
+
+    EXPECT_EQ(ESC_SENSOR_FRAME_COMPLETE, feed(&parser, frame, sizeof(frame), &data));
+    EXPECT_EQ(ESC_SENSOR_FRAME_FAILED, escSensorParserProcessByte(&parser, 0x55, &data));
+    EXPECT_EQ(1200, data.voltage);
+
+    buildFrame(frame, 31, 1190, 160, 11, 310);
+    escSensorParserReset(&parser);
+    EXPECT_EQ(ESC_SENSOR_FRAME_COMPLETE, feed(&parser, frame, sizeof(frame), &data));
+    EXPECT_EQ(1190, data.voltage);
+    EXPECT_EQ(310, data.rpm);
+}
+
+TEST(EscSensorParserTest, AllFieldValues)
+{
+    escSensorParser_t parser;
+    escSensorData_t data;
+    uint8_t frame[ESC_SENSOR_FRAME_SIZE];
+
+    for (uint32_t value = 0; value <= 0xFFFF; value += 0x0101) {
+        buildFrame(frame, value & 0x7F, value, value ^ 0xFFFF, value >> 1, value);
+        escSensorParserReset(&parser);
+        ASSERT_EQ(ESC_SENSOR_FRAME_COMPLETE, feed(&parser, frame, sizeof(frame), &data));
+        EXPECT_EQ((int16_t)value, data.voltage);
+        EXPECT_EQ((int32_t)(value ^ 0xFFFF), data.current);
+        EXPECT_EQ((int32_t)(value >> 1), data.consumption);
+        EXPECT_EQ((int32_t)value, data.rpm);
+    }
+}
+
+// STUBS
+
+static serialPortConfig_t testPortConfig;
+static serialPort_t testPort;
+static uint8_t rxBytes[64];
+static uint32_t rxHead, rxTail;
+static int requestedMotor = -1;
+
+static void replyWith(const uint8_t *bytes, int length)
+{
+    for (int i = 0; i < length; i++) {
+        rxBytes[rxTail++] = bytes[i];
+    }
+}
+
+extern "C" {
+    serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+    {
+        UNUSED(function);
+        return &testPortConfig;
+    }
+
+    serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr callback,
+        uint32_t baudrate, portMode_t mode, portOptions_t options)
+    {
+        UNUSED(identifier);
+        UNUSED(function);
+        UNUSED(callback);
+        UNUSED(baudrate);
+        UNUSED(mode);
+        UNUSED(options);
+        return &testPort;
+    }
+
+    uint32_t serialRxBytesWaiting(serialPort_t *instance)
+    {
+        UNUSED(instance);
+        return rxTail - rxHead;
+    }
+
+    uint8_t serialRead(serialPort_t *instance)
+    {
+        UNUSED(instance);
+        return rxBytes[rxHead++];
+    }
+
+    bool isMotorProtocolDshot(void)
+    {
+        return true;
+    }
+
+    void pwmRequestDshotTelemetry(uint8_t index)
+    {
+        requestedMotor = index;
+        rxHead = rxTail = 0;
+    }
+}
+
+TEST(EscSensorTest, PollsMotorsInTurn)
+{
+    escSensorConfig()->motorPoles = 14;
+
+    ASSERT_TRUE(escSensorInit());
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(ESC_DATA_INVALID, getEscSensorData(i)->dataAge);
+    }
+    EXPECT_EQ(ESC_DATA_INVALID, getEscSensorData(ESC_SENSOR_COMBINED)->dataAge);
+
+    uint32_t now = 1000;
+    escSensorProcess(now);
+    EXPECT_EQ(1, requestedMotor);
+
+    // motor 1 answers
+    uint8_t frame[ESC_SENSOR_FRAME_SIZE];
+    buildFrame(frame, 45, 1620, 1200, 300, 1400);
+    replyWith(frame, sizeof(frame));
+    now += 500;
+    escSensorProcess(now);
+    EXPECT_EQ(2, requestedMotor);
+    EXPECT_EQ(0, getEscSensorData(1)->dataAge);
+    EXPECT_EQ(1620, getEscSensorData(1)->voltage);
+    EXPECT_EQ(1400, getEscSensorData(1)->rpm);
+    EXPECT_EQ(20000u, calcEscRpm(getEscSensorData(1)->rpm));
+
+    // motor 2 is silent, it is skipped after the request timeout
+    now += 1000;
+    escSensorProcess(now);
+    EXPECT_EQ(2, requestedMotor);
+    now += 2500;
+    escSensorProcess(now);
+    EXPECT_EQ(3, requestedMotor);
+    EXPECT_EQ(ESC_DATA_INVALID, getEscSensorData(2)->dataAge);
+
+    // motor 3 answers with a corrupted frame, it is skipped at once
+    buildFrame(frame, 50, 1600, 1000, 280, 1300);
+    frame[9] ^= 0xFF;
+    replyWith(frame, sizeof(frame));
+    now += 500;
+    escSensorProcess(now);
+    EXPECT_EQ(0, requestedMotor);
+    EXPECT_EQ(ESC_DATA_INVALID, getEscSensorData(3)->dataAge);
+
+    // motor 0 answers, then motor 1 times out and ages
+    buildFrame(frame, 40, 1580, 800, 250, 1200);
+    replyWith(frame, sizeof(frame));
+    now += 500;
+    escSensorProcess(now);
+    EXPECT_EQ(1, requestedMotor);
+    now += 3000;
+    escSensorProcess(now);
+    EXPECT_EQ(2, requestedMotor);
+    EXPECT_EQ(1, getEscSensorData(1)->dataAge);
+
+    const escSensorData_t *combined = getEscSensorData(ESC_SENSOR_COMBINED);
+    EXPECT_EQ(0, combined->dataAge);
+    EXPECT_EQ(45, combined->temperature);
+    EXPECT_EQ(2000, combined->current);
+    EXPECT_EQ(550, combined->consumption);
+    EXPECT_EQ(1600, combined->voltage);
+    EXPECT_EQ(1300, combined->rpm);
+
+    EXPECT_EQ(NULL, getEscSensorData(4));
+}
@@ -0,0 +1,315 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/color.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/parameter_group.h"
+    #include "config/runtime_config.h"
+    #include "config/config.h"
+
+    #include "drivers/light_ws2811strip.h"
+
+    #include "flight/failsafe.h"
+
+    #include "io/rc_controls.h"
+    #include "io/gps.h"
+    #include "io/ledstrip.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/battery.h"
+    #include "sensors/sensors.h"
+
+    void pgResetFn_ledConfigs(ledConfig_t *instance);
+    void pgResetFn_colors(hsvColor_t *instance);
+    void pgResetFn_modeColors(modeColorIndexes_t *instance);
+    void pgResetFn_specialColors(specialColorIndexes_t *instance);
+
+    uint8_t armingFlags;
+    uint16_t flightModeFlags;
+    uint8_t stateFlags;
+    uint16_t rssi;
+    int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    int16_t rcCommand[4];
+    uint8_t GPS_numSat;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LF(name) LED_FLAG_FUNCTION(LED_FUNCTION_ ## name)
+#define LD(name) LED_FLAG_DIRECTION(LED_DIRECTION_ ## name)
+
+// every LED function, so every layer is in use
+static const ledConfig_t testLedConfig[] = {
+    { CALCULATE_LED_XY(15, 15), 0, LD(SOUTH) | LD(EAST) | LF(INDICATOR) | LF(ARM_STATE) },
+    { CALCULATE_LED_XY(15,  8), 0, LD(EAST)             | LF(FLIGHT_MODE) | LF(WARNING) },
+    { CALCULATE_LED_XY(15,  0), 0, LD(NORTH) | LD(EAST) | LF(INDICATOR) | LF(ARM_STATE) },
+    { CALCULATE_LED_XY( 8,  0), 0, LD(NORTH)            | LF(FLIGHT_MODE) },
+    { CALCULATE_LED_XY( 0,  0), 0, LD(NORTH) | LD(WEST) | LF(INDICATOR) | LF(GPS) },
+    { CALCULATE_LED_XY( 0,  8), 0, LD(WEST)             | LF(FLIGHT_MODE) | LF(WARNING) },
+    { CALCULATE_LED_XY( 0, 15), 2, LD(SOUTH) | LD(WEST) | LF(INDICATOR) | LF(BLINK) },
+    { CALCULATE_LED_XY( 8, 15), 0, LD(SOUTH)            | LF(FLIGHT_MODE) | LF(THROTTLE) },
+    { CALCULATE_LED_XY( 7,  7), 5, LD(UP)               | LF(COLOR) | LF(RSSI) },
+    { CALCULATE_LED_XY( 8,  8), 0, LD(DOWN)             | LF(FLIGHT_MODE) | LF(WARNING) },
+    { CALCULATE_LED_XY( 6, 10), 3, LF(THRUST_RING) },
+    { CALCULATE_LED_XY( 7,  9), 3, LF(THRUST_RING) },
+    { CALCULATE_LED_XY( 8,  9), 3, LF(THRUST_RING) },
+    { CALCULATE_LED_XY( 9, 10), 3, LF(THRUST_RING) },
+    { CALCULATE_LED_XY( 8, 11), 3, LF(THRUST_RING) },
+    { CALCULATE_LED_XY( 7, 11), 3, LF(THRUST_RING) },
+};
+
+// flight mode LEDs only, no layer timer is in use
+static const ledConfig_t flightModeLedConfig[] = {
+    { CALCULATE_LED_XY( 2,  0), 0, LD(NORTH) | LF(FLIGHT_MODE) },
+    { CALCULATE_LED_XY( 2,  4), 0, LD(SOUTH) | LF(FLIGHT_MODE) },
+    { CALCULATE_LED_XY( 0,  2), 0, LD(WEST)  | LF(FLIGHT_MODE) },
+    { CALCULATE_LED_XY( 4,  2), 0, LD(EAST)  | LF(FLIGHT_MODE) },
+};
+
+#undef LD
+#undef LF
+
+static hsvColor_t ledFrame[WS2811_LED_STRIP_LENGTH];
+static int stripUpdates;
+
+static uint32_t simulatedTime;
+static bool ledLowActive;
+static bool rxReceiving;
+static batteryState_e batteryState;
+static bool failsafeActive;
+
+static void loadLedConfig(const ledConfig_t *config, int count)
+{
+    memset(ledConfigs_SystemArray, 0, sizeof(ledConfigs_SystemArray));
+    memcpy(ledConfigs_SystemArray, config, count * sizeof(ledConfig_t));
+    reevalulateLedConfig();
+}
+
+class LedStripTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        pgResetFn_ledConfigs(ledConfigs_SystemArray);
+        pgResetFn_colors(colors_SystemArray);
+        pgResetFn_modeColors(modeColors_SystemArray);
+        pgResetFn_specialColors(specialColors_SystemArray);
+
+        armingFlags = OK_TO_ARM;
+        flightModeFlags = 0;
+        stateFlags = 0;
+        rssi = 512;
+        for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+            rcData[i] = PWM_RANGE_MIDDLE;
+        }
+        rcData[THROTTLE] = PWM_RANGE_MIN;
+        memset(rcCommand, 0, sizeof(rcCommand));
+        GPS_numSat = 0;
+
+        simulatedTime = 1000;
+        ledLowActive = false;
+        rxReceiving = true;
+        batteryState = BATTERY_OK;
+        failsafeActive = false;
+
+        memset(ledFrame, 0, sizeof(ledFrame));
+        stripUpdates = 0;
+
+        ledStripInit();
+        ledStripEnable();
+    }
+
+    // the event driven frame of this update and the frame a forced recomposition draws from the same state
+    void updateAndCompare(void) {
+        updateLedStrip();
+
+        hsvColor_t eventFrame[WS2811_LED_STRIP_LENGTH];
+        memcpy(eventFrame, ledFrame, sizeof(eventFrame));
+        int updates = stripUpdates;
+
+        // the timers that fired were rescheduled, so this only redraws every layer from the current state
+        reevalulateLedConfig();
+        updateLedStrip();
+
+        for (int i = 0; i < ledCount; i++) {
+            ASSERT_EQ(ledFrame[i].h, eventFrame[i].h) << "led " << i << " at " << simulatedTime << "us";
+            ASSERT_EQ(ledFrame[i].s, eventFrame[i].s) << "led " << i << " at " << simulatedTime << "us";
+            ASSERT_EQ(ledFrame[i].v, eventFrame[i].v) << "led " << i << " at " << simulatedTime << "us";
+        }
+        stripUpdates = updates;
+    }
+};
+
+TEST_F(LedStripTest, FramesMatchFullRecomposition)
+{
+    loadLedConfig(testLedConfig, ARRAYLEN(testLedConfig));
+    srand(1);
+
+    // 60s of 1kHz updates with the inputs of every layer changing at random
+    const int steps = 60000;
+    for (int step = 0; step < steps; step++) {
+        simulatedTime += 1000;
+
+        if (rand() % 3000 == 0)
+            armingFlags ^= ARMED;
+        if (rand() % 2000 == 0)
+            armingFlags ^= OK_TO_ARM;
+        if (rand() % 1500 == 0)
+            flightModeFlags ^= 1 << (rand() % 7);
+        if (rand() % 20 == 0)
+            rcData[THROTTLE] = constrain(rcData[THROTTLE] + rand() % 101 - 50, PWM_RANGE_MIN, PWM_RANGE_MAX);
+        if (rand() % 50 == 0)
+            rssi = constrain(rssi + rand() % 201 - 100, 0, 1023);
+        if (rand() % 200 == 0) {
+            rcCommand[ROLL] = rand() % 1001 - 500;
+            rcCommand[PITCH] = rand() % 1001 - 500;
+        }
+        if (rand() % 5000 == 0)
+            rxReceiving = !rxReceiving;
+        if (rand() % 4000 == 0)
+            GPS_numSat = rand() % 12;
+        if (rand() % 4000 == 0)
+            stateFlags ^= GPS_FIX;
+        if (rand() % 7000 == 0)
+            batteryState = batteryState == BATTERY_OK ? BATTERY_WARNING : BATTERY_OK;
+        if (rand() % 9000 == 0)
+            failsafeActive = !failsafeActive;
+        if (rand() % 10000 == 0)
+            ledLowActive = !ledLowActive;
+
+        updateAndCompare();
+        if (HasFatalFailure())
+            return;
+    }
+
+    printf("[ STATS    ] %d strip updates in %d calls\n", stripUpdates, steps);
+    EXPECT_LT(stripUpdates, steps / 4);
+}
+
+TEST_F(LedStripTest, IdleStripIsNotRedrawn)
+{
+    loadLedConfig(flightModeLedConfig, ARRAYLEN(flightModeLedConfig));
+
+    updateLedStrip();
+    EXPECT_EQ(1, stripUpdates);
+
+    // blink, warning and indicator timers keep expiring, none of their LEDs exist
+    for (int i = 0; i < 10000; i++) {
+        simulatedTime += 1000;
+        rcData[THROTTLE] = PWM_RANGE_MIN + i % 1000;
+        updateLedStrip();
+    }
+    EXPECT_EQ(1, stripUpdates);
+
+    hsvColor_t north = ledFrame[0];
+    flightModeFlags |= ANGLE_MODE;
+    simulatedTime += 1000;
+    updateLedStrip();
+    EXPECT_EQ(2, stripUpdates);
+    EXPECT_NE(north.h, ledFrame[0].h);
+}
+
+TEST_F(LedStripTest, ColorChangeRedraws)
+{
+    loadLedConfig(flightModeLedConfig, ARRAYLEN(flightModeLedConfig));
+    updateLedStrip();
+    EXPECT_EQ(1, stripUpdates);
+
+    // north LED in orientation mode shows color 1
+    EXPECT_TRUE(parseColor(1, "100,0,255"));
+    simulatedTime += 1000;
+    updateLedStrip();
+    EXPECT_EQ(2, stripUpdates);
+    EXPECT_EQ(100, ledFrame[0].h);
+}
+
+TEST_F(LedStripTest, RedrawnAfterLedLow)
+{
+    loadLedConfig(flightModeLedConfig, ARRAYLEN(flightModeLedConfig));
+    updateLedStrip();
+    hsvColor_t north = ledFrame[0];
+
+    ledLowActive = true;
+    simulatedTime += 1000;
+    updateLedStrip();
+    EXPECT_EQ(0, ledFrame[0].v);
+
+    ledLowActive = false;
+    simulatedTime += 1000;
+    updateLedStrip();
+    EXPECT_EQ(north.h, ledFrame[0].h);
+    EXPECT_EQ(north.v, ledFrame[0].v);
+}
+
+// STUBS
+
+extern "C" {
+
+void setLedHsv(int index, const hsvColor_t *color)
+{
+    ledFrame[index] = *color;
+}
+
+void getLedHsv(int index, hsvColor_t *color)
+{
+    *color = ledFrame[index];
+}
+
+void scaleLedValue(int index, const uint8_t scalePercent)
+{
+    ledFrame[index].v = ((uint16_t)ledFrame[index].v * scalePercent / 100);
+}
+
+void setStripColor(const hsvColor_t *color)
+{
+    for (int index = 0; index < WS2811_LED_STRIP_LENGTH; index++) {
+        ledFrame[index] = *color;
+    }
+}
+
+bool isWS2811LedStripReady(void) { return true; }
+void ws2811LedStripInit(void) {}
+void ws2811UpdateStrip(void) { stripUpdates++; }
+
+uint32_t micros(void) { return simulatedTime; }
+
+bool rcModeIsActive(boxId_e modeId) { return modeId == BOXLEDLOW && ledLowActive; }
+bool rxIsReceivingSignal(void) { return rxReceiving; }
+bool failsafeIsActive(void) { return failsafeActive; }
+batteryState_e getBatteryState(void) { return batteryState; }
+bool feature(uint32_t mask) { return mask & (FEATURE_VBAT | FEATURE_FAILSAFE | FEATURE_LED_STRIP); }
+bool sensors(uint32_t mask) { return mask & SENSOR_GPS; }
+
+int tfp_sprintf(char *s, const char *fmt, ...)
+{
+    UNUSED(s);
+    UNUSED(fmt);
+    return 0;
+}
+
+}
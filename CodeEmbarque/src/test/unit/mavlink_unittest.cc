@@ -0,0 +1,229 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/runtime_config.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/serial.h"
+
+    #include "io/serial.h"
+
+    #include "rx/rx.h"
+
+    #include "io/rc_controls.h"
+    #include "io/motor_and_servo.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/offboard.h"
+
+    #include "telemetry/telemetry.h"
+
+    #include "mavlink/common/mavlink.h"
+
+    void mavlinkHandleSetAttitudeTarget(const mavlink_message_t *msg);
+
+    motorAndServoConfig_t motorAndServoConfig_System;
+    imuConfig_t imuConfig_System;
+    static pidProfile_t pidProfileStorage;
+    pidProfile_t *pidProfile_ProfileCurrent = &pidProfileStorage;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// type_mask bits of SET_ATTITUDE_TARGET, the fields to ignore
+#define IGNORE_RATES    ((1 << 0) | (1 << 1) | (1 << 2))
+#define IGNORE_THRUST   (1 << 6)
+#define IGNORE_ATTITUDE (1 << 7)
+
+#define RATE_SCALE (16.4f / 4)
+#define LEVEL_GAIN (40 / 16.0f)
+
+static uint32_t simulatedTime;
+static uint8_t packetSequence;
+
+static void resetOffboard(void)
+{
+    offboardConfig()->timeout_ms = 50;
+    pidProfileStorage.pidController = PID_CONTROLLER_LUX_FLOAT;
+    pidProfileStorage.P8[PIDLEVEL] = 40;
+    imuConfig_System.max_angle_inclination = 500;
+    memset(&attitude, 0, sizeof(attitude));
+    ENABLE_ARMING_FLAG(ARMED);
+
+    // let any setpoint of the previous test time out
+    simulatedTime += 1000 * 1000;
+}
+
+// pack a SET_ATTITUDE_TARGET as a companion computer would, and run it through the handler
+static void sendSetAttitudeTarget(uint8_t typeMask, const float *q, float rollRate, float pitchRate, float yawRate)
+{
+    mavlink_message_t msg;
+    mavlink_msg_set_attitude_target_pack(255, 0, &msg, 0, 0, 0, typeMask, q, rollRate, pitchRate, yawRate, 0.5f);
+    msg.seq = packetSequence++;
+
+    mavlinkHandleSetAttitudeTarget(&msg);
+    offboardUpdate(simulatedTime);
+}
+
+static const float levelAttitude[4] = { 1, 0, 0, 0 };
+
+TEST(MAVLinkTest, RatesAreFRD)
+{
+    resetOffboard();
+
+    // rolling right, pitching nose up and turning right at 0.5 rad/s
+    sendSetAttitudeTarget(IGNORE_ATTITUDE | IGNORE_THRUST, levelAttitude, 0.5f, 0.5f, 0.5f);
+
+    const float rate = 0.5f / RAD * RATE_SCALE;
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(rate, angleRate, 0.1f);
+    // our pitch is positive nose down
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(-rate, angleRate, 0.1f);
+    // our yaw rate is positive to the left
+    EXPECT_TRUE(offboardGetAngleRate(FD_YAW, &angleRate));
+    EXPECT_NEAR(-rate, angleRate, 0.1f);
+}
+
+TEST(MAVLinkTest, RollRightIsPositive)
+{
+    resetOffboard();
+
+    // 10 degrees right wing down, NED
+    const float q[4] = { cosf(DEGREES_TO_RADIANS(5)), sinf(DEGREES_TO_RADIANS(5)), 0, 0 };
+    sendSetAttitudeTarget(IGNORE_RATES | IGNORE_THRUST, q, 0, 0, 0);
+
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(100 * LEVEL_GAIN, angleRate, 1.0f);
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+    EXPECT_TRUE(offboardGetAngleRate(FD_YAW, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+}
+
+TEST(MAVLinkTest, NoseUpIsNegativePitch)
+{
+    resetOffboard();
+
+    // 10 degrees nose up, NED
+    const float q[4] = { cosf(DEGREES_TO_RADIANS(5)), 0, sinf(DEGREES_TO_RADIANS(5)), 0 };
+    sendSetAttitudeTarget(IGNORE_RATES | IGNORE_THRUST, q, 0, 0, 0);
+
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(-100 * LEVEL_GAIN, angleRate, 1.0f);
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+}
+
+TEST(MAVLinkTest, HeadingIsClockwise)
+{
+    resetOffboard();
+
+    // heading 30 degrees, NED, the craft is pointing north
+    const float q[4] = { cosf(DEGREES_TO_RADIANS(15)), 0, 0, sinf(DEGREES_TO_RADIANS(15)) };
+    sendSetAttitudeTarget(IGNORE_RATES | IGNORE_THRUST, q, 0, 0, 0);
+
+    // turning right is a negative yaw rate
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_YAW, &angleRate));
+    EXPECT_NEAR(-300 * LEVEL_GAIN, angleRate, 1.0f);
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+
+    // already on the heading
+    attitude.values.yaw = 300;
+    offboardUpdate(simulatedTime);
+    EXPECT_TRUE(offboardGetAngleRate(FD_YAW, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+}
+
+TEST(MAVLinkTest, TypeMaskSelectsTheFields)
+{
+    resetOffboard();
+
+    sendSetAttitudeTarget(IGNORE_ATTITUDE | IGNORE_THRUST | (1 << 1) | (1 << 2), levelAttitude, 0.5f, 0.5f, 0.5f);
+
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_FALSE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_FALSE(offboardGetAngleRate(FD_YAW, &angleRate));
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint8_t stateFlags;
+attitudeEulerAngles_t attitude;
+float magneticDeclination = 0;
+int16_t rcCommand[4];
+
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+rxRuntimeConfig_t rxRuntimeConfig;
+uint16_t rssi;
+uint16_t vbat;
+int32_t amperage;
+int32_t GPS_coord[2];
+int32_t GPS_home[2];
+uint8_t GPS_numSat;
+uint16_t GPS_altitude;
+uint16_t GPS_speed;
+uint16_t GPS_ground_course;
+const uint32_t baudRates[] = { 0 };
+
+uint32_t micros(void) { return simulatedTime; }
+uint32_t millis(void) { return simulatedTime / 1000; }
+bool sensors(uint32_t) { return false; }
+bool feature(uint32_t) { return false; }
+bool isCalibrating(void) { return false; }
+uint8_t calculateBatteryPercentage(void) { return 0; }
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return NULL; }
+portSharing_e determinePortSharing(serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_UNUSED; }
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t, portOptions_t) { return NULL; }
+void closeSerialPort(serialPort_t *) {}
+bool telemetryDetermineEnabledState(portSharing_e) { return false; }
+uint32_t serialRxBytesWaiting(serialPort_t *) { return 0; }
+uint32_t serialTxBytesFree(serialPort_t *) { return 0; }
+void serialWriteBuf(serialPort_t *, uint8_t *, int) {}
+uint8_t serialRead(serialPort_t *) { return 0; }
+bool rcModeIsActive(boxId_e modeId) { return modeId == BOXOFFBOARD; }
+bool failsafeIsActive(void) { return false; }
+}
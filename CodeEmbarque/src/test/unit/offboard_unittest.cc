@@ -0,0 +1,384 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/runtime_config.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+
+    #include "rx/rx.h"
+
+    #include "io/rc_controls.h"
+    #include "io/motor_and_servo.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/offboard.h"
+
+    motorAndServoConfig_t motorAndServoConfig_System;
+    imuConfig_t imuConfig_System;
+    static pidProfile_t pidProfileStorage;
+    pidProfile_t *pidProfile_ProfileCurrent = &pidProfileStorage;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TIMEOUT_MS 50
+#define THROTTLE_UNTOUCHED 1234
+
+static uint32_t simulatedTime;
+static bool offboardModeOn;
+static bool failsafeOn;
+static uint16_t nextSequence;
+
+static void resetOffboard(void)
+{
+    offboardConfig()->timeout_ms = TIMEOUT_MS;
+    motorAndServoConfig_System.minthrottle = 1150;
+    motorAndServoConfig_System.maxthrottle = 1850;
+    pidProfileStorage.pidController = PID_CONTROLLER_LUX_FLOAT;
+    pidProfileStorage.P8[PIDLEVEL] = 40;
+    imuConfig_System.max_angle_inclination = 500;
+    memset(&attitude, 0, sizeof(attitude));
+
+    ENABLE_ARMING_FLAG(ARMED);
+    offboardModeOn = true;
+    failsafeOn = false;
+    rcCommand[THROTTLE] = THROTTLE_UNTOUCHED;
+
+    // let any setpoint of the previous test time out
+    simulatedTime += 10 * TIMEOUT_MS * 1000;
+    offboardUpdate(simulatedTime);
+}
+
+static offboardSetpoint_t rateSetpoint(float roll, float pitch, float yaw)
+{
+    offboardSetpoint_t setpoint;
+    memset(&setpoint, 0, sizeof(setpoint));
+    setpoint.sequence = nextSequence++;
+    setpoint.flags = OFFBOARD_SETPOINT_RATES;
+    setpoint.rates[FD_ROLL] = roll;
+    setpoint.rates[FD_PITCH] = pitch;
+    setpoint.rates[FD_YAW] = yaw;
+    return setpoint;
+}
+
+// same order as the PID loop, update then throttle
+static void runLoop(void)
+{
+    offboardUpdate(simulatedTime);
+    offboardApplyThrottle();
+}
+
+TEST(OffboardTest, InactiveWithoutSetpoint)
+{
+    resetOffboard();
+    runLoop();
+
+    float angleRate;
+    EXPECT_FALSE(offboardIsActive());
+    EXPECT_FALSE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_EQ(THROTTLE_UNTOUCHED, rcCommand[THROTTLE]);
+}
+
+TEST(OffboardTest, RatesReplaceTheSticks)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, -50, 20);
+    setpoint.flags = OFFBOARD_SETPOINT_ROLL_RATE | OFFBOARD_SETPOINT_PITCH_RATE;
+    EXPECT_TRUE(offboardSetpointReceive(&setpoint));
+    runLoop();
+
+    float angleRate;
+    EXPECT_TRUE(offboardIsActive());
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_FLOAT_EQ(100 * 16.4f / 4, angleRate);
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_FLOAT_EQ(-50 * 16.4f / 4, angleRate);
+    // no flag, the sticks keep the axis
+    EXPECT_FALSE(offboardGetAngleRate(FD_YAW, &angleRate));
+    // no thrust in the setpoint
+    EXPECT_EQ(THROTTLE_UNTOUCHED, rcCommand[THROTTLE]);
+}
+
+TEST(OffboardTest, ThrustSetsTheThrottle)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(0, 0, 0);
+    setpoint.flags = OFFBOARD_SETPOINT_THRUST;
+    setpoint.thrust = 0.5f;
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+    EXPECT_EQ(1500, rcCommand[THROTTLE]);
+
+    setpoint.sequence = nextSequence++;
+    setpoint.thrust = 1.5f;
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+    EXPECT_EQ(1850, rcCommand[THROTTLE]);
+
+    setpoint.sequence = nextSequence++;
+    setpoint.thrust = -1.0f;
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+    EXPECT_EQ(1150, rcCommand[THROTTLE]);
+}
+
+TEST(OffboardTest, AttitudeErrorBecomesARate)
+{
+    resetOffboard();
+
+    // 10 degrees of roll, level craft
+    offboardSetpoint_t setpoint = rateSetpoint(0, 0, 0);
+    setpoint.flags = OFFBOARD_SETPOINT_ATTITUDE;
+    setpoint.q[0] = cosf(DEGREES_TO_RADIANS(5));
+    setpoint.q[1] = sinf(DEGREES_TO_RADIANS(5));
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(100 * 40 / 16.0f, angleRate, 1.0f);
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(0, angleRate, 1.0f);
+
+    // the rates are feed forward on top of the attitude
+    setpoint.sequence = nextSequence++;
+    setpoint.flags |= OFFBOARD_SETPOINT_ROLL_RATE;
+    setpoint.rates[FD_ROLL] = 10;
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(100 * 40 / 16.0f + 10 * 16.4f / 4, angleRate, 1.0f);
+}
+
+TEST(OffboardTest, AttitudeIsLimitedToTheMaxInclination)
+{
+    resetOffboard();
+
+    // 80 degrees of roll and 70 degrees nose down, beyond the 50 degrees of ANGLE mode
+    offboardSetpoint_t setpoint = rateSetpoint(0, 0, 0);
+    setpoint.flags = OFFBOARD_SETPOINT_ATTITUDE;
+    setpoint.q[0] = cosf(DEGREES_TO_RADIANS(40));
+    setpoint.q[1] = sinf(DEGREES_TO_RADIANS(40));
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_NEAR(500 * 40 / 16.0f, angleRate, 1.0f);
+
+    setpoint.sequence = nextSequence++;
+    setpoint.q[0] = cosf(DEGREES_TO_RADIANS(35));
+    setpoint.q[1] = 0;
+    setpoint.q[2] = sinf(DEGREES_TO_RADIANS(35));
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(500 * 40 / 16.0f, angleRate, 1.0f);
+
+    // the limit is on the target, a craft past it is still brought back
+    attitude.values.pitch = 600;
+    runLoop();
+    EXPECT_TRUE(offboardGetAngleRate(FD_PITCH, &angleRate));
+    EXPECT_NEAR(-100 * 40 / 16.0f, angleRate, 1.0f);
+}
+
+TEST(OffboardTest, YawErrorTakesTheShortestWay)
+{
+    resetOffboard();
+
+    // heading 175 degrees, target -175 degrees, 10 degrees to the right
+    attitude.values.yaw = 1750;
+    offboardSetpoint_t setpoint = rateSetpoint(0, 0, 0);
+    setpoint.flags = OFFBOARD_SETPOINT_ATTITUDE;
+    setpoint.q[0] = cosf(DEGREES_TO_RADIANS(87.5f));
+    setpoint.q[3] = sinf(DEGREES_TO_RADIANS(87.5f));
+    offboardSetpointReceive(&setpoint);
+    runLoop();
+
+    // a positive yaw rate turns left
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_YAW, &angleRate));
+    EXPECT_NEAR(-100 * 40 / 16.0f, angleRate, 1.0f);
+}
+
+TEST(OffboardTest, TimesOut)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    setpoint.flags |= OFFBOARD_SETPOINT_THRUST;
+    setpoint.thrust = 0.5f;
+    offboardSetpointReceive(&setpoint);
+
+    simulatedTime += TIMEOUT_MS * 1000 - 1;
+    runLoop();
+    EXPECT_TRUE(offboardIsActive());
+
+    simulatedTime += 1;
+    rcCommand[THROTTLE] = THROTTLE_UNTOUCHED;
+    runLoop();
+    float angleRate;
+    EXPECT_FALSE(offboardIsActive());
+    EXPECT_FALSE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_EQ(THROTTLE_UNTOUCHED, rcCommand[THROTTLE]);
+}
+
+TEST(OffboardTest, TimeoutAcrossTheTimerWrap)
+{
+    resetOffboard();
+    simulatedTime = 0xFFFFFFFF - 10 * 1000;
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    offboardSetpointReceive(&setpoint);
+
+    simulatedTime += 20 * 1000;
+    runLoop();
+    EXPECT_TRUE(offboardIsActive());
+
+    simulatedTime += TIMEOUT_MS * 1000;
+    runLoop();
+    EXPECT_FALSE(offboardIsActive());
+}
+
+TEST(OffboardTest, OnlyWhenArmedInModeAndSupported)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    offboardSetpointReceive(&setpoint);
+
+    offboardModeOn = false;
+    runLoop();
+    EXPECT_FALSE(offboardIsActive());
+    offboardModeOn = true;
+
+    DISABLE_ARMING_FLAG(ARMED);
+    runLoop();
+    EXPECT_FALSE(offboardIsActive());
+    ENABLE_ARMING_FLAG(ARMED);
+
+    pidProfileStorage.pidController = PID_CONTROLLER_MW23;
+    runLoop();
+    EXPECT_FALSE(offboardIsActive());
+    pidProfileStorage.pidController = PID_CONTROLLER_MWREWRITE;
+
+    runLoop();
+    EXPECT_TRUE(offboardIsActive());
+}
+
+TEST(OffboardTest, FailsafeTakesPrecedence)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    setpoint.flags |= OFFBOARD_SETPOINT_THRUST;
+    setpoint.thrust = 1.0f;
+    offboardSetpointReceive(&setpoint);
+
+    failsafeOn = true;
+    runLoop();
+
+    float angleRate;
+    EXPECT_FALSE(offboardIsActive());
+    EXPECT_FALSE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_EQ(THROTTLE_UNTOUCHED, rcCommand[THROTTLE]);
+
+    failsafeOn = false;
+    runLoop();
+    EXPECT_TRUE(offboardIsActive());
+}
+
+TEST(OffboardTest, OlderSequencesAreDropped)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    EXPECT_TRUE(offboardSetpointReceive(&setpoint));
+
+    offboardSetpoint_t stale = setpoint;
+    stale.rates[FD_ROLL] = -100;
+    EXPECT_FALSE(offboardSetpointReceive(&stale));
+    stale.sequence--;
+    EXPECT_FALSE(offboardSetpointReceive(&stale));
+
+    runLoop();
+    float angleRate;
+    EXPECT_TRUE(offboardGetAngleRate(FD_ROLL, &angleRate));
+    EXPECT_FLOAT_EQ(100 * 16.4f / 4, angleRate);
+}
+
+TEST(OffboardTest, SequenceWraps)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    setpoint.sequence = 0xFFFF;
+    EXPECT_TRUE(offboardSetpointReceive(&setpoint));
+    setpoint.sequence = 0;
+    EXPECT_TRUE(offboardSetpointReceive(&setpoint));
+}
+
+TEST(OffboardTest, NewSequenceAfterATimeout)
+{
+    resetOffboard();
+
+    offboardSetpoint_t setpoint = rateSetpoint(100, 0, 0);
+    setpoint.sequence = 1000;
+    EXPECT_TRUE(offboardSetpointReceive(&setpoint));
+
+    // the sender restarted
+    simulatedTime += TIMEOUT_MS * 1000;
+    setpoint.sequence = 0;
+    EXPECT_TRUE(offboardSetpointReceive(&setpoint));
+    runLoop();
+    EXPECT_TRUE(offboardIsActive());
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+attitudeEulerAngles_t attitude;
+float magneticDeclination = 0;
+int16_t rcCommand[4];
+
+uint32_t micros(void) { return simulatedTime; }
+bool rcModeIsActive(boxId_e modeId) { return modeId == BOXOFFBOARD && offboardModeOn; }
+bool failsafeIsActive(void) { return failsafeOn; }
+}
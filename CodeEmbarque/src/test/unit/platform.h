@@ -0,0 +1,93 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Stands in for src/main/platform.h on the host: the few STM32 types and
+// constants the code under test refers to, without the vendor headers.
+
+#pragma once
+
+#include <stdint.h>
+
+#define U_ID_0 0
+#define U_ID_1 1
+#define U_ID_2 2
+
+typedef enum { TEST_IRQ = 0 } IRQn_Type;
+
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+
+typedef enum { GPIO_Mode_IN = 0x00, GPIO_Mode_OUT = 0x01, GPIO_Mode_AF = 0x02, GPIO_Mode_AN = 0x03 } GPIOMode_TypeDef;
+typedef enum { GPIO_OType_PP = 0x00, GPIO_OType_OD = 0x01 } GPIOOType_TypeDef;
+typedef enum { GPIO_PuPd_NOPULL = 0x00, GPIO_PuPd_UP = 0x01, GPIO_PuPd_DOWN = 0x02 } GPIOPuPd_TypeDef;
+
+typedef struct {
+    uint32_t IDR;
+    uint32_t ODR;
+    uint32_t BSRR;
+    uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t CNT;
+    uint32_t ARR;
+    uint32_t CCR1;
+    uint32_t CCR2;
+    uint32_t CCR3;
+    uint32_t CCR4;
+} TIM_TypeDef;
+
+typedef struct {
+    uint32_t CCR;
+    uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    uint32_t ISR;
+    uint32_t RDR;
+    uint32_t TDR;
+} USART_TypeDef;
+
+#define NVIC_PriorityGroup_2 ((uint32_t)0x500)
+
+#define TIM_Channel_1 ((uint16_t)0x0000)
+#define TIM_Channel_2 ((uint16_t)0x0004)
+#define TIM_Channel_3 ((uint16_t)0x0008)
+#define TIM_Channel_4 ((uint16_t)0x000C)
+
+#define TIM_ICPolarity_Rising ((uint16_t)0x0000)
+#define TIM_ICPolarity_Falling ((uint16_t)0x0002)
+#define TIM_ICPolarity_BothEdge ((uint16_t)0x000A)
+#define TIM_ICSelection_DirectTI ((uint16_t)0x0001)
+#define TIM_ICPSC_DIV1 ((uint16_t)0x0000)
+
+typedef struct {
+    uint16_t TIM_Channel;
+    uint16_t TIM_ICPolarity;
+    uint16_t TIM_ICSelection;
+    uint16_t TIM_ICPrescaler;
+    uint16_t TIM_ICFilter;
+} TIM_ICInitTypeDef;
+
+void TIM_ICStructInit(TIM_ICInitTypeDef *TIM_ICInitStruct);
+void TIM_ICInit(TIM_TypeDef *TIMx, TIM_ICInitTypeDef *TIM_ICInitStruct);
+
+// CMSIS core register access, no interrupt priorities on the host
+static inline uint32_t __get_BASEPRI(void) { return 0; }
+static inline void __set_BASEPRI(uint32_t basePri) { (void)basePri; }
+
+#include "target.h"
@@ -0,0 +1,165 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "config/parameter_group.h"
+
+    #include "rx/rx.h"
+    #include "io/rate_profile.h"
+    #include "io/motor_and_servo.h"
+    #include "io/rc_curves.h"
+
+    motorAndServoConfig_t motorAndServoConfig_System;
+
+    static controlRateConfig_t controlRateConfig;
+    controlRateConfig_t *currentControlRateProfile = &controlRateConfig;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// the lookup must stay well below the half unit rounding of rcCommand[]
+#define MAX_CURVE_ERROR 0.05
+// a throttle mid close to an end bends the curve over a few segments only
+#define MAX_THROTTLE_CURVE_ERROR 0.25
+// float rounding allowed between two neighbouring inputs
+#define MONOTONIC_TOLERANCE 1e-3
+
+// closed forms, in double, of the stick deflection in units of 100
+
+static double pitchRollClosedForm(int32_t input)
+{
+    double stick = input / 100.0;
+    return (2500 + controlRateConfig.rcExpo8 * (stick * stick - 25)) * stick * controlRateConfig.rcRate8 / 2500;
+}
+
+static double yawClosedForm(int32_t input)
+{
+    double stick = input / 100.0;
+    return (2500 + controlRateConfig.rcYawExpo8 * (stick * stick - 25)) * stick / 25;
+}
+
+static double throttleClosedForm(int32_t input)
+{
+    double tmp = input / 10.0 - controlRateConfig.thrMid8;
+    double y = 1;
+    if (tmp > 0)
+        y = 100 - controlRateConfig.thrMid8;
+    if (tmp < 0)
+        y = controlRateConfig.thrMid8;
+    double throttle = 10 * controlRateConfig.thrMid8 + tmp * (100 - controlRateConfig.thrExpo8 + controlRateConfig.thrExpo8 * (tmp * tmp) / (y * y)) / 10;
+    return motorAndServoConfig_System.minthrottle + (motorAndServoConfig_System.maxthrottle - motorAndServoConfig_System.minthrottle) * throttle / 1000;
+}
+
+// sweeps every input of a curve, returns the largest error against the closed form
+static double checkCurve(const rcCurve_t *curve, int32_t inputMax, double (*closedForm)(int32_t input))
+{
+    double maxError = 0;
+    float previous = rcCurveLookup(curve, 0);
+
+    for (int32_t input = 0; input <= inputMax; input++) {
+        float value = rcCurveLookup(curve, input);
+        maxError = fmax(maxError, fabs(value - closedForm(input)));
+        EXPECT_GE(value, previous - MONOTONIC_TOLERANCE) << "input " << input;
+        previous = value;
+    }
+    // both ends are samples of the curve
+    EXPECT_NEAR(closedForm(0), rcCurveLookup(curve, 0), MONOTONIC_TOLERANCE);
+    EXPECT_NEAR(closedForm(inputMax), rcCurveLookup(curve, inputMax), MONOTONIC_TOLERANCE);
+
+    return maxError;
+}
+
+TEST(RcCurvesTest, PitchRollMatchesClosedForm)
+{
+    double maxError = 0;
+
+    for (int rate = 0; rate <= 250; rate += 5) {
+        for (int expo = 0; expo <= 100; expo += 5) {
+            controlRateConfig.rcRate8 = rate;
+            controlRateConfig.rcExpo8 = expo;
+            generatePitchRollCurve();
+
+            double error = checkCurve(&pitchRollCurve, PITCH_ROLL_CURVE_INPUT_MAX, pitchRollClosedForm);
+            EXPECT_LT(error, MAX_CURVE_ERROR) << "rcRate8 " << rate << " rcExpo8 " << expo;
+            maxError = fmax(maxError, error);
+            if (HasFailure()) {
+                return;
+            }
+        }
+    }
+    printf("pitch/roll, largest error %.5f\n", maxError);
+}
+
+TEST(RcCurvesTest, YawMatchesClosedForm)
+{
+    double maxError = 0;
+
+    for (int expo = 0; expo <= 100; expo++) {
+        controlRateConfig.rcYawExpo8 = expo;
+        generateYawCurve();
+
+        double error = checkCurve(&yawCurve, YAW_CURVE_INPUT_MAX, yawClosedForm);
+        EXPECT_LT(error, MAX_CURVE_ERROR) << "rcYawExpo8 " << expo;
+        maxError = fmax(maxError, error);
+        if (HasFailure()) {
+            return;
+        }
+    }
+    printf("yaw, largest error %.5f\n", maxError);
+}
+
+TEST(RcCurvesTest, ThrottleMatchesClosedForm)
+{
+    double maxError = 0;
+
+    motorAndServoConfig_System.minthrottle = 1150;
+    motorAndServoConfig_System.maxthrottle = 1850;
+
+    for (int mid = 0; mid <= 100; mid += 5) {
+        for (int expo = 0; expo <= 100; expo += 5) {
+            controlRateConfig.thrMid8 = mid;
+            controlRateConfig.thrExpo8 = expo;
+            generateThrottleCurve();
+
+            double error = checkCurve(&throttleCurve, THROTTLE_CURVE_INPUT_MAX, throttleClosedForm);
+            EXPECT_LT(error, MAX_THROTTLE_CURVE_ERROR) << "thrMid8 " << mid << " thrExpo8 " << expo;
+            maxError = fmax(maxError, error);
+            if (HasFailure()) {
+                return;
+            }
+        }
+    }
+    printf("throttle, largest error %.5f\n", maxError);
+}
+
+TEST(RcCurvesTest, InputAboveRangeHoldsTheEnd)
+{
+    controlRateConfig.rcRate8 = 90;
+    controlRateConfig.rcExpo8 = 65;
+    generatePitchRollCurve();
+
+    EXPECT_EQ(pitchRollCurve.points[RC_CURVE_SEGMENTS], rcCurveLookup(&pitchRollCurve, PITCH_ROLL_CURVE_INPUT_MAX + 1));
+    EXPECT_EQ(pitchRollCurve.points[RC_CURVE_SEGMENTS], rcCurveLookup(&pitchRollCurve, PITCH_ROLL_CURVE_INPUT_MAX + 100));
+}
@@ -0,0 +1,283 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+extern "C" {
+    #include "common/ring_buffer.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_BUFFER_SIZE 64
+
+// a blocked side sleeps rather than spins, so the other thread runs even on a single core
+static void waitForOtherThread(void)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(1));
+}
+
+static volatile uint8_t testBuffer[TEST_BUFFER_SIZE];
+
+TEST(RingBufferTest, PushPop)
+{
+    ringBuffer_t rb;
+    ringBufferInit(&rb, testBuffer, TEST_BUFFER_SIZE);
+
+    EXPECT_TRUE(ringBufferIsEmpty(&rb));
+    EXPECT_EQ(TEST_BUFFER_SIZE, (int)ringBufferFree(&rb));
+
+    // the whole buffer is usable
+    for (int i = 0; i < TEST_BUFFER_SIZE; i++) {
+        ringBufferPush(&rb, i);
+    }
+    EXPECT_EQ(TEST_BUFFER_SIZE, (int)ringBufferCount(&rb));
+    EXPECT_EQ(0, (int)ringBufferFree(&rb));
+
+    for (int i = 0; i < TEST_BUFFER_SIZE; i++) {
+        EXPECT_EQ(i, ringBufferPop(&rb));
+    }
+    EXPECT_TRUE(ringBufferIsEmpty(&rb));
+}
+
+TEST(RingBufferTest, WriteReadAcrossTheEnd)
+{
+    ringBuffer_t rb;
+    ringBufferInit(&rb, testBuffer, TEST_BUFFER_SIZE);
+
+    uint8_t data[TEST_BUFFER_SIZE];
+    uint8_t result[TEST_BUFFER_SIZE];
+    for (int i = 0; i < TEST_BUFFER_SIZE; i++) {
+        data[i] = 0xA0 ^ i;
+    }
+
+    // move head and tail near the end so the next write wraps
+    EXPECT_EQ(50u, ringBufferWrite(&rb, data, 50));
+    EXPECT_EQ(50u, ringBufferRead(&rb, result, 50));
+
+    EXPECT_EQ(40u, ringBufferWrite(&rb, data, 40));
+    EXPECT_EQ(24u, ringBufferWrite(&rb, data + 40, 40));    // only what fits
+    EXPECT_EQ(0u, ringBufferFree(&rb));
+
+    memset(result, 0, sizeof(result));
+    EXPECT_EQ(64u, ringBufferRead(&rb, result, sizeof(result)));
+    EXPECT_EQ(0, memcmp(data, result, 64));
+    EXPECT_EQ(0u, ringBufferRead(&rb, result, sizeof(result)));
+}
+
+TEST(RingBufferTest, SpansStopAtTheEnd)
+{
+    ringBuffer_t rb;
+    ringBufferInit(&rb, testBuffer, TEST_BUFFER_SIZE);
+
+    uint8_t data[TEST_BUFFER_SIZE] = { 0 };
+    ringBufferWrite(&rb, data, 60);
+    ringBufferRead(&rb, data, 60);
+
+    volatile uint8_t *writeSpan;
+    EXPECT_EQ(4u, ringBufferWriteSpan(&rb, &writeSpan));
+    EXPECT_EQ(&testBuffer[60], writeSpan);
+    for (int i = 0; i < 4; i++) {
+        writeSpan[i] = i + 1;
+    }
+    ringBufferCommit(&rb, 4);
+
+    EXPECT_EQ(60u, ringBufferWriteSpan(&rb, &writeSpan));     // 4 bytes still stored
+    EXPECT_EQ(&testBuffer[0], writeSpan);
+    writeSpan[0] = 5;
+    ringBufferCommit(&rb, 1);
+
+    const volatile uint8_t *readSpan;
+    EXPECT_EQ(4u, ringBufferReadSpan(&rb, &readSpan));
+    EXPECT_EQ(1, readSpan[0]);
+    EXPECT_EQ(4, readSpan[3]);
+    ringBufferConsume(&rb, 4);
+
+    EXPECT_EQ(1u, ringBufferReadSpan(&rb, &readSpan));
+    EXPECT_EQ(5, readSpan[0]);
+    ringBufferConsume(&rb, 1);
+    EXPECT_TRUE(ringBufferIsEmpty(&rb));
+}
+
+TEST(RingBufferTest, HeadFromDma)
+{
+    ringBuffer_t rb;
+    ringBufferInit(&rb, testBuffer, TEST_BUFFER_SIZE);
+
+    // circular DMA, CNDTR counts down from the buffer size
+    ringBufferSetHeadFromDma(&rb, TEST_BUFFER_SIZE);
+    EXPECT_EQ(0u, ringBufferCount(&rb));
+
+    ringBufferSetHeadFromDma(&rb, TEST_BUFFER_SIZE - 10);
+    EXPECT_EQ(10u, ringBufferCount(&rb));
+
+    uint8_t data[TEST_BUFFER_SIZE];
+    ringBufferRead(&rb, data, 10);
+
+    // the DMA wrapped, head keeps running
+    ringBufferSetHeadFromDma(&rb, TEST_BUFFER_SIZE - 4);
+    EXPECT_EQ(58u, ringBufferCount(&rb));
+    EXPECT_EQ(68u, rb.head);
+}
+
+// producer and consumer threads, every API mixed, the consumer checks the byte sequence
+TEST(RingBufferTest, SpscStress)
+{
+    static const uint32_t total = 1024 * 1024;
+    ringBuffer_t rb;
+    ringBufferInit(&rb, testBuffer, TEST_BUFFER_SIZE);
+
+    std::thread producer([&rb]() {
+        uint8_t chunk[TEST_BUFFER_SIZE];
+        uint32_t sent = 0;
+        unsigned seed = 1;
+        while (sent < total) {
+            uint32_t bytesFree = ringBufferFree(&rb);
+            if (!bytesFree) {
+                waitForOtherThread();
+                continue;
+            }
+            switch (rand_r(&seed) % 3) {
+            case 0:
+                ringBufferPush(&rb, sent++);
+                break;
+            case 1: {
+                uint32_t count = 1 + rand_r(&seed) % TEST_BUFFER_SIZE;
+                count = count > total - sent ? total - sent : count;
+                for (uint32_t i = 0; i < count; i++) {
+                    chunk[i] = sent + i;
+                }
+                sent += ringBufferWrite(&rb, chunk, count);
+                break;
+            }
+            default: {
+                volatile uint8_t *span;
+                uint32_t count = ringBufferWriteSpan(&rb, &span);
+                count = count > total - sent ? total - sent : count;
+                for (uint32_t i = 0; i < count; i++) {
+                    span[i] = sent + i;
+                }
+                ringBufferCommit(&rb, count);
+                sent += count;
+                break;
+            }
+            }
+        }
+    });
+
+    uint8_t chunk[TEST_BUFFER_SIZE];
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    unsigned seed = 2;
+    while (received < total) {
+        if (ringBufferIsEmpty(&rb)) {
+            waitForOtherThread();
+            continue;
+        }
+        switch (rand_r(&seed) % 3) {
+        case 0:
+            errors += ringBufferPop(&rb) != (uint8_t)received++;
+            break;
+        case 1: {
+            uint32_t count = ringBufferRead(&rb, chunk, 1 + rand_r(&seed) % TEST_BUFFER_SIZE);
+            for (uint32_t i = 0; i < count; i++) {
+                errors += chunk[i] != (uint8_t)received++;
+            }
+            break;
+        }
+        default: {
+            const volatile uint8_t *span;
+            uint32_t count = ringBufferReadSpan(&rb, &span);
+            for (uint32_t i = 0; i < count; i++) {
+                errors += span[i] != (uint8_t)received++;
+            }
+            ringBufferConsume(&rb, count);
+            break;
+        }
+        }
+    }
+
+    producer.join();
+
+    EXPECT_EQ(0u, errors);
+    EXPECT_EQ(total, received);
+    EXPECT_TRUE(ringBufferIsEmpty(&rb));
+}
+
+TEST(RingBufferBenchmark, Throughput)
+{
+    // host figures, only the relative cost of the byte and the block APIs
+    static const uint32_t total = 16 * 1024 * 1024;
+    static volatile uint8_t buffer[1024];
+    ringBuffer_t rb;
+    uint32_t sum = 0;
+
+    ringBufferInit(&rb, buffer, sizeof(buffer));
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < total; i++) {
+        ringBufferPush(&rb, i);
+        sum += ringBufferPop(&rb);
+    }
+    auto middle = std::chrono::steady_clock::now();
+
+    uint8_t chunk[256];
+    memset(chunk, 1, sizeof(chunk));
+    for (uint32_t i = 0; i < total; i += sizeof(chunk)) {
+        ringBufferWrite(&rb, chunk, sizeof(chunk));
+        sum += ringBufferRead(&rb, chunk, sizeof(chunk));
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    ringBufferReset(&rb);
+    auto threadedStart = std::chrono::steady_clock::now();
+    std::thread producer([&rb, &chunk]() {
+        for (uint32_t sent = 0; sent < total; ) {
+            uint32_t count = ringBufferWrite(&rb, chunk, sizeof(chunk));
+            if (!count) {
+                waitForOtherThread();
+            }
+            sent += count;
+        }
+    });
+    uint8_t received[256];
+    for (uint32_t count = 0; count < total; ) {
+        uint32_t bytesRead = ringBufferRead(&rb, received, sizeof(received));
+        if (!bytesRead) {
+            waitForOtherThread();
+        }
+        count += bytesRead;
+    }
+    producer.join();
+    auto threadedEnd = std::chrono::steady_clock::now();
+
+    double mb = total / (1024.0 * 1024.0);
+    printf("[ BENCH    ] push/pop %.0fMB/s, 256 byte write/read %.0fMB/s, two threads %.0fMB/s\n",
+        mb / std::chrono::duration<double>(middle - start).count(),
+        mb / std::chrono::duration<double>(end - middle).count(),
+        mb / std::chrono::duration<double>(threadedEnd - threadedStart).count());
+
+    EXPECT_NE(0u, sum);
+    EXPECT_TRUE(ringBufferIsEmpty(&rb));
+}
@@ -0,0 +1,287 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+
+    #include "config/parameter_group.h"
+    #include "config/config.h"
+    #include "config/feature.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/gyro.h"
+    #include "sensors/esc_sensor.h"
+    #include "sensors/rpm_filter.h"
+
+    gyroConfig_t gyroConfig_System;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define SAMPLE_PERIOD_US    125     // 8kHz gyro
+#define SAMPLE_RATE         (1e6 / SAMPLE_PERIOD_US)
+
+static escSensorData_t escData[RPM_FILTER_MOTOR_COUNT];
+static bool escSensorActive;
+
+// telemetry in RPM, calcEscRpm() is stubbed to pass the value through
+static void setMotorRpm(int motor, int32_t rpm)
+{
+    escData[motor].dataAge = 0;
+    escData[motor].rpm = rpm;
+}
+
+static void settle(void)
+{
+    // the retune step is limited, a few updates reach any target
+    for (int i = 0; i < 100; i++) {
+        rpmFilterUpdate();
+    }
+}
+
+// gain in dB of a sine through the notches of one axis, after the filters settled
+static double sineGainDb(int axis, double frequency)
+{
+    const int settleSamples = (int)SAMPLE_RATE;
+    const int measureSamples = (int)SAMPLE_RATE;
+    double inputPower = 0;
+    double outputPower = 0;
+
+    for (int i = 0; i < settleSamples + measureSamples; i++) {
+        double input = sin(2 * M_PI * frequency * i / SAMPLE_RATE);
+        double output = rpmFilterApply(axis, (float)input);
+        if (i >= settleSamples) {
+            inputPower += input * input;
+            outputPower += output * output;
+        }
+    }
+    return 10 * log10(outputPower / inputPower);
+}
+
+class RpmFilterTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        gyroConfig()->rpm_notch_harmonics = 3;
+        gyroConfig()->rpm_notch_min_hz = 100;
+        gyroConfig()->rpm_notch_q = 500;
+        escSensorActive = true;
+
+        setMotorRpm(0, 9000);       // 150Hz
+        setMotorRpm(1, 12000);      // 200Hz
+        setMotorRpm(2, 15000);      // 250Hz
+        setMotorRpm(3, 18000);      // 300Hz
+
+        ASSERT_TRUE(rpmFilterInit(SAMPLE_PERIOD_US));
+        settle();
+    }
+};
+
+TEST_F(RpmFilterTest, DisabledWithoutEscSensor)
+{
+    escSensorActive = false;
+    EXPECT_FALSE(rpmFilterInit(SAMPLE_PERIOD_US));
+    EXPECT_FALSE(isRpmFilterEnabled());
+}
+
+TEST_F(RpmFilterTest, DisabledWithoutHarmonicsOrSamplePeriod)
+{
+    gyroConfig()->rpm_notch_harmonics = 0;
+    EXPECT_FALSE(rpmFilterInit(SAMPLE_PERIOD_US));
+    EXPECT_FALSE(isRpmFilterEnabled());
+
+    gyroConfig()->rpm_notch_harmonics = 3;
+    EXPECT_FALSE(rpmFilterInit(0));
+    EXPECT_FALSE(isRpmFilterEnabled());
+}
+
+TEST_F(RpmFilterTest, AttenuatesFundamentalAndHarmonics)
+{
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        double fundamental = escData[motor].rpm / 60.0;
+        for (int harmonic = 1; harmonic <= 3; harmonic++) {
+            EXPECT_LT(sineGainDb(FD_ROLL, fundamental * harmonic), -30.0)
+                << "motor " << motor << " harmonic " << harmonic;
+        }
+    }
+}
+
+TEST_F(RpmFilterTest, PassesTheControlBand)
+{
+    EXPECT_GT(sineGainDb(FD_ROLL, 10), -0.5);
+    EXPECT_GT(sineGainDb(FD_ROLL, 30), -1.0);
+}
+
+TEST_F(RpmFilterTest, SameResponseOnEveryAxis)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_LT(sineGainDb(axis, 200), -30.0) << "axis " << axis;
+    }
+}
+
+TEST_F(RpmFilterTest, HarmonicsAboveNyquistMarginAreSkipped)
+{
+    // 3rd harmonic of 1300Hz is above 0.45 x 8kHz, the fundamental and 2nd are still filtered
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        setMotorRpm(motor, 78000);
+    }
+    settle();
+
+    EXPECT_LT(sineGainDb(FD_ROLL, 1300), -30.0);
+    EXPECT_LT(sineGainDb(FD_ROLL, 2600), -30.0);
+    EXPECT_GT(sineGainDb(FD_ROLL, 3900), -0.5);
+}
+
+TEST_F(RpmFilterTest, NoTelemetryPassesEverything)
+{
+    // as after escSensorInit(), before the first reply
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        escData[motor].dataAge = ESC_DATA_INVALID;
+    }
+    ASSERT_TRUE(rpmFilterInit(SAMPLE_PERIOD_US));
+    settle();
+
+    for (int frequency = 50; frequency <= 1000; frequency += 50) {
+        EXPECT_GT(sineGainDb(FD_ROLL, frequency), -0.01) << frequency << "Hz";
+    }
+}
+
+TEST_F(RpmFilterTest, StaleTelemetryBypassesTheMotor)
+{
+    // motor 3 at 300Hz stopped answering, the others are still filtered
+    escData[3].dataAge = 200;
+    settle();
+
+    EXPECT_LT(sineGainDb(FD_ROLL, 150), -30.0);
+    EXPECT_LT(sineGainDb(FD_ROLL, 250), -30.0);
+    EXPECT_GT(sineGainDb(FD_ROLL, 900), -3.0);     // 3rd harmonic of motor 3, only the skirt of the 750Hz notch
+
+    // a few missed requests are tolerated
+    escData[3].dataAge = 2;
+    settle();
+    EXPECT_LT(sineGainDb(FD_ROLL, 900), -30.0);
+}
+
+TEST_F(RpmFilterTest, TelemetryReturnsWithoutTransient)
+{
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        escData[motor].dataAge = ESC_DATA_INVALID;
+    }
+    settle();
+    for (int i = 0; i < 100; i++) {
+        rpmFilterApply(FD_ROLL, 1.0f);
+    }
+
+    // a constant gyro goes through unchanged while the notches come back
+    for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+        setMotorRpm(motor, 9000 + motor * 3000);
+    }
+    rpmFilterUpdate();
+
+    float worst = 0;
+    for (int i = 0; i < 1000; i++) {
+        worst = fmaxf(worst, fabsf(rpmFilterApply(FD_ROLL, 1.0f) - 1.0f));
+    }
+    EXPECT_LT(worst, 1e-4f);
+
+    // and the notches are on the telemetry at once
+    EXPECT_LT(sineGainDb(FD_ROLL, 150), -30.0);
+}
+
+TEST_F(RpmFilterTest, StaysTunedAfterManyRetunes)
+{
+    // the cos/sin pair is only ever rotated, a drift would move the notch off the telemetry frequency
+    srand(1);
+    int32_t rpm = 12000;
+    for (int i = 0; i < 200000; i++) {
+        rpm += (rand() % 2001) - 1000;
+        rpm = rpm < 6000 ? 6000 : rpm > 60000 ? 60000 : rpm;
+        for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+            setMotorRpm(motor, rpm);
+        }
+        rpmFilterUpdate();
+    }
+    settle();
+
+    double fundamental = rpm / 60.0;
+    EXPECT_LT(sineGainDb(FD_ROLL, fundamental), -30.0);
+    EXPECT_LT(sineGainDb(FD_ROLL, fundamental * 2), -30.0);
+}
+
+TEST_F(RpmFilterTest, Benchmark)
+{
+    // not the target cost, only the relative weight of the filtering and the retune on the host
+    static const int samples = 1000000;
+    volatile float input = 1.0f;
+    float sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            sum += rpmFilterApply(axis, input);
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++) {
+        // every motor moves every update, so every notch is retuned
+        for (int motor = 0; motor < RPM_FILTER_MOTOR_COUNT; motor++) {
+            setMotorRpm(motor, (i & 1) ? 12000 + motor * 600 : 12060 + motor * 600);
+        }
+        rpmFilterUpdate();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double applyNs = std::chrono::duration<double, std::nano>(middle - start).count() / samples;
+    double updateNs = std::chrono::duration<double, std::nano>(end - middle).count() / samples;
+    printf("[ BENCH    ] 12 notches x 3 axes %.1fns/sample, rpmFilterUpdate %.1fns/update\n", applyNs, updateNs);
+
+    EXPECT_TRUE(isfinite(sum));
+}
+
+// STUBS
+
+extern "C" {
+
+bool isEscSensorActive(void)
+{
+    return escSensorActive;
+}
+
+escSensorData_t *getEscSensorData(uint8_t motorNumber)
+{
+    return &escData[motorNumber];
+}
+
+uint32_t calcEscRpm(int32_t erpm)
+{
+    return erpm;
+}
+
+}
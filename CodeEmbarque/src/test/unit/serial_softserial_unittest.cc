@@ -0,0 +1,387 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/gpio.h"
+    #include "drivers/timer.h"
+    #include "drivers/serial.h"
+    #include "drivers/serial_softserial.h"
+
+    uint16_t decodeRxFrame(const uint16_t *edgeOffsets, uint8_t edgeCount, uint32_t bitTicks);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TIMER_MHZ       2               // SOFTSERIAL_TIMER_MHZ
+#define FRAME_BITS      10
+#define START_BIT_MASK  (1 << 0)
+#define STOP_BIT_MASK   (1 << (FRAME_BITS - 1))
+
+// timer ticks per bit in 1/256 tick, as the driver computes it
+static uint32_t bitTicksForBaud(uint32_t baud)
+{
+    return (TIMER_MHZ * 1000000 * 256) / baud;
+}
+
+// start bit, 8 data bits LSB first, stop bit, 1 for mark
+static uint16_t frameForByte(uint8_t value)
+{
+    return (1 << (FRAME_BITS - 1)) | (value << 1);
+}
+
+// offsets, in 1/256 tick from the start edge, of the level changes after the start bit
+static std::vector<uint32_t> frameEdges(uint16_t frame, uint32_t bitTicks)
+{
+    std::vector<uint32_t> edges;
+    for (int bit = 1; bit < FRAME_BITS; bit++) {
+        if (((frame >> bit) & 1) != ((frame >> (bit - 1)) & 1)) {
+            edges.push_back(bit * bitTicks);
+        }
+    }
+    return edges;
+}
+
+static uint16_t decode(const std::vector<uint32_t> &edges, uint32_t bitTicks)
+{
+    uint16_t offsets[16];
+    for (size_t i = 0; i < edges.size(); i++) {
+        offsets[i] = edges[i] >> 8;
+    }
+    return decodeRxFrame(offsets, edges.size(), bitTicks);
+}
+
+TEST(SoftSerialDecodeTest, EveryByteAtEveryBaudRate)
+{
+    static const uint32_t baudRates[] = { 1200, 9600, 19200, 38400, 57600, 115200 };
+
+    for (uint32_t baud : baudRates) {
+        uint32_t bitTicks = bitTicksForBaud(baud);
+        for (int value = 0; value < 256; value++) {
+            uint16_t frame = frameForByte(value);
+            EXPECT_EQ(frame, decode(frameEdges(frame, bitTicks), bitTicks)) << baud << " baud, byte " << value;
+        }
+    }
+}
+
+TEST(SoftSerialDecodeTest, EdgeJitterBelowHalfABit)
+{
+    uint32_t bitTicks = bitTicksForBaud(19200);
+    srand(1);
+
+    for (int i = 0; i < 10000; i++) {
+        uint16_t frame = frameForByte(rand());
+        std::vector<uint32_t> edges = frameEdges(frame, bitTicks);
+        for (uint32_t &edge : edges) {
+            edge += (int32_t)(rand() % (bitTicks * 7 / 10)) - (int32_t)(bitTicks * 35 / 100);
+        }
+        ASSERT_EQ(frame, decode(edges, bitTicks));
+    }
+}
+
+TEST(SoftSerialDecodeTest, ShortGlitchAtABitBoundaryIsIgnored)
+{
+    uint32_t bitTicks = bitTicksForBaud(19200);
+    uint16_t frame = frameForByte(0x0F);    // data 1111 0000, a single level change in bit 5
+
+    // a pulse of a fifth of a bit right after the start of bit 3, both edges land on the same boundary
+    std::vector<uint32_t> edges = frameEdges(frame, bitTicks);
+    edges.push_back(3 * bitTicks + bitTicks / 10);
+    edges.push_back(3 * bitTicks + bitTicks * 3 / 10);
+    std::sort(edges.begin(), edges.end());
+
+    EXPECT_EQ(frame, decode(edges, bitTicks));
+}
+
+TEST(SoftSerialDecodeTest, MissingStopBit)
+{
+    uint32_t bitTicks = bitTicksForBaud(19200);
+
+    // line held at space through the stop bit, a break or a baud rate mismatch
+    uint16_t frame = 0x1FE & ~STOP_BIT_MASK;
+    uint16_t decoded = decode(frameEdges(frame, bitTicks), bitTicks);
+
+    EXPECT_EQ(0, decoded & START_BIT_MASK);
+    EXPECT_EQ(0, decoded & STOP_BIT_MASK);
+}
+
+TEST(SoftSerialDecodeTest, EdgesAfterTheFrameClampToTheStopBit)
+{
+    uint32_t bitTicks = bitTicksForBaud(19200);
+    uint16_t frame = frameForByte(0x00);
+
+    // the only change is the rising edge of the stop bit, late by most of a bit
+    std::vector<uint32_t> edges = { 9 * bitTicks + bitTicks * 4 / 10 };
+    EXPECT_EQ(frame, decode(edges, bitTicks));
+}
+
+/*
+ * The driver with its timer: edges are fed to the RX capture callback and the
+ * compare callback runs whenever the simulated counter reaches the compare.
+ */
+
+#define TEST_TIMER_COUNT 4
+
+static TIM_TypeDef testTimers[2];
+extern "C" {
+    const timerHardware_t timerHardware[TEST_TIMER_COUNT] = {
+        { &testTimers[0], NULL, 1, TIM_Channel_1, 0, 0, Mode_AF_PP_PU, 0, 0 },   // softserial 1 RX
+        { &testTimers[0], NULL, 2, TIM_Channel_2, 0, 0, Mode_AF_PP_PU, 0, 0 },   // softserial 1 TX
+        { &testTimers[1], NULL, 3, TIM_Channel_1, 0, 0, Mode_AF_PP_PU, 0, 0 },   // softserial 2 RX
+        { &testTimers[1], NULL, 4, TIM_Channel_2, 0, 0, Mode_AF_PP_PU, 0, 0 },   // softserial 2 TX
+    };
+}
+
+static timerCCHandlerRec_t *timerCallbacks[TEST_TIMER_COUNT];
+static volatile timCCR_t timerCompare[TEST_TIMER_COUNT];
+static bool timerCompareEnabled[TEST_TIMER_COUNT];
+
+typedef struct {
+    uint16_t at;
+    uint8_t level;
+} txLevelChange_t;
+
+static std::vector<txLevelChange_t> txLevelChanges[TEST_TIMER_COUNT];
+static uint8_t txLevel[TEST_TIMER_COUNT];
+
+static std::vector<uint8_t> received;
+
+static void onByte(uint16_t data)
+{
+    received.push_back(data);
+}
+
+static int timerIndex(const timerHardware_t *timHw)
+{
+    return timHw - timerHardware;
+}
+
+// runs the compare events of a port up to the counter value, returns false once none is pending
+static bool runCompareUntil(int txIndex, uint32_t until)
+{
+    TIM_TypeDef *tim = timerHardware[txIndex].tim;
+    while (timerCompareEnabled[txIndex] && (int16_t)(timerCompare[txIndex] - until) <= 0) {
+        tim->CNT = timerCompare[txIndex];
+        timerCallbacks[txIndex]->fn(timerCallbacks[txIndex], timerCompare[txIndex]);
+    }
+    return timerCompareEnabled[txIndex];
+}
+
+// line edges in timer ticks, the first one is the start edge of the first frame
+static void receiveEdges(int rxIndex, const std::vector<uint32_t> &edges)
+{
+    int txIndex = rxIndex + 1;
+    TIM_TypeDef *tim = timerHardware[rxIndex].tim;
+
+    for (uint32_t edge : edges) {
+        runCompareUntil(txIndex, edge);
+        tim->CNT = edge;
+        timerCallbacks[rxIndex]->fn(timerCallbacks[rxIndex], edge);
+    }
+    while (runCompareUntil(txIndex, tim->CNT + 0x7FFF)) {
+    }
+}
+
+// the frames sent one after the other, each bitTicksSender long, from the tick startAt
+static std::vector<uint32_t> lineEdges(const std::vector<uint16_t> &frames, uint32_t bitTicksSender, uint32_t startAt)
+{
+    std::vector<uint32_t> edges;
+    uint32_t frameStart = startAt * 256;
+    for (uint16_t frame : frames) {
+        edges.push_back(frameStart >> 8);
+        for (uint32_t edge : frameEdges(frame, bitTicksSender)) {
+            edges.push_back((frameStart + edge) >> 8);
+        }
+        frameStart += FRAME_BITS * bitTicksSender;
+    }
+    return edges;
+}
+
+class SoftSerialTest : public ::testing::Test {
+protected:
+    serialPort_t *port1;
+    serialPort_t *port2;
+
+    virtual void SetUp() {
+        memset(testTimers, 0, sizeof(testTimers));
+        memset(timerCallbacks, 0, sizeof(timerCallbacks));
+        memset(timerCompareEnabled, 0, sizeof(timerCompareEnabled));
+        for (int i = 0; i < TEST_TIMER_COUNT; i++) {
+            txLevelChanges[i].clear();
+            txLevel[i] = 1;
+        }
+        received.clear();
+
+        port1 = openSoftSerial(SOFTSERIAL1, NULL, 19200, SERIAL_NOT_INVERTED);
+        port2 = openSoftSerial(SOFTSERIAL2, onByte, 19200, SERIAL_NOT_INVERTED);
+    }
+};
+
+TEST_F(SoftSerialTest, ReceivesAFrame)
+{
+    receiveEdges(0, lineEdges({ frameForByte(0xA5) }, bitTicksForBaud(19200), 1000));
+
+    ASSERT_EQ(1u, softSerialRxBytesWaiting(port1));
+    EXPECT_EQ(0xA5, softSerialReadByte(port1));
+}
+
+TEST_F(SoftSerialTest, BackToBackFrames)
+{
+    std::vector<uint16_t> frames;
+    for (int value = 0; value < 256; value++) {
+        frames.push_back(frameForByte(value));
+    }
+
+    // no idle time between the frames, with the sender clock 2% off either way
+    static const int clockErrors[] = { 0, 2, -2 };
+    for (int clockError : clockErrors) {
+        received.clear();
+        uint32_t bitTicks = bitTicksForBaud(19200) * (100 + clockError) / 100;
+        receiveEdges(2, lineEdges(frames, bitTicks, 50000));
+
+        ASSERT_EQ(256u, received.size()) << "clock error " << clockError << "%";
+        for (int value = 0; value < 256; value++) {
+            EXPECT_EQ(value, received[value]) << "clock error " << clockError << "%";
+        }
+    }
+}
+
+TEST_F(SoftSerialTest, FrameWithoutStopBitIsDropped)
+{
+    uint32_t bitTicks = bitTicksForBaud(19200);
+    std::vector<uint32_t> edges = lineEdges({ (uint16_t)(frameForByte(0x55) & ~STOP_BIT_MASK) }, bitTicks, 1000);
+    // the line returns to mark a bit after the stop bit, that edge is not a start bit, then a good frame follows
+    edges.push_back(1000 + ((FRAME_BITS + 1) * bitTicks >> 8));
+    std::vector<uint32_t> next = lineEdges({ frameForByte(0x3C) }, bitTicks, 1000 + (15 * bitTicks >> 8));
+    edges.insert(edges.end(), next.begin(), next.end());
+
+    receiveEdges(2, edges);
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(0x3C, received[0]);
+}
+
+TEST_F(SoftSerialTest, NoisyFrameIsDropped)
+{
+    uint32_t bitTicks = bitTicksForBaud(19200);
+    std::vector<uint32_t> edges = lineEdges({ frameForByte(0xFF) }, bitTicks, 1000);
+
+    // more edges than a frame can have, spread over the data bits
+    for (int i = 0; i < 10; i++) {
+        edges.push_back(1000 + ((2 * bitTicks + i * bitTicks / 2) >> 8));
+    }
+    std::sort(edges.begin(), edges.end());
+    receiveEdges(2, edges);
+
+    EXPECT_EQ(0u, received.size());
+}
+
+TEST_F(SoftSerialTest, TransmitsBackToBackFramesItReceives)
+{
+    static const uint8_t message[] = { 0x00, 0xFF, 0x55, 0xAA, 0x01, 0x80, 0x7E, 0x3C };
+
+    testTimers[0].CNT = 3000;
+    for (uint8_t value : message) {
+        softSerialWriteByte(port1, value);
+    }
+    while (runCompareUntil(1, testTimers[0].CNT + 0x7FFF)) {
+    }
+    EXPECT_TRUE(isSoftSerialTransmitBufferEmpty(port1));
+
+    // the level changes of port 1 TX are the edges of port 2 RX
+    std::vector<uint32_t> edges;
+    uint32_t previous = txLevelChanges[1][0].at;
+    uint32_t at = previous;
+    for (const txLevelChange_t &change : txLevelChanges[1]) {
+        at += (uint16_t)(change.at - previous);
+        previous = change.at;
+        edges.push_back(at);
+    }
+    receiveEdges(2, edges);
+
+    ASSERT_EQ(sizeof(message), received.size());
+    for (size_t i = 0; i < sizeof(message); i++) {
+        EXPECT_EQ(message[i], received[i]);
+    }
+
+    // one compare per level change and one per frame end, not one per bit
+    EXPECT_LT(txLevelChanges[1].size(), sizeof(message) * FRAME_BITS);
+}
+
+// STUBS
+
+extern "C" {
+
+static void setTxLevel(GPIO_TypeDef *p, uint16_t pin, uint8_t level)
+{
+    UNUSED(p);
+    for (int i = 0; i < TEST_TIMER_COUNT; i++) {
+        if (timerHardware[i].pin == pin && txLevel[i] != level) {
+            txLevel[i] = level;
+            txLevelChanges[i].push_back({ (uint16_t)timerHardware[i].tim->CNT, level });
+        }
+    }
+}
+
+void digitalHi(GPIO_TypeDef *p, uint16_t i) { setTxLevel(p, i, 1); }
+void digitalLo(GPIO_TypeDef *p, uint16_t i) { setTxLevel(p, i, 0); }
+
+void gpioInit(GPIO_TypeDef *gpio, const gpio_config_t *config) { UNUSED(gpio); UNUSED(config); }
+void delay(uint32_t ms) { UNUSED(ms); }
+uint32_t micros(void) { return 0; }
+
+void TIM_ICStructInit(TIM_ICInitTypeDef *TIM_ICInitStruct) { memset(TIM_ICInitStruct, 0, sizeof(*TIM_ICInitStruct)); }
+void TIM_ICInit(TIM_TypeDef *TIMx, TIM_ICInitTypeDef *TIM_ICInitStruct) { UNUSED(TIMx); UNUSED(TIM_ICInitStruct); }
+
+void timerConfigure(const timerHardware_t *timHw, uint16_t period, uint8_t mhz) { UNUSED(timHw); UNUSED(period); UNUSED(mhz); }
+void timerChConfigOC(const timerHardware_t *timHw, bool outEnable, bool stateHigh) { UNUSED(timHw); UNUSED(outEnable); UNUSED(stateHigh); }
+
+void timerChCCHandlerInit(timerCCHandlerRec_t *self, timerCCHandlerCallback *fn)
+{
+    self->fn = fn;
+}
+
+void timerChConfigCallbacks(const timerHardware_t *timHw, timerCCHandlerRec_t *edgeCallback, timerOvrHandlerRec_t *overflowCallback)
+{
+    UNUSED(overflowCallback);
+    timerCallbacks[timerIndex(timHw)] = edgeCallback;
+}
+
+volatile timCCR_t *timerChCCR(const timerHardware_t *timHw)
+{
+    return &timerCompare[timerIndex(timHw)];
+}
+
+void timerChClearCCFlag(const timerHardware_t *timHw) { UNUSED(timHw); }
+
+void timerChITConfig(const timerHardware_t *timHw, FunctionalState newState)
+{
+    timerCompareEnabled[timerIndex(timHw)] = newState;
+}
+
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Host target for the unit tests, the features the tests build against.
+
+#pragma once
+
+#define TARGET_BOARD_IDENTIFIER "TEST"
+
+#define USE_SOFTSERIAL1
+#define USE_SOFTSERIAL2
+#define SERIAL_PORT_COUNT 5
+
+#define SERIAL_RX
+#define TELEMETRY
+#define USE_SERVOS
+#define USE_DSHOT
+#define USE_ESC_SENSOR
+#define USE_RPM_FILTER
+#define LED_STRIP
+#define GPS
+
+#define SOFTSERIAL_1_TIMER_RX_HARDWARE 0
+#define SOFTSERIAL_1_TIMER_TX_HARDWARE 1
+#define SOFTSERIAL_2_TIMER_RX_HARDWARE 2
+#define SOFTSERIAL_2_TIMER_TX_HARDWARE 3
@@ -0,0 +1,122 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/system.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// SysTick reload for a 72MHz core clock
+#define TICKS_PER_US 72
+#define SYSTICK_LOAD (TICKS_PER_US * 1000 - 1)
+
+static uint32_t sysTickValAt(uint32_t usIntoMillisecond)
+{
+    return SYSTICK_LOAD - usIntoMillisecond * TICKS_PER_US;
+}
+
+TEST(TimebaseTest, CountsUpWithinAMillisecond)
+{
+    uint32_t previous = sysTickMicros(1234, SYSTICK_LOAD, TICKS_PER_US);
+    EXPECT_EQ(1234000u, previous);
+
+    for (int32_t val = SYSTICK_LOAD; val >= 0; val--) {
+        uint32_t now = sysTickMicros(1234, val, TICKS_PER_US);
+        EXPECT_GE(now, previous);
+        EXPECT_LE(now - 1234000u, 1000u);
+        previous = now;
+    }
+}
+
+TEST(TimebaseTest, ContinuousAcrossMilliseconds)
+{
+    uint32_t lastOfMillisecond = sysTickMicros(41, sysTickValAt(999), TICKS_PER_US);
+    uint32_t firstOfNext = sysTickMicros(42, sysTickValAt(0), TICKS_PER_US);
+
+    EXPECT_EQ(41999u, lastOfMillisecond);
+    EXPECT_EQ(42000u, firstOfNext);
+}
+
+TEST(TimebaseTest, WrapsAt2Pow32LikeTheHardwareCounter)
+{
+    // the TIM2 counter is preloaded with micros() and wraps at 2^32, the SysTick path must wrap at the same point
+    static const uint32_t milliseconds[] = { 4294966, 4294967, 4294968, 4294969, 10000000, 0xFFFFFFFF };
+
+    for (unsigned i = 0; i < sizeof(milliseconds) / sizeof(milliseconds[0]); i++) {
+        for (uint32_t us = 0; us < 1000; us += 111) {
+            uint64_t uptime = (uint64_t)milliseconds[i] * 1000 + us;
+            EXPECT_EQ((uint32_t)uptime, sysTickMicros(milliseconds[i], sysTickValAt(us), TICKS_PER_US));
+        }
+    }
+}
+
+TEST(TimebaseTest, ElapsedTimeAcrossTheWrap)
+{
+    // 2^32us falls 296us into millisecond 4294967
+    uint32_t before = sysTickMicros(4294967, sysTickValAt(200), TICKS_PER_US);
+    uint32_t after = sysTickMicros(4294968, sysTickValAt(100), TICKS_PER_US);
+
+    EXPECT_EQ(4294967200u, before);
+    EXPECT_EQ(804u, after);
+    EXPECT_EQ(900u, after - before);
+    // the comparison used by the scheduler for deadlines
+    EXPECT_GT((int32_t)(after - before), 0);
+    EXPECT_LT((int32_t)(before - after), 0);
+
+    // a hardware counter continuing from the SysTick time lands on the same value
+    uint32_t counter = before;
+    for (int i = 0; i < 900; i++) {
+        counter++;
+    }
+    EXPECT_EQ(after, counter);
+}
+
+TEST(TimebaseBenchmark, CallCost)
+{
+    // not the target cost, only the relative weight of the two paths on the host
+    static const int calls = 10000000;
+    volatile uint32_t ms = 1000;
+    volatile uint32_t sysTickVal = SYSTICK_LOAD / 2;
+    volatile uint32_t counter = 1000500;
+    uint32_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        sum += sysTickMicros(ms, sysTickVal, TICKS_PER_US);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        sum += counter;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double sysTickNs = std::chrono::duration<double, std::nano>(middle - start).count() / calls;
+    double counterNs = std::chrono::duration<double, std::nano>(end - middle).count() / calls;
+    printf("[ BENCH    ] SysTick micros %.2fns/call, counter read %.2fns/call\n", sysTickNs, counterNs);
+
+    EXPECT_EQ((uint32_t)((1000500ull * 2 * calls) & 0xFFFFFFFF), sum);
+}